@@ -26,6 +26,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <signal.h>
 #include <unistd.h>
 #include <string.h>
 #include <stdlib.h>
@@ -46,6 +47,30 @@
  * Private Data
  ****************************************************************************/
 
+static bool g_segv_installed;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: host_segv_handler
+ *
+ * Description:
+ *   Give the simulation a chance to explain an access to protected memory.
+ *   If it doesn't claim the fault, restore the default action so that the
+ *   faulting access kills the process as usual.
+ *
+ ****************************************************************************/
+
+static void host_segv_handler(int signo, siginfo_t *info, void *context)
+{
+  if (!sim_memfault(info->si_addr))
+    {
+      signal(signo, SIG_DFL);
+    }
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -186,3 +211,33 @@ void *host_realloc(void *oldmem, size_t size)
   mem = host_uninterruptible(realloc, oldmem, size);
   return mem;
 }
+
+/****************************************************************************
+ * Name: host_mprotect
+ *
+ * Description:
+ *   Allow or forbid any access to a page aligned host memory range.
+ *
+ ****************************************************************************/
+
+int host_mprotect(void *addr, size_t size, bool access)
+{
+  if (!g_segv_installed)
+    {
+      struct sigaction act;
+
+      memset(&act, 0, sizeof(act));
+      act.sa_sigaction = host_segv_handler;
+      act.sa_flags     = SA_SIGINFO | SA_NODEFER;
+      sigaction(SIGSEGV, &act, NULL);
+      sigaction(SIGBUS, &act, NULL);
+      g_segv_installed = true;
+    }
+
+  if (mprotect(addr, size, access ? PROT_READ | PROT_WRITE : PROT_NONE) < 0)
+    {
+      return -errno;
+    }
+
+  return 0;
+}
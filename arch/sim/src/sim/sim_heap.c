@@ -33,6 +33,7 @@
 
 #include <nuttx/arch.h>
 #include <nuttx/atomic.h>
+#include <nuttx/fs/fs.h>
 #include <nuttx/fs/procfs.h>
 #include <nuttx/mm/mm.h>
 #include <nuttx/sched_note.h>
@@ -689,3 +690,43 @@ void up_allocate_heap(void **heap_start, size_t *heap_size)
 }
 
 #endif /* CONFIG_MM_CUSTOMIZE_MANAGER */
+
+/****************************************************************************
+ * Name: up_mprotect
+ *
+ * Description:
+ *   Allow or forbid any access to a page aligned range of memory.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_ARCH_HAVE_MPROTECT
+int up_mprotect(void *addr, size_t size, bool access)
+{
+  return host_mprotect(addr, size, access);
+}
+#endif
+
+/****************************************************************************
+ * Name: sim_memfault
+ *
+ * Description:
+ *   Called from the host fault handler with the faulting address.  Returns
+ *   false if the fault isn't one the simulation knows about.
+ *
+ ****************************************************************************/
+
+bool sim_memfault(void *addr)
+{
+#if defined(CONFIG_FS_RAMMAP_PAGESIZE) && CONFIG_FS_RAMMAP_PAGESIZE > 0
+  if (rammap_fault(addr))
+    {
+      return true;
+    }
+#endif
+
+#ifdef CONFIG_MM_GUARD
+  return mm_guard_fault(addr);
+#else
+  return false;
+#endif
+}
@@ -236,6 +236,11 @@ void *host_memalign(size_t alignment, size_t size);
 void host_free(void *mem);
 void *host_realloc(void *oldmem, size_t size);
 int host_unlinkshmem(const char *name);
+int host_mprotect(void *addr, size_t size, bool access);
+
+/* sim_heap.c ***************************************************************/
+
+bool sim_memfault(void *addr);
 
 /* sim_hosttime.c ***********************************************************/
 
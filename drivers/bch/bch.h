@@ -42,6 +42,24 @@
 
 #define MAX_OPENCNT       (255)                  /* Limit of uint8_t */
 
+/* Access to the contained block driver, through the shared block cache if
+ * it is enabled.
+ */
+
+#ifdef CONFIG_FS_BLOCKCACHE
+#  define bchlib_hwread(bch, buffer, sector, nsectors) \
+     blockcache_read((bch)->inode, buffer, sector, nsectors, \
+                     (bch)->sectsize)
+#  define bchlib_hwwrite(bch, buffer, sector, nsectors) \
+     blockcache_write((bch)->inode, buffer, sector, nsectors, \
+                      (bch)->sectsize)
+#else
+#  define bchlib_hwread(bch, buffer, sector, nsectors) \
+     (bch)->inode->u.i_bops->read((bch)->inode, buffer, sector, nsectors)
+#  define bchlib_hwwrite(bch, buffer, sector, nsectors) \
+     (bch)->inode->u.i_bops->write((bch)->inode, buffer, sector, nsectors)
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -440,6 +440,9 @@ static int bch_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
           /* Invalidate the sector so next read is from the device- */
 
           bch->sector = (size_t)-1;
+#ifdef CONFIG_FS_BLOCKCACHE
+          blockcache_invalidate(bch->inode);
+#endif
           goto ioctl_default;
         }
 
@@ -453,6 +456,14 @@ static int bch_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
               break;
             }
 
+#ifdef CONFIG_FS_BLOCKCACHE
+          ret = blockcache_flush(bch->inode);
+          if (ret < 0)
+            {
+              break;
+            }
+#endif
+
           /* Go through */
         }
 
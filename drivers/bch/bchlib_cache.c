@@ -108,7 +108,6 @@ static int bch_cypher(FAR struct bchlib_s *bch, int encrypt)
 
 int bchlib_flushsector(FAR struct bchlib_s *bch, bool discard)
 {
-  FAR struct inode *inode;
   ssize_t ret = OK;
 
   /* Check if the sector has been modified and is out of synch with the
@@ -117,8 +116,6 @@ int bchlib_flushsector(FAR struct bchlib_s *bch, bool discard)
 
   if (bch->dirty && bch->buffer != NULL)
     {
-      inode = bch->inode;
-
 #if defined(CONFIG_BCH_ENCRYPTION)
       /* Encrypt data as necessary */
 
@@ -127,7 +124,7 @@ int bchlib_flushsector(FAR struct bchlib_s *bch, bool discard)
 
       /* Write the sector to the media */
 
-      ret = inode->u.i_bops->write(inode, bch->buffer, bch->sector, 1);
+      ret = bchlib_hwwrite(bch, bch->buffer, bch->sector, 1);
       if (ret < 0)
         {
           ferr("Write failed: %zd\n", ret);
@@ -168,7 +165,6 @@ int bchlib_flushsector(FAR struct bchlib_s *bch, bool discard)
 
 int bchlib_readsector(FAR struct bchlib_s *bch, size_t sector)
 {
-  FAR struct inode *inode;
   ssize_t ret = OK;
 
   if (bch->buffer == NULL)
@@ -187,8 +183,6 @@ int bchlib_readsector(FAR struct bchlib_s *bch, size_t sector)
 
   if (bch->sector != sector)
     {
-      inode = bch->inode;
-
       ret = bchlib_flushsector(bch, true);
       if (ret < 0)
         {
@@ -196,7 +190,7 @@ int bchlib_readsector(FAR struct bchlib_s *bch, size_t sector)
           return (int)ret;
         }
 
-      ret = inode->u.i_bops->read(inode, bch->buffer, sector, 1);
+      ret = bchlib_hwread(bch, bch->buffer, sector, 1);
       if (ret < 0)
         {
           ferr("Read failed: %zd\n", ret);
@@ -66,6 +66,10 @@ int bchlib_teardown(FAR void *handle)
 
   bchlib_flushsector(bch, false);
 
+#ifdef CONFIG_FS_BLOCKCACHE
+  blockcache_invalidate(bch->inode);
+#endif
+
   /* Close the block driver */
 
   close_blockdriver(bch->inode);
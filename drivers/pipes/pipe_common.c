@@ -65,14 +65,14 @@
 #endif
 
 /****************************************************************************
- * Private Functions
+ * Public Functions
  ****************************************************************************/
 
 /****************************************************************************
  * Name: pipecommon_wakeup
  ****************************************************************************/
 
-static void pipecommon_wakeup(FAR sem_t *sem)
+void pipecommon_wakeup(FAR sem_t *sem)
 {
   int sval;
 
@@ -85,10 +85,6 @@ static void pipecommon_wakeup(FAR sem_t *sem)
     }
 }
 
-/****************************************************************************
- * Public Functions
- ****************************************************************************/
-
 /****************************************************************************
  * Name: pipecommon_allocdev
  ****************************************************************************/
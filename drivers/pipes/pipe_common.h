@@ -156,6 +156,7 @@ struct inode; /* Forward reference */
 
 FAR struct pipe_dev_s *pipecommon_allocdev(size_t bufsize);
 void    pipecommon_freedev(FAR struct pipe_dev_s *dev);
+void    pipecommon_wakeup(FAR sem_t *sem);
 int     pipecommon_open(FAR struct file *filep);
 int     pipecommon_close(FAR struct file *filep);
 ssize_t pipecommon_read(FAR struct file *, FAR char *, size_t);
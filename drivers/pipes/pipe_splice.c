@@ -0,0 +1,723 @@
+/****************************************************************************
+ * drivers/pipes/pipe_splice.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/param.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/semaphore.h>
+#include <nuttx/fs/fs.h>
+
+#include "pipe_common.h"
+
+#ifdef CONFIG_PIPES
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define SPLICE_F_ALL (SPLICE_F_MOVE | SPLICE_F_NONBLOCK | SPLICE_F_MORE | \
+                      SPLICE_F_GIFT)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: pipe_splice_nonblock
+ ****************************************************************************/
+
+static bool pipe_splice_nonblock(FAR struct file *filep, unsigned int flags)
+{
+  return (flags & SPLICE_F_NONBLOCK) != 0 ||
+         (filep->f_oflags & O_NONBLOCK) != 0;
+}
+
+/****************************************************************************
+ * Name: pipe_splice_consumed/pipe_splice_produced
+ *
+ * Description:
+ *   Notify the writers (readers) of a pipe after data was removed from
+ *   (added to) its buffer.  Called with d_bflock held.
+ *
+ ****************************************************************************/
+
+static void pipe_splice_consumed(FAR struct pipe_dev_s *dev)
+{
+  if (circbuf_used(&dev->d_buffer) <= (dev->d_bufsize - dev->d_polloutthrd))
+    {
+      poll_notify(dev->d_fds, CONFIG_DEV_PIPE_NPOLLWAITERS, POLLOUT);
+    }
+
+  pipecommon_wakeup(&dev->d_wrsem);
+}
+
+static void pipe_splice_produced(FAR struct pipe_dev_s *dev)
+{
+  if (circbuf_used(&dev->d_buffer) > dev->d_pollinthrd)
+    {
+      poll_notify(dev->d_fds, CONFIG_DEV_PIPE_NPOLLWAITERS, POLLIN);
+    }
+
+  pipecommon_wakeup(&dev->d_rdsem);
+}
+
+/****************************************************************************
+ * Name: pipe_splice_waitdata
+ *
+ * Description:
+ *   Wait until the pipe holds data, as pipecommon_read() does.  Called with
+ *   d_bflock held.
+ *
+ * Returned Value:
+ *   One with d_bflock held if the pipe holds data.  Zero on end of file or
+ *   a negated errno value, with d_bflock released.
+ *
+ ****************************************************************************/
+
+static int pipe_splice_waitdata(FAR struct pipe_dev_s *dev, bool nonblock)
+{
+  int ret;
+
+  while (circbuf_is_empty(&dev->d_buffer))
+    {
+      if (dev->d_nwriters <= 0 && PIPE_IS_POLICY_0(dev->d_flags))
+        {
+          nxrmutex_unlock(&dev->d_bflock);
+          return 0;
+        }
+
+      nxrmutex_unlock(&dev->d_bflock);
+      if (nonblock)
+        {
+          return -EAGAIN;
+        }
+
+      ret = nxsem_wait(&dev->d_rdsem);
+      if (ret < 0 || (ret = nxrmutex_lock(&dev->d_bflock)) < 0)
+        {
+          return ret;
+        }
+    }
+
+  return 1;
+}
+
+/****************************************************************************
+ * Name: pipe_splice_waitspace
+ *
+ * Description:
+ *   Wait until the pipe has room for data, as pipecommon_write() does.
+ *   Called with d_bflock held.
+ *
+ * Returned Value:
+ *   Zero (OK) with d_bflock held if the pipe has room.  A negated errno
+ *   value, with d_bflock released, otherwise.
+ *
+ ****************************************************************************/
+
+static int pipe_splice_waitspace(FAR struct pipe_dev_s *dev, bool nonblock)
+{
+  int ret;
+
+  for (; ; )
+    {
+      if (dev->d_nreaders <= 0 && PIPE_IS_POLICY_0(dev->d_flags))
+        {
+          nxrmutex_unlock(&dev->d_bflock);
+          return -EPIPE;
+        }
+
+      if (!circbuf_is_full(&dev->d_buffer))
+        {
+          return OK;
+        }
+
+      nxrmutex_unlock(&dev->d_bflock);
+      if (nonblock)
+        {
+          return -EAGAIN;
+        }
+
+      ret = nxsem_wait(&dev->d_wrsem);
+      if (ret < 0 || (ret = nxrmutex_lock(&dev->d_bflock)) < 0)
+        {
+          return ret;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: pipe_splice_poll
+ *
+ * Description:
+ *   Check, or wait until, a file is readable (writable), so that the
+ *   following read (write) does not block with the lock of the pipe held.
+ *
+ * Returned Value:
+ *   Zero (OK) if the file is ready.  -EAGAIN if it is not ready and wait
+ *   is false, or a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+static int pipe_splice_poll(FAR struct file *filep, pollevent_t events,
+                            bool wait)
+{
+  struct pollfd fds;
+  sem_t sem;
+  int ret;
+
+  memset(&fds, 0, sizeof(fds));
+  fds.events = events;
+  fds.arg    = &sem;
+  fds.cb     = poll_default_cb;
+
+  nxsem_init(&sem, 0, 0);
+  ret = file_poll(filep, &fds, true);
+  if (ret >= 0)
+    {
+      if (fds.revents == 0)
+        {
+          ret = wait ? nxsem_wait(&sem) : -EAGAIN;
+        }
+
+      file_poll(filep, &fds, false);
+    }
+
+  nxsem_destroy(&sem);
+
+  /* Files without poll support never block */
+
+  return ret == -ENOSYS ? OK : ret;
+}
+
+/****************************************************************************
+ * Name: pipe_splice_out
+ *
+ * Description:
+ *   Move data from a pipe to a file or a socket, writing straight from the
+ *   pipe buffer.  The pipe stays locked while the data is written, so the
+ *   output is only written while it is ready.  Otherwise the pipe is
+ *   unlocked before waiting for the output.
+ *
+ ****************************************************************************/
+
+static ssize_t pipe_splice_out(FAR struct file *infile,
+                               FAR struct file *outfile,
+                               FAR off_t *off_out, size_t len,
+                               unsigned int flags)
+{
+  FAR struct pipe_dev_s *dev = infile->f_inode->i_private;
+  bool nonblock = pipe_splice_nonblock(infile, flags);
+  FAR void *ptr;
+  ssize_t ntotal = 0;
+  ssize_t ret;
+  size_t n;
+
+  for (; ; )
+    {
+      ret = nxrmutex_lock(&dev->d_bflock);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      ret = pipe_splice_waitdata(dev, nonblock);
+      if (ret <= 0)
+        {
+          return ret;
+        }
+
+      while ((size_t)ntotal < len)
+        {
+          /* Check the output each time, it may fill up while we write */
+
+          ret = pipe_splice_poll(outfile, POLLOUT, false);
+          if (ret < 0)
+            {
+              break;
+            }
+
+          ptr = circbuf_get_readptr(&dev->d_buffer, &n);
+          if (n == 0)
+            {
+              break;
+            }
+
+          if (n > len - ntotal)
+            {
+              n = len - ntotal;
+            }
+
+          ret = off_out != NULL ?
+                file_pwrite(outfile, ptr, n, *off_out) :
+                file_write(outfile, ptr, n);
+          if (ret <= 0)
+            {
+              break;
+            }
+
+          circbuf_readcommit(&dev->d_buffer, ret);
+          ntotal += ret;
+          if (off_out != NULL)
+            {
+              *off_out += ret;
+            }
+
+          if ((size_t)ret < n)
+            {
+              break;
+            }
+        }
+
+      if (ntotal > 0)
+        {
+          pipe_splice_consumed(dev);
+        }
+
+      nxrmutex_unlock(&dev->d_bflock);
+
+      if (ntotal > 0 || ret != -EAGAIN || nonblock)
+        {
+          return ntotal > 0 ? ntotal : ret;
+        }
+
+      /* Nothing could be written yet, wait for the output unlocked */
+
+      ret = pipe_splice_poll(outfile, POLLOUT, true);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: pipe_splice_in
+ *
+ * Description:
+ *   Move data from a file or a socket to a pipe, reading straight into the
+ *   pipe buffer.  The input is only read with the pipe locked once it is
+ *   ready; otherwise the pipe is unlocked before waiting for the input.
+ *
+ ****************************************************************************/
+
+static ssize_t pipe_splice_in(FAR struct file *infile, FAR off_t *off_in,
+                              FAR struct file *outfile, size_t len,
+                              unsigned int flags)
+{
+  FAR struct pipe_dev_s *dev = outfile->f_inode->i_private;
+  bool nonblock = pipe_splice_nonblock(outfile, flags);
+  FAR void *ptr;
+  ssize_t ret;
+  size_t n;
+
+  for (; ; )
+    {
+      ret = nxrmutex_lock(&dev->d_bflock);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      ret = pipe_splice_waitspace(dev, nonblock);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      ret = pipe_splice_poll(infile, POLLIN, false);
+      if (ret >= 0)
+        {
+          break;
+        }
+
+      nxrmutex_unlock(&dev->d_bflock);
+      if (ret != -EAGAIN || nonblock)
+        {
+          return ret;
+        }
+
+      ret = pipe_splice_poll(infile, POLLIN, true);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  ptr = circbuf_get_writeptr(&dev->d_buffer, &n);
+  if (n > len)
+    {
+      n = len;
+    }
+
+  ret = off_in != NULL ? file_pread(infile, ptr, n, *off_in) :
+                         file_read(infile, ptr, n);
+  if (ret > 0)
+    {
+      circbuf_writecommit(&dev->d_buffer, ret);
+      if (off_in != NULL)
+        {
+          *off_in += ret;
+        }
+
+      pipe_splice_produced(dev);
+    }
+
+  nxrmutex_unlock(&dev->d_bflock);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: pipe_splice_pipe
+ *
+ * Description:
+ *   Copy data from one pipe buffer to another, removing it from the source
+ *   pipe if 'consume' is true.  Both pipes are locked in address order.
+ *
+ ****************************************************************************/
+
+static ssize_t pipe_splice_pipe(FAR struct file *infile,
+                                FAR struct file *outfile, size_t len,
+                                unsigned int flags, bool consume)
+{
+  FAR struct pipe_dev_s *in = infile->f_inode->i_private;
+  FAR struct pipe_dev_s *out = outfile->f_inode->i_private;
+  FAR struct pipe_dev_s *first = in < out ? in : out;
+  FAR struct pipe_dev_s *second = in < out ? out : in;
+  FAR sem_t *sem;
+  FAR void *ptr;
+  size_t chunk;
+  size_t done;
+  size_t n;
+  int ret;
+
+  if (in == out)
+    {
+      return -EINVAL;
+    }
+
+  for (; ; )
+    {
+      ret = nxrmutex_lock(&first->d_bflock);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      ret = nxrmutex_lock(&second->d_bflock);
+      if (ret < 0)
+        {
+          nxrmutex_unlock(&first->d_bflock);
+          return ret;
+        }
+
+      sem = NULL;
+      if (circbuf_is_empty(&in->d_buffer))
+        {
+          if (in->d_nwriters <= 0 && PIPE_IS_POLICY_0(in->d_flags))
+            {
+              ret = 0;
+            }
+          else if (pipe_splice_nonblock(infile, flags))
+            {
+              ret = -EAGAIN;
+            }
+          else
+            {
+              sem = &in->d_rdsem;
+            }
+        }
+      else if (out->d_nreaders <= 0 && PIPE_IS_POLICY_0(out->d_flags))
+        {
+          ret = -EPIPE;
+        }
+      else if (circbuf_is_full(&out->d_buffer))
+        {
+          if (pipe_splice_nonblock(outfile, flags))
+            {
+              ret = -EAGAIN;
+            }
+          else
+            {
+              sem = &out->d_wrsem;
+            }
+        }
+      else
+        {
+          break;
+        }
+
+      nxrmutex_unlock(&second->d_bflock);
+      nxrmutex_unlock(&first->d_bflock);
+
+      if (sem == NULL)
+        {
+          return ret;
+        }
+
+      ret = nxsem_wait(sem);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  /* Both pipes are locked, with data in one and room in the other */
+
+  n = MIN(len, MIN(circbuf_used(&in->d_buffer),
+                   circbuf_space(&out->d_buffer)));
+  for (done = 0; done < n; done += chunk)
+    {
+      ptr = circbuf_get_writeptr(&out->d_buffer, &chunk);
+      if (chunk > n - done)
+        {
+          chunk = n - done;
+        }
+
+      circbuf_peekat(&in->d_buffer, in->d_buffer.tail + done, ptr, chunk);
+      circbuf_writecommit(&out->d_buffer, chunk);
+    }
+
+  if (consume)
+    {
+      circbuf_readcommit(&in->d_buffer, n);
+      pipe_splice_consumed(in);
+    }
+
+  pipe_splice_produced(out);
+
+  nxrmutex_unlock(&second->d_bflock);
+  nxrmutex_unlock(&first->d_bflock);
+  return n;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: file_splice
+ *
+ * Description:
+ *   Equivalent to the standard splice() function except that it accepts
+ *   struct file instances instead of file descriptors.
+ *
+ ****************************************************************************/
+
+ssize_t file_splice(FAR struct file *infile, FAR off_t *off_in,
+                    FAR struct file *outfile, FAR off_t *off_out,
+                    size_t len, unsigned int flags)
+{
+  bool inpipe = INODE_IS_PIPE(infile->f_inode);
+  bool outpipe = INODE_IS_PIPE(outfile->f_inode);
+
+  if ((flags & ~SPLICE_F_ALL) != 0 || (!inpipe && !outpipe))
+    {
+      return -EINVAL;
+    }
+
+  if ((inpipe && off_in != NULL) || (outpipe && off_out != NULL))
+    {
+      return -ESPIPE;
+    }
+
+  if ((infile->f_oflags & O_RDOK) == 0 || (outfile->f_oflags & O_WROK) == 0)
+    {
+      return -EBADF;
+    }
+
+  if (len == 0)
+    {
+      return 0;
+    }
+
+  if (inpipe && outpipe)
+    {
+      return pipe_splice_pipe(infile, outfile, len, flags, true);
+    }
+  else if (inpipe)
+    {
+      return pipe_splice_out(infile, outfile, off_out, len, flags);
+    }
+  else
+    {
+      return pipe_splice_in(infile, off_in, outfile, len, flags);
+    }
+}
+
+/****************************************************************************
+ * Name: file_tee
+ *
+ * Description:
+ *   Equivalent to the standard tee() function except that it accepts
+ *   struct file instances instead of file descriptors.
+ *
+ ****************************************************************************/
+
+ssize_t file_tee(FAR struct file *infile, FAR struct file *outfile,
+                 size_t len, unsigned int flags)
+{
+  if ((flags & ~SPLICE_F_ALL) != 0 ||
+      !INODE_IS_PIPE(infile->f_inode) || !INODE_IS_PIPE(outfile->f_inode))
+    {
+      return -EINVAL;
+    }
+
+  if ((infile->f_oflags & O_RDOK) == 0 || (outfile->f_oflags & O_WROK) == 0)
+    {
+      return -EBADF;
+    }
+
+  if (len == 0)
+    {
+      return 0;
+    }
+
+  return pipe_splice_pipe(infile, outfile, len, flags, false);
+}
+
+/****************************************************************************
+ * Name: splice
+ *
+ * Description:
+ *   splice() moves up to 'len' bytes between two file descriptors, at
+ *   least one of which refers to a pipe, without copying the data through
+ *   a user buffer.  The data moves directly between the pipe buffer and
+ *   the other file, socket or pipe.
+ *
+ * Input Parameters:
+ *   fd_in   - The descriptor to read from.
+ *   off_in  - NULL if fd_in is a pipe.  Otherwise, NULL to read from the
+ *             current file position, or the offset to read from, updated
+ *             on return.
+ *   fd_out  - The descriptor to write to.
+ *   off_out - As off_in, for fd_out.
+ *   len     - The maximum number of bytes to move.
+ *   flags   - SPLICE_F_* flags.  SPLICE_F_NONBLOCK makes the pipe
+ *             operations non-blocking.
+ *
+ * Returned Value:
+ *   The number of bytes moved, zero at the end of input, or -1 with errno
+ *   set on failure.
+ *
+ ****************************************************************************/
+
+ssize_t splice(int fd_in, FAR off_t *off_in, int fd_out,
+               FAR off_t *off_out, size_t len, unsigned int flags)
+{
+  FAR struct file *infile;
+  FAR struct file *outfile;
+  ssize_t ret;
+
+  ret = fs_getfilep(fd_in, &infile);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  ret = fs_getfilep(fd_out, &outfile);
+  if (ret < 0)
+    {
+      fs_putfilep(infile);
+      goto errout;
+    }
+
+  ret = file_splice(infile, off_in, outfile, off_out, len, flags);
+  fs_putfilep(outfile);
+  fs_putfilep(infile);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  return ret;
+
+errout:
+  set_errno(-ret);
+  return ERROR;
+}
+
+/****************************************************************************
+ * Name: tee
+ *
+ * Description:
+ *   tee() duplicates up to 'len' bytes from one pipe to another without
+ *   consuming them, so that they can still be read or spliced from fd_in.
+ *
+ * Input Parameters:
+ *   fd_in  - The pipe to read from.
+ *   fd_out - The pipe to write to.
+ *   len    - The maximum number of bytes to duplicate.
+ *   flags  - SPLICE_F_* flags.
+ *
+ * Returned Value:
+ *   The number of bytes duplicated, zero at the end of input, or -1 with
+ *   errno set on failure.
+ *
+ ****************************************************************************/
+
+ssize_t tee(int fd_in, int fd_out, size_t len, unsigned int flags)
+{
+  FAR struct file *infile;
+  FAR struct file *outfile;
+  ssize_t ret;
+
+  ret = fs_getfilep(fd_in, &infile);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  ret = fs_getfilep(fd_out, &outfile);
+  if (ret < 0)
+    {
+      fs_putfilep(infile);
+      goto errout;
+    }
+
+  ret = file_tee(infile, outfile, len, flags);
+  fs_putfilep(outfile);
+  fs_putfilep(infile);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  return ret;
+
+errout:
+  set_errno(-ret);
+  return ERROR;
+}
+
+#endif /* CONFIG_PIPES */
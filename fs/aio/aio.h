@@ -28,6 +28,7 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <stdbool.h>
 #include <string.h>
 #include <aio.h>
 
@@ -64,10 +65,9 @@ struct aio_container_s
   FAR struct aiocb *aioc_aiocbp;   /* The contained AIO control block */
   FAR struct file *aioc_filep;     /* File structure to use with the I/O */
   struct work_s aioc_work;         /* Used to defer I/O to the work thread */
+  worker_t aioc_worker;            /* The function performing the I/O */
   pid_t aioc_pid;                  /* ID of the waiting task */
-#ifdef CONFIG_PRIORITY_INHERITANCE
-  uint8_t aioc_prio;               /* Priority of the waiting task */
-#endif
+  bool aioc_deferred;              /* Waiting for an earlier I/O on the file */
 };
 
 /****************************************************************************
@@ -89,6 +89,10 @@ extern "C"
 
 EXTERN dq_queue_t g_aio_pending;
 
+/* The pool of worker threads performing the asynchronous I/O */
+
+EXTERN FAR struct kwork_wqueue_s *g_aio_wqueue;
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -206,11 +210,16 @@ FAR struct aiocb *aioc_decant(FAR struct aio_container_s *aioc);
  * Name: aio_queue
  *
  * Description:
- *   Schedule the asynchronous I/O on the low priority work queue
+ *   Schedule the asynchronous I/O on the AIO worker threads.  Requests on
+ *   the same regular file or block device are performed one at a time, in
+ *   the order they were queued:  if an earlier request on the file is still
+ *   pending, this one is deferred until aio_start_next() is called for the
+ *   file.  Requests on sockets, pipes and character drivers are not
+ *   ordered, since a blocked read must not hold back a later write.
  *
  * Input Parameters:
- *   arg - Worker argument.  In this case, a pointer to an instance of
- *     struct aiocb cast to void *.
+ *   aioc   - The AIO container, already on the pending list.
+ *   worker - The function that performs the I/O.
  *
  * Returned Value:
  *   Zero (OK) on success.  Otherwise, -1 is returned and the errno is set
@@ -220,6 +229,24 @@ FAR struct aiocb *aioc_decant(FAR struct aio_container_s *aioc);
 
 int aio_queue(FAR struct aio_container_s *aioc, worker_t worker);
 
+/****************************************************************************
+ * Name: aio_start_next
+ *
+ * Description:
+ *   Start the oldest deferred request on an open file, if any.  Called
+ *   with the AIO lock held, once a request on the file left the pending
+ *   list.
+ *
+ * Input Parameters:
+ *   filep - The open file.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void aio_start_next(FAR struct file *filep);
+
 /****************************************************************************
  * Name: aio_signal
  *
@@ -123,15 +123,17 @@ int aio_cancel(int fildes, FAR struct aiocb *aiocbp)
 
           if (aioc)
             {
-              /* Yes... attempt to cancel the I/O.  There are two
+              /* Yes... attempt to cancel the I/O.  There are three
                * possibilities:* (1) the work has already been started and
-               * is no longer queued, or (2) the work has not been started
-               * and is still in the work queue.  Only the second case can
-               * be canceled.  work_cancel() will return -ENOENT in the
-               * first case.
+               * is no longer queued, (2) the work has not been started
+               * and is still in the work queue, or (3) the work is
+               * deferred behind an earlier request on the same file.
+               * Only the last two cases can be canceled.  work_cancel()
+               * will return -ENOENT in the first case.
                */
 
-              status = work_cancel(LPWORK, &aioc->aioc_work);
+              status = aioc->aioc_deferred ? OK :
+                       work_cancel_wq(g_aio_wqueue, &aioc->aioc_work);
               if (status >= 0)
                 {
                   /* Remove the container from the list of pending
@@ -180,15 +182,17 @@ int aio_cancel(int fildes, FAR struct aiocb *aiocbp)
 
           if (aioc)
             {
-              /* Yes... attempt to cancel the I/O.  There are two
+              /* Yes... attempt to cancel the I/O.  There are three
                * possibilities:* (1) the work has already been started and
-               * is no longer queued, or (2) the work has not been started
-               * and is still in the work queue.  Only the second case can
-               * be canceled.  work_cancel() will return -ENOENT in the
-               * first case.
+               * is no longer queued, (2) the work has not been started
+               * and is still in the work queue, or (3) the work is
+               * deferred behind an earlier request on the same file.
+               * Only the last two cases can be canceled.  work_cancel()
+               * will return -ENOENT in the first case.
                */
 
-              status = work_cancel(LPWORK, &aioc->aioc_work);
+              status = aioc->aioc_deferred ? OK :
+                       work_cancel_wq(g_aio_wqueue, &aioc->aioc_work);
               if (status >= 0)
                 {
                   /* Remove the container from the list of pending
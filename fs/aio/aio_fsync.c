@@ -64,22 +64,15 @@ static void aio_fsync_worker(FAR void *arg)
   FAR struct aio_container_s *aioc = (FAR struct aio_container_s *)arg;
   FAR struct aiocb *aiocbp;
   pid_t pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
-  uint8_t prio;
-#endif
   int ret;
 
-  /* Get the information from the container, decant the AIO control block,
-   * and free the container before starting any I/O.  That will minimize
-   * the delays by any other threads waiting for a pre-allocated container.
+  /* The container stays on the pending list while the I/O is in progress:
+   * that keeps any later request on the same file waiting behind this one.
    */
 
   DEBUGASSERT(aioc && aioc->aioc_aiocbp);
   pid    = aioc->aioc_pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
-  prio   = aioc->aioc_prio;
-#endif
-  aiocbp = aioc_decant(aioc);
+  aiocbp = aioc->aioc_aiocbp;
 
   /* Perform the fsync using aioc_filep */
 
@@ -87,22 +80,16 @@ static void aio_fsync_worker(FAR void *arg)
   if (ret < 0)
     {
       ferr("ERROR: file_fsync failed: %d\n", ret);
-      aiocbp->aio_result = ret;
-    }
-  else
-    {
-      aiocbp->aio_result = OK;
     }
 
-  /* Signal the client */
+  /* Free the container, starting the next request on the file, if any */
 
-  aio_signal(pid, aiocbp);
+  aioc_decant(aioc);
 
-#ifdef CONFIG_PRIORITY_INHERITANCE
-  /* Restore the low priority worker thread default priority */
+  /* Set the result of the fsync and signal the client */
 
-  lpwork_restorepriority(prio);
-#endif
+  aiocbp->aio_result = ret < 0 ? ret : OK;
+  aio_signal(pid, aiocbp);
 }
 
 /****************************************************************************
@@ -33,24 +33,62 @@
 #include <debug.h>
 
 #include <nuttx/wqueue.h>
+#include <nuttx/fs/fs.h>
 
 #include "aio/aio.h"
 
 #ifdef CONFIG_FS_AIO
 
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* The pool of worker threads performing the asynchronous I/O, created with
+ * the first request.
+ */
+
+FAR struct kwork_wqueue_s *g_aio_wqueue;
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: aio_ordered
+ *
+ * Description:
+ *   Return true if the requests on an open file must be performed in
+ *   order, i.e. if it is a regular file or a block device.
+ *
+ ****************************************************************************/
+
+static bool aio_ordered(FAR struct file *filep)
+{
+  FAR struct inode *inode = filep->f_inode;
+
+  return inode != NULL &&
+         (INODE_IS_MOUNTPT(inode) || INODE_IS_BLOCK(inode) ||
+          INODE_IS_MTD(inode));
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
 /****************************************************************************
  * Name: aio_queue
  *
  * Description:
- *   Schedule the asynchronous I/O on the low priority work queue
+ *   Schedule the asynchronous I/O on the AIO worker threads.  Requests on
+ *   the same regular file or block device are performed one at a time, in
+ *   the order they were queued:  if an earlier request on the file is still
+ *   pending, this one is deferred until aio_start_next() is called for the
+ *   file.  Requests on sockets, pipes and character drivers are not
+ *   ordered, since a blocked read must not hold back a later write.
  *
  * Input Parameters:
- *   arg - Worker argument.  In this case, a pointer to an instance of
- *     struct aiocb cast to void *.
+ *   aioc   - The AIO container, already on the pending list.
+ *   worker - The function that performs the I/O.
  *
  * Returned Value:
  *   Zero (OK) on success.  Otherwise, -1 is returned and the errno is set
@@ -60,42 +98,124 @@
 
 int aio_queue(FAR struct aio_container_s *aioc, worker_t worker)
 {
+  FAR struct aio_container_s *prev;
   int ret;
 
-#ifdef CONFIG_PRIORITY_INHERITANCE
-  /* Prohibit context switches until we complete the queuing */
+  ret = aio_lock();
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  if (g_aio_wqueue == NULL)
+    {
+      g_aio_wqueue = work_queue_create("aio", CONFIG_FS_AIO_PRIORITY, NULL,
+                                       CONFIG_FS_AIO_STACKSIZE,
+                                       CONFIG_FS_AIO_NWORKERS);
+      if (g_aio_wqueue == NULL)
+        {
+          aio_unlock();
+          ret = -ENOMEM;
+          goto errout;
+        }
+    }
 
-  sched_lock();
+  /* Is an earlier request on the same file still pending? */
 
-  /* Make sure that the low-priority worker thread is running at at least
-   * the priority specified for this action.
-   */
+  aioc->aioc_worker = worker;
+  prev = NULL;
 
-  lpwork_boostpriority(aioc->aioc_prio);
-#endif
+  if (aio_ordered(aioc->aioc_filep))
+    {
+      for (prev = (FAR struct aio_container_s *)aioc->aioc_link.blink;
+           prev != NULL && prev->aioc_filep != aioc->aioc_filep;
+           prev = (FAR struct aio_container_s *)prev->aioc_link.blink);
+    }
 
-  /* Schedule the work on the low priority worker thread */
+  if (prev != NULL)
+    {
+      /* Yes.. aio_start_next() will queue this one after it */
 
-  ret = work_queue(LPWORK, &aioc->aioc_work, worker, aioc, 0);
-  if (ret < 0)
+      aioc->aioc_deferred = true;
+    }
+  else
     {
-      FAR struct aiocb *aiocbp = aioc->aioc_aiocbp;
-      DEBUGASSERT(aiocbp);
+      ret = work_queue_wq(g_aio_wqueue, &aioc->aioc_work, worker, aioc, 0);
+    }
 
-#ifdef CONFIG_PRIORITY_INHERITANCE
-      lpwork_restorepriority(aioc->aioc_prio);
-#endif
-      aiocbp->aio_result = ret;
-      set_errno(-ret);
-      ret = ERROR;
+  aio_unlock();
+  if (ret >= 0)
+    {
+      return OK;
     }
 
-#ifdef CONFIG_PRIORITY_INHERITANCE
-  /* Now the low-priority work queue might run at its new priority */
+errout:
+  aioc->aioc_aiocbp->aio_result = ret;
+  set_errno(-ret);
+  return ERROR;
+}
 
-  sched_unlock();
-#endif
-  return ret;
+/****************************************************************************
+ * Name: aio_start_next
+ *
+ * Description:
+ *   Start the oldest deferred request on an open file, if any.  Called
+ *   with the AIO lock held, once a request on the file left the pending
+ *   list.  A request that can't be queued is completed with the error.
+ *
+ * Input Parameters:
+ *   filep - The open file.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void aio_start_next(FAR struct file *filep)
+{
+  FAR struct aio_container_s *next;
+  FAR struct aiocb *aiocbp;
+  pid_t pid;
+  int ret;
+
+  for (; ; )
+    {
+      for (next = (FAR struct aio_container_s *)g_aio_pending.head;
+           next != NULL && next->aioc_filep != filep;
+           next = (FAR struct aio_container_s *)next->aioc_link.flink);
+
+      /* The oldest pending request on the file is either running already
+       * or waiting for this moment.
+       */
+
+      if (next == NULL || !next->aioc_deferred)
+        {
+          return;
+        }
+
+      next->aioc_deferred = false;
+      ret = work_queue_wq(g_aio_wqueue, &next->aioc_work,
+                          next->aioc_worker, next, 0);
+      if (ret >= 0)
+        {
+          return;
+        }
+
+      /* Complete the request with the error, as aio_queue() would have,
+       * and try the one after it.
+       */
+
+      ferr("ERROR: work_queue_wq failed: %d\n", ret);
+
+      pid    = next->aioc_pid;
+      aiocbp = next->aioc_aiocbp;
+      dq_rem(&next->aioc_link, &g_aio_pending);
+      fs_putfilep(next->aioc_filep);
+      aioc_free(next);
+
+      aiocbp->aio_result = ret;
+      aio_signal(pid, aiocbp);
+    }
 }
 
 #endif /* CONFIG_FS_AIO */
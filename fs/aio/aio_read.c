@@ -64,22 +64,15 @@ static void aio_read_worker(FAR void *arg)
   FAR struct aio_container_s *aioc = (FAR struct aio_container_s *)arg;
   FAR struct aiocb *aiocbp;
   pid_t pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
-  uint8_t prio;
-#endif
   ssize_t nread = 0;
 
-  /* Get the information from the container, decant the AIO control block,
-   * and free the container before starting any I/O.  That will minimize
-   * the delays by any other threads waiting for a pre-allocated container.
+  /* The container stays on the pending list while the I/O is in progress:
+   * that keeps any later request on the same file waiting behind this one.
    */
 
   DEBUGASSERT(aioc && aioc->aioc_aiocbp);
   pid    = aioc->aioc_pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
-  prio   = aioc->aioc_prio;
-#endif
-  aiocbp = aioc_decant(aioc);
+  aiocbp = aioc->aioc_aiocbp;
 
   /* Perform the file read using:
    *
@@ -92,8 +85,6 @@ static void aio_read_worker(FAR void *arg)
   nread = file_pread(aioc->aioc_filep, (FAR void *)aiocbp->aio_buf,
                      aiocbp->aio_nbytes, aiocbp->aio_offset);
 
-  /* Set the result of the read operation. */
-
 #ifdef CONFIG_DEBUG_FS_ERROR
   if (nread < 0)
     {
@@ -101,17 +92,14 @@ static void aio_read_worker(FAR void *arg)
     }
 #endif
 
-  aiocbp->aio_result = nread;
+  /* Free the container, starting the next request on the file, if any */
 
-  /* Signal the client */
+  aioc_decant(aioc);
 
-  aio_signal(pid, aiocbp);
+  /* Set the result of the read and signal the client */
 
-#ifdef CONFIG_PRIORITY_INHERITANCE
-  /* Restore the low priority worker thread default priority */
-
-  lpwork_restorepriority(prio);
-#endif
+  aiocbp->aio_result = nread;
+  aio_signal(pid, aiocbp);
 }
 
 /****************************************************************************
@@ -66,23 +66,16 @@ static void aio_write_worker(FAR void *arg)
   FAR struct aio_container_s *aioc = (FAR struct aio_container_s *)arg;
   FAR struct aiocb *aiocbp;
   pid_t pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
-  uint8_t prio;
-#endif
   ssize_t nwritten = 0;
   int oflags;
 
-  /* Get the information from the container, decant the AIO control block,
-   * and free the container before starting any I/O.  That will minimize
-   * the delays by any other threads waiting for a pre-allocated container.
+  /* The container stays on the pending list while the I/O is in progress:
+   * that keeps any later request on the same file waiting behind this one.
    */
 
   DEBUGASSERT(aioc && aioc->aioc_aiocbp);
   pid    = aioc->aioc_pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
-  prio   = aioc->aioc_prio;
-#endif
-  aiocbp = aioc_decant(aioc);
+  aiocbp = aioc->aioc_aiocbp;
 
   /* Call fcntl(F_GETFL) to get the file open mode. */
 
@@ -90,7 +83,7 @@ static void aio_write_worker(FAR void *arg)
   if (oflags < 0)
     {
       ferr("ERROR: file_fcntl failed: %d\n", oflags);
-      aiocbp->aio_result = oflags;
+      nwritten = oflags;
       goto errout;
     }
 
@@ -125,21 +118,15 @@ static void aio_write_worker(FAR void *arg)
       ferr("ERROR: write/pwrite/send failed: %zd\n", nwritten);
     }
 
-  /* Save the result of the write */
-
-  aiocbp->aio_result = nwritten;
-
 errout:
+  /* Free the container, starting the next request on the file, if any */
 
-  /* Signal the client */
+  aioc_decant(aioc);
 
-  aio_signal(pid, aiocbp);
+  /* Save the result of the write and signal the client */
 
-#ifdef CONFIG_PRIORITY_INHERITANCE
-  /* Restore the low priority worker thread default priority */
-
-  lpwork_restorepriority(prio);
-#endif
+  aiocbp->aio_result = nwritten;
+  aio_signal(pid, aiocbp);
 }
 
 /****************************************************************************
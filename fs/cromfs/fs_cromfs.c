@@ -43,6 +43,7 @@
 #include <nuttx/kmalloc.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/fs/ioctl.h>
+#include <nuttx/mutex.h>
 
 #include "cromfs.h"
 #include "fs_heap.h"
@@ -66,14 +67,46 @@ struct cromfs_dir_s
   uint32_t cr_curroffset;     /* Current offset into the directory contents */
 };
 
+#ifdef CONFIG_FS_CROMFS_BLOCKINDEX
+/* This structure describes one compressed block of an open file */
+
+struct cromfs_blkindex_s
+{
+  uint32_t bi_foffset;    /* Offset of the block data in the file */
+  uint32_t bi_hdroffset;  /* Offset of the block header in the image */
+};
+#endif
+
+#if CONFIG_FS_CROMFS_CACHE_NBLOCKS > 0
+/* This structure describes one entry of the shared cache of decompressed
+ * blocks.
+ */
+
+struct cromfs_cache_s
+{
+  uint32_t cc_offset;     /* Cached block offset (zero means none) */
+  uint32_t cc_lru;        /* Time of the last access */
+  uint16_t cc_ulen;       /* Length of decompressed data in cache */
+  FAR uint8_t *cc_buffer; /* Cached, decompressed data */
+};
+#endif
+
 /* This structure represents an open, regular file */
 
 struct cromfs_file_s
 {
   FAR const struct cromfs_node_s *ff_node;  /* The open file node */
+#if CONFIG_FS_CROMFS_CACHE_NBLOCKS == 0
   uint32_t ff_offset;                       /* Cached block offset (zero means none) */
   uint16_t ff_ulen;                         /* Length of decompressed data in cache */
   FAR uint8_t *ff_buffer;                   /* Cached, decompressed data */
+#endif
+#ifdef CONFIG_FS_CROMFS_BLOCKINDEX
+  FAR struct cromfs_blkindex_s *ff_index;   /* Block index (built on first read) */
+  uint32_t ff_nblocks;                      /* Number of blocks in ff_index */
+  uint32_t ff_blksize;                      /* Common block size (zero if not) */
+  bool ff_noindex;                          /* Index could not be built */
+#endif
 };
 
 /* This is the form of the callback from cromfs_foreach_node(): */
@@ -126,6 +159,28 @@ static int      cromfs_foreach_node(FAR const struct cromfs_volume_s *fs,
                                     bool follow, cromfs_foreach_t callback,
                                     FAR void *arg);
 static uint16_t cromfs_seglen(FAR const char *relpath);
+static uint32_t cromfs_parse_header(FAR const struct lzf_header_s *hdr,
+                                    FAR uint16_t *ulen, FAR uint16_t *clen);
+#ifdef CONFIG_FS_CROMFS_BLOCKINDEX
+static int      cromfs_build_index(FAR const struct cromfs_volume_s *fs,
+                                   FAR struct cromfs_file_s *ff);
+static FAR struct lzf_header_s *
+                cromfs_seek_block(FAR const struct cromfs_volume_s *fs,
+                                  FAR struct cromfs_file_s *ff, off_t fpos,
+                                  FAR uint32_t *blkoffs);
+#endif
+#if CONFIG_FS_CROMFS_CACHE_NBLOCKS > 0
+static FAR struct cromfs_cache_s *
+                cromfs_cache_find(uint32_t voloffs);
+static FAR struct cromfs_cache_s *
+                cromfs_cache_alloc(FAR const struct cromfs_volume_s *fs);
+#endif
+static int      cromfs_decompress(FAR const struct cromfs_volume_s *fs,
+                                  FAR struct cromfs_file_s *ff,
+                                  FAR const uint8_t *src, uint16_t clen,
+                                  uint16_t ulen, FAR uint8_t *dest,
+                                  unsigned int copyoffs,
+                                  unsigned int copysize);
 static int      cromfs_child_node(FAR const struct cromfs_volume_s *fs,
                                   FAR const struct cromfs_node_s *node,
                                   FAR struct cromfs_nodeinfo_s *info);
@@ -174,6 +229,21 @@ static int      cromfs_statfs(FAR struct inode *mountpt,
 static int      cromfs_stat(FAR struct inode *mountpt,
                             FAR const char *relpath, FAR struct stat *buf);
 
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#if CONFIG_FS_CROMFS_CACHE_NBLOCKS > 0
+/* The cache of decompressed blocks is shared by all open files.  Since
+ * there is only one CROMFS image, it stays valid for the life of the
+ * system.
+ */
+
+static struct cromfs_cache_s g_cromfs_cache[CONFIG_FS_CROMFS_CACHE_NBLOCKS];
+static uint32_t g_cromfs_cacheclock;
+static mutex_t g_cromfs_cachelock = NXMUTEX_INITIALIZER;
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -728,6 +798,364 @@ static int cromfs_find_node(FAR const struct cromfs_volume_s *fs,
     }
 }
 
+/****************************************************************************
+ * Name: cromfs_parse_header
+ *
+ * Description:
+ *   Get the uncompressed and compressed data lengths from an LZF block
+ *   header and return the total size of the block in the image.
+ *
+ ****************************************************************************/
+
+static uint32_t cromfs_parse_header(FAR const struct lzf_header_s *hdr,
+                                    FAR uint16_t *ulen, FAR uint16_t *clen)
+{
+  if (hdr->lzf_type == LZF_TYPE0_HDR)
+    {
+      FAR const struct lzf_type0_header_s *hdr0 =
+        (FAR const struct lzf_type0_header_s *)hdr;
+
+      *ulen = (uint16_t)hdr0->lzf_len[0] << 8 |
+              (uint16_t)hdr0->lzf_len[1];
+      *clen = *ulen;
+      return (uint32_t)*ulen + LZF_TYPE0_HDR_SIZE;
+    }
+  else
+    {
+      FAR const struct lzf_type1_header_s *hdr1 =
+        (FAR const struct lzf_type1_header_s *)hdr;
+
+      *ulen = (uint16_t)hdr1->lzf_ulen[0] << 8 |
+              (uint16_t)hdr1->lzf_ulen[1];
+      *clen = (uint16_t)hdr1->lzf_clen[0] << 8 |
+              (uint16_t)hdr1->lzf_clen[1];
+      return (uint32_t)*clen + LZF_TYPE1_HDR_SIZE;
+    }
+}
+
+#ifdef CONFIG_FS_CROMFS_BLOCKINDEX
+/****************************************************************************
+ * Name: cromfs_build_index
+ *
+ * Description:
+ *   Walk the chain of block headers of an open file once and record where
+ *   each block starts, both in the file and in the image.
+ *
+ ****************************************************************************/
+
+static int cromfs_build_index(FAR const struct cromfs_volume_s *fs,
+                              FAR struct cromfs_file_s *ff)
+{
+  FAR const uint8_t *first;
+  FAR const uint8_t *hdr;
+  uint32_t foffset;
+  uint32_t nblocks;
+  uint32_t blksize;
+  uint32_t i;
+  uint16_t ulen;
+  uint16_t clen;
+
+  /* Count the blocks of the file */
+
+  first   = cromfs_offset2addr(fs, ff->ff_node->u.cn_blocks);
+  hdr     = first;
+  foffset = 0;
+  nblocks = 0;
+
+  while (foffset < ff->ff_node->cn_size)
+    {
+      hdr += cromfs_parse_header((FAR const struct lzf_header_s *)hdr,
+                                 &ulen, &clen);
+      if (ulen == 0)
+        {
+          return -EIO;
+        }
+
+      foffset += ulen;
+      nblocks++;
+    }
+
+  if (nblocks == 0)
+    {
+      return -ENODATA;
+    }
+
+  ff->ff_index = fs_heap_malloc(nblocks * sizeof(struct cromfs_blkindex_s));
+  if (ff->ff_index == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  /* Then record each of them.  If all blocks but the last one have the
+   * same size, the block holding an offset can be found by division.
+   */
+
+  hdr     = first;
+  foffset = 0;
+  blksize = 0;
+
+  for (i = 0; i < nblocks; i++)
+    {
+      ff->ff_index[i].bi_foffset   = foffset;
+      ff->ff_index[i].bi_hdroffset = cromfs_addr2offset(fs, hdr);
+
+      hdr += cromfs_parse_header((FAR const struct lzf_header_s *)hdr,
+                                 &ulen, &clen);
+      foffset += ulen;
+
+      if (i == 0)
+        {
+          blksize = ulen;
+        }
+      else if (i < nblocks - 1 && ulen != blksize)
+        {
+          blksize = 0;
+        }
+    }
+
+  ff->ff_nblocks = nblocks;
+  ff->ff_blksize = blksize;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: cromfs_seek_block
+ *
+ * Description:
+ *   Return the header of the block of an open file that holds the file
+ *   offset 'fpos' and the file offset of the start of that block.  If the
+ *   block index cannot be built, the first block of the file is returned
+ *   and the caller will search forward from there.  The failure is
+ *   remembered so that later reads do not walk the file again.
+ *
+ ****************************************************************************/
+
+static FAR struct lzf_header_s *
+cromfs_seek_block(FAR const struct cromfs_volume_s *fs,
+                  FAR struct cromfs_file_s *ff, off_t fpos,
+                  FAR uint32_t *blkoffs)
+{
+  uint32_t index;
+
+  if (ff->ff_index == NULL &&
+      (ff->ff_noindex || cromfs_build_index(fs, ff) < 0))
+    {
+      ff->ff_noindex = true;
+      *blkoffs = 0;
+      return cromfs_offset2addr(fs, ff->ff_node->u.cn_blocks);
+    }
+
+  if (ff->ff_blksize > 0)
+    {
+      index = fpos / ff->ff_blksize;
+      if (index >= ff->ff_nblocks)
+        {
+          index = ff->ff_nblocks - 1;
+        }
+    }
+  else
+    {
+      uint32_t high = ff->ff_nblocks - 1;
+      uint32_t mid;
+
+      /* Find the last block starting at or before fpos */
+
+      index = 0;
+      while (index < high)
+        {
+          mid = (index + high + 1) / 2;
+          if (ff->ff_index[mid].bi_foffset <= fpos)
+            {
+              index = mid;
+            }
+          else
+            {
+              high = mid - 1;
+            }
+        }
+    }
+
+  *blkoffs = ff->ff_index[index].bi_foffset;
+  return cromfs_offset2addr(fs, ff->ff_index[index].bi_hdroffset);
+}
+#endif
+
+#if CONFIG_FS_CROMFS_CACHE_NBLOCKS > 0
+/****************************************************************************
+ * Name: cromfs_cache_find
+ *
+ * Description:
+ *   Return the cache entry holding the block whose compressed data is at
+ *   'voloffs' in the image, or NULL if that block is not cached.  The
+ *   caller must hold g_cromfs_cachelock.
+ *
+ ****************************************************************************/
+
+static FAR struct cromfs_cache_s *cromfs_cache_find(uint32_t voloffs)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_FS_CROMFS_CACHE_NBLOCKS; i++)
+    {
+      if (g_cromfs_cache[i].cc_offset == voloffs)
+        {
+          return &g_cromfs_cache[i];
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: cromfs_cache_alloc
+ *
+ * Description:
+ *   Return an unused cache entry, or else the least recently used one,
+ *   with a buffer of one block.  NULL is returned if the buffer cannot be
+ *   allocated.  The caller must hold g_cromfs_cachelock.
+ *
+ ****************************************************************************/
+
+static FAR struct cromfs_cache_s *
+cromfs_cache_alloc(FAR const struct cromfs_volume_s *fs)
+{
+  FAR struct cromfs_cache_s *victim = &g_cromfs_cache[0];
+  int i;
+
+  for (i = 0; i < CONFIG_FS_CROMFS_CACHE_NBLOCKS; i++)
+    {
+      if (g_cromfs_cache[i].cc_offset == 0)
+        {
+          victim = &g_cromfs_cache[i];
+          break;
+        }
+      else if (g_cromfs_cache[i].cc_lru < victim->cc_lru)
+        {
+          victim = &g_cromfs_cache[i];
+        }
+    }
+
+  victim->cc_offset = 0;
+  if (victim->cc_buffer == NULL)
+    {
+      victim->cc_buffer = fs_heap_malloc(fs->cv_bsize);
+      if (victim->cc_buffer == NULL)
+        {
+          return NULL;
+        }
+    }
+
+  return victim;
+}
+#endif
+
+/****************************************************************************
+ * Name: cromfs_decompress
+ *
+ * Description:
+ *   Copy 'copysize' bytes at offset 'copyoffs' of the decompressed data of
+ *   an LZF type 1 block into the user buffer.  A cached copy of the block
+ *   is used if there is one.  A block that is not cached and is wanted
+ *   whole is decompressed directly into the user buffer.
+ *
+ ****************************************************************************/
+
+static int cromfs_decompress(FAR const struct cromfs_volume_s *fs,
+                             FAR struct cromfs_file_s *ff,
+                             FAR const uint8_t *src, uint16_t clen,
+                             uint16_t ulen, FAR uint8_t *dest,
+                             unsigned int copyoffs, unsigned int copysize)
+{
+#if CONFIG_FS_CROMFS_CACHE_NBLOCKS > 0
+  FAR struct cromfs_cache_s *entry;
+  int ret;
+#endif
+  unsigned int decomplen;
+  uint32_t voloffs;
+
+  voloffs = cromfs_addr2offset(fs, src);
+
+#if CONFIG_FS_CROMFS_CACHE_NBLOCKS > 0
+  ret = nxmutex_lock(&g_cromfs_cachelock);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  entry = cromfs_cache_find(voloffs);
+  if (entry == NULL)
+    {
+      if (copyoffs == 0 && copysize == ulen)
+        {
+          /* The whole block is wanted.  Decompress it directly into the
+           * user buffer.
+           */
+
+          nxmutex_unlock(&g_cromfs_cachelock);
+
+          decomplen = lzf_decompress(src, clen, dest, ulen);
+          DEBUGASSERT(decomplen == ulen);
+          UNUSED(decomplen);
+          return OK;
+        }
+
+      entry = cromfs_cache_alloc(fs);
+      if (entry == NULL)
+        {
+          nxmutex_unlock(&g_cromfs_cachelock);
+          return -ENOMEM;
+        }
+
+      decomplen = lzf_decompress(src, clen, entry->cc_buffer, fs->cv_bsize);
+
+      entry->cc_offset = voloffs;
+      entry->cc_ulen   = decomplen;
+    }
+
+  finfo("voloffs=%" PRIu32 " ulen=%" PRIu16 " clen=%" PRIu16
+        " copyoffs=%u copysize=%u\n",
+        voloffs, ulen, clen, copyoffs, copysize);
+  DEBUGASSERT(entry->cc_ulen >= (copyoffs + copysize));
+
+  /* Then copy to user buffer */
+
+  entry->cc_lru = ++g_cromfs_cacheclock;
+  memcpy(dest, &entry->cc_buffer[copyoffs], copysize);
+  nxmutex_unlock(&g_cromfs_cachelock);
+#else
+  if (voloffs != ff->ff_offset)
+    {
+      if (copyoffs == 0 && copysize == ulen)
+        {
+          /* The whole block is wanted.  Decompress it directly into the
+           * user buffer.
+           */
+
+          decomplen = lzf_decompress(src, clen, dest, ulen);
+          DEBUGASSERT(decomplen == ulen);
+          UNUSED(decomplen);
+          return OK;
+        }
+
+      decomplen = lzf_decompress(src, clen, ff->ff_buffer, fs->cv_bsize);
+
+      ff->ff_offset = voloffs;
+      ff->ff_ulen   = decomplen;
+    }
+
+  finfo("voloffs=%" PRIu32 " ulen=%" PRIu16 " clen=%" PRIu16
+        " ff_offset=%" PRIu32 " copyoffs=%u copysize=%u\n",
+        voloffs, ulen, clen, ff->ff_offset, copyoffs, copysize);
+  DEBUGASSERT(ff->ff_ulen >= (copyoffs + copysize));
+
+  /* Then copy to user buffer */
+
+  memcpy(dest, &ff->ff_buffer[copyoffs], copysize);
+#endif
+
+  return OK;
+}
+
 /****************************************************************************
  * Name: cromfs_open
  ****************************************************************************/
@@ -796,6 +1224,7 @@ static int cromfs_open(FAR struct file *filep, FAR const char *relpath,
       return -ENOMEM;
     }
 
+#if CONFIG_FS_CROMFS_CACHE_NBLOCKS == 0
   /* Create a file buffer to support partial sector accesses */
 
   ff->ff_buffer = fs_heap_malloc(fs->cv_bsize);
@@ -804,6 +1233,7 @@ static int cromfs_open(FAR struct file *filep, FAR const char *relpath,
       fs_heap_free(ff);
       return -ENOMEM;
     }
+#endif
 
   /* Save the node in the open file instance */
 
@@ -830,11 +1260,16 @@ static int cromfs_close(FAR struct file *filep)
   /* Get the open file instance from the file structure */
 
   ff = filep->f_priv;
-  DEBUGASSERT(ff->ff_node != NULL && ff->ff_buffer != NULL);
+  DEBUGASSERT(ff->ff_node != NULL);
 
   /* Free all resources consumed by the opened file */
 
+#if CONFIG_FS_CROMFS_CACHE_NBLOCKS == 0
   fs_heap_free(ff->ff_buffer);
+#endif
+#ifdef CONFIG_FS_CROMFS_BLOCKINDEX
+  fs_heap_free(ff->ff_index);
+#endif
   fs_heap_free(ff);
 
   return OK;
@@ -861,6 +1296,7 @@ static ssize_t cromfs_read(FAR struct file *filep, FAR char *buffer,
   uint16_t clen;
   unsigned int copysize;
   unsigned int copyoffs;
+  int ret;
 
   finfo("Read %zu bytes from offset %jd\n", buflen, (intmax_t)filep->f_pos);
   DEBUGASSERT(filep->f_priv != NULL);
@@ -876,7 +1312,7 @@ static ssize_t cromfs_read(FAR struct file *filep, FAR char *buffer,
   /* Get the open file instance from the file structure */
 
   ff = (FAR struct cromfs_file_s *)filep->f_priv;
-  DEBUGASSERT(ff->ff_node != NULL && ff->ff_buffer != NULL);
+  DEBUGASSERT(ff->ff_node != NULL);
 
   /* Check for a read past the end of the file */
 
@@ -902,10 +1338,14 @@ static ssize_t cromfs_read(FAR struct file *filep, FAR char *buffer,
   dest      = (FAR uint8_t *)buffer;
   remaining = buflen;
   fpos      = filep->f_pos;
-  blkoffs   = 0;
   ulen      = 0;
+#ifdef CONFIG_FS_CROMFS_BLOCKINDEX
+  nexthdr   = cromfs_seek_block(fs, ff, fpos, &blkoffs);
+#else
+  blkoffs   = 0;
   nexthdr   = (FAR struct lzf_header_s *)
                cromfs_offset2addr(fs, ff->ff_node->u.cn_blocks);
+#endif
 
   /* Look until we find the compressed block containing the start of the
    * requested data.
@@ -927,36 +1367,24 @@ static ssize_t cromfs_read(FAR struct file *filep, FAR char *buffer,
 
           currhdr  = nexthdr;
           blkoffs += ulen;
-
-          if (currhdr->lzf_type == LZF_TYPE0_HDR)
-            {
-              FAR struct lzf_type0_header_s *hdr0 =
-                (FAR struct lzf_type0_header_s *)currhdr;
-
-              ulen    = (uint16_t)hdr0->lzf_len[0] << 8 |
-                        (uint16_t)hdr0->lzf_len[1];
-              blksize = (uint32_t)ulen + LZF_TYPE0_HDR_SIZE;
-            }
-          else
-            {
-              FAR struct lzf_type1_header_s * hdr1 =
-                (FAR struct lzf_type1_header_s *)currhdr;
-
-              ulen    = (uint16_t)hdr1->lzf_ulen[0] << 8 |
-                        (uint16_t)hdr1->lzf_ulen[1];
-              clen    = (uint16_t)hdr1->lzf_clen[0] << 8 |
-                        (uint16_t)hdr1->lzf_clen[1];
-              blksize = (uint32_t)clen + LZF_TYPE1_HDR_SIZE;
-            }
-
+          blksize  = cromfs_parse_header(currhdr, &ulen, &clen);
           nexthdr  = (FAR struct lzf_header_s *)
                      ((FAR uint8_t *)currhdr + blksize);
         }
       while (fpos >= (blkoffs + ulen));
 
-      /* Check if we need to decompress the next block into the user
-       * buffer.
-       */
+      /* Get the part of the block that is needed */
+
+      copyoffs = (blkoffs >= filep->f_pos) ? 0 : filep->f_pos - blkoffs;
+      DEBUGASSERT(ulen > copyoffs);
+      copysize = ulen - copyoffs;
+
+      if (copysize > remaining)
+        {
+          /* Clip to the size really needed */
+
+          copysize = remaining;
+        }
 
       if (currhdr->lzf_type == LZF_TYPE0_HDR)
         {
@@ -964,17 +1392,6 @@ static ssize_t cromfs_read(FAR struct file *filep, FAR char *buffer,
            * user buffer.
            */
 
-          copyoffs = (blkoffs >= filep->f_pos) ? 0 : filep->f_pos - blkoffs;
-          DEBUGASSERT(ulen > copyoffs);
-          copysize = ulen - copyoffs;
-
-          if (copysize > remaining)
-            {
-              /* Clip to the size really needed */
-
-              copysize = remaining;
-            }
-
           src = (FAR const uint8_t *)currhdr + LZF_TYPE0_HDR_SIZE;
           memcpy(dest, &src[copyoffs], copysize);
 
@@ -983,85 +1400,22 @@ static ssize_t cromfs_read(FAR struct file *filep, FAR char *buffer,
         }
       else
         {
-          /* If the source of the data is at the beginning of the compressed
-           * data buffer and if the uncompressed data would not overrun the
-           * buffer, then we can decompress directly into the user buffer.
-           */
+          /* Decompress the block, or use the cached, decompressed copy */
 
-          if (filep->f_pos <= blkoffs && ulen <= remaining)
+          src = (FAR const uint8_t *)currhdr + LZF_TYPE1_HDR_SIZE;
+          ret = cromfs_decompress(fs, ff, src, clen, ulen, dest,
+                                  copyoffs, copysize);
+          if (ret < 0)
             {
-              uint32_t voloffs;
-
-              copyoffs = 0;
-              copysize = ulen;
-
-              /* Get the address and offset in the CROMFS image to obtain
-               * the data.  Check if we already have this offset in the
-               * cache.
-               */
+              /* Return the data read so far, if any */
 
-              src     = (FAR const uint8_t *)currhdr + LZF_TYPE1_HDR_SIZE;
-              voloffs = cromfs_addr2offset(fs, src);
-              if (voloffs != ff->ff_offset)
+              if (remaining < buflen)
                 {
-                  unsigned int decomplen;
-
-                  decomplen = lzf_decompress(src, clen, dest, fs->cv_bsize);
-
-                  ff->ff_offset = voloffs;
-                  ff->ff_ulen   = decomplen;
+                  filep->f_pos = fpos;
+                  return buflen - remaining;
                 }
 
-              finfo("voloffs=%" PRIu32 " blkoffs=%" PRIu32
-                    " ulen=%" PRIu16 " ff_offset=%" PRIu32 " copysize=%u\n",
-                    voloffs, blkoffs, ulen, ff->ff_offset, copysize);
-              DEBUGASSERT(ff->ff_ulen >= copysize);
-            }
-          else
-            {
-              uint32_t voloffs;
-
-              /* No, we will need to decompress into the our intermediate
-               * decompression buffer.
-               */
-
-              copyoffs = (blkoffs >= filep->f_pos) ?
-                            0 : filep->f_pos - blkoffs;
-              DEBUGASSERT(ulen > copyoffs);
-              copysize = ulen - copyoffs;
-
-              if (copysize > remaining)
-                {
-                  /* Clip to the size really needed */
-
-                  copysize = remaining;
-                }
-
-              DEBUGASSERT((copyoffs + copysize) <=  fs->cv_bsize);
-
-              src = (FAR const uint8_t *)currhdr + LZF_TYPE1_HDR_SIZE;
-              voloffs = cromfs_addr2offset(fs, src);
-              if (voloffs != ff->ff_offset)
-                {
-                  unsigned int decomplen;
-
-                  decomplen = lzf_decompress(src, clen, ff->ff_buffer,
-                                             fs->cv_bsize);
-
-                  ff->ff_offset = voloffs;
-                  ff->ff_ulen   = decomplen;
-                }
-
-              finfo("voloffs=%" PRIu32 " blkoffs=%" PRIu32 " ulen=%" PRIu16
-                    " clen=%" PRIu16 " ff_offset=%" PRIu32
-                    "  copyoffs=%u copysize=%u\n",
-                    voloffs, blkoffs, ulen, clen, ff->ff_offset,
-                    copyoffs, copysize);
-              DEBUGASSERT(ff->ff_ulen >= (copyoffs + copysize));
-
-              /* Then copy to user buffer */
-
-              memcpy(dest, &ff->ff_buffer[copyoffs], copysize);
+              return ret;
             }
         }
 
@@ -1117,7 +1471,7 @@ static int cromfs_dup(FAR const struct file *oldp, FAR struct file *newp)
   /* Get the open file instance from the file structure */
 
   oldff = oldp->f_priv;
-  DEBUGASSERT(oldff->ff_node != NULL && oldff->ff_buffer != NULL);
+  DEBUGASSERT(oldff->ff_node != NULL);
 
   /* Allocate and initialize an new open file instance referring to the
    * same node.
@@ -1129,6 +1483,7 @@ static int cromfs_dup(FAR const struct file *oldp, FAR struct file *newp)
       return -ENOMEM;
     }
 
+#if CONFIG_FS_CROMFS_CACHE_NBLOCKS == 0
   /* Create a file buffer to support partial sector accesses */
 
   newff->ff_buffer = fs_heap_malloc(fs->cv_bsize);
@@ -1137,6 +1492,7 @@ static int cromfs_dup(FAR const struct file *oldp, FAR struct file *newp)
       fs_heap_free(newff);
       return -ENOMEM;
     }
+#endif
 
   /* Save the node in the open file instance */
 
@@ -1174,7 +1530,7 @@ static int cromfs_fstat(FAR const struct file *filep, FAR struct stat *buf)
    */
 
   ff              = filep->f_priv;
-  DEBUGASSERT(ff->ff_node != NULL && ff->ff_buffer != NULL);
+  DEBUGASSERT(ff->ff_node != NULL);
 
   inode           = filep->f_inode;
   fs              = inode->i_private;
@@ -0,0 +1,876 @@
+/****************************************************************************
+ * fs/driver/fs_blockcache.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <assert.h>
+#include <debug.h>
+#include <errno.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/mutex.h>
+#include <nuttx/queue.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/mm/mm.h>
+
+#ifdef CONFIG_FS_BLOCKCACHE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define BLOCKCACHE_NBLOCKS    CONFIG_FS_BLOCKCACHE_NBLOCKS
+#define BLOCKCACHE_BLOCKSIZE  CONFIG_FS_BLOCKCACHE_BLOCKSIZE
+#define BLOCKCACHE_READAHEAD  CONFIG_FS_BLOCKCACHE_READAHEAD
+#define BLOCKCACHE_NBUCKETS   CONFIG_FS_BLOCKCACHE_NBLOCKS
+#define BLOCKCACHE_POOLSIZE   ((BLOCKCACHE_NBLOCKS + BLOCKCACHE_READAHEAD) * \
+                               BLOCKCACHE_BLOCKSIZE)
+
+#define BLOCKCACHE_HASH(i, s) \
+  ((((uintptr_t)(i) / sizeof(struct inode)) ^ (size_t)(s)) % \
+   BLOCKCACHE_NBUCKETS)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One cached device sector.  A busy entry is being read from or written to
+ * the device with the cache unlocked; nobody else may use, recycle or drop
+ * it until it is idle again.
+ */
+
+struct blockcache_entry_s
+{
+  dq_entry_t node;                      /* LRU list link, most recent first */
+  FAR struct blockcache_entry_s *hnext; /* Next entry in the hash chain */
+  FAR struct inode *inode;              /* Block device (NULL if unused) */
+  blkcnt_t sector;                      /* Sector number on the device */
+  bool dirty;                           /* Not yet written to the device */
+  bool busy;                            /* Device I/O in progress */
+  FAR uint8_t *data;                    /* Sector data */
+};
+
+/* The state of the shared block cache */
+
+struct blockcache_s
+{
+  mutex_t lock;                         /* Protects the cache state */
+  sem_t waitsem;                        /* Signaled when entries go idle */
+  unsigned int nwaiters;                /* Threads waiting on waitsem */
+  bool staging;                         /* Readahead buffer in use */
+  dq_queue_t lru;                       /* Entries in LRU order */
+  FAR uint8_t *pool;                    /* Sector data and readahead buffer */
+  FAR struct blockcache_entry_s *hash[BLOCKCACHE_NBUCKETS];
+  struct blockcache_entry_s entry[BLOCKCACHE_NBLOCKS];
+#ifdef CONFIG_MM_SHRINKER
+  struct mm_shrinker_s shrinker;        /* Releases the pool when clean */
+#endif
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct blockcache_s g_blockcache =
+{
+  NXMUTEX_INITIALIZER,
+  NXSEM_INITIALIZER(0, 0)
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: blockcache_shrink
+ *
+ * Description:
+ *   Memory shrinker.  Release the cache memory if no sector is dirty or
+ *   busy; it is allocated again on the next use.  Dirty sectors are not
+ *   written back here since the shrinker must not wait for the device.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MM_SHRINKER
+static size_t blockcache_shrink(FAR struct mm_shrinker_s *shrinker,
+                                FAR struct mm_heap_s *heap, size_t size)
+{
+  FAR struct blockcache_s *cache = &g_blockcache;
+  int i;
+
+  if (nxmutex_trylock(&cache->lock) < 0)
+    {
+      return 0;
+    }
+
+  if (cache->pool == NULL || cache->staging)
+    {
+      nxmutex_unlock(&cache->lock);
+      return 0;
+    }
+
+  for (i = 0; i < BLOCKCACHE_NBLOCKS; i++)
+    {
+      if (cache->entry[i].dirty || cache->entry[i].busy)
+        {
+          nxmutex_unlock(&cache->lock);
+          return 0;
+        }
+    }
+
+  for (i = 0; i < BLOCKCACHE_NBLOCKS; i++)
+    {
+      cache->entry[i].inode = NULL;
+      cache->entry[i].hnext = NULL;
+      cache->entry[i].data  = NULL;
+    }
+
+  memset(cache->hash, 0, sizeof(cache->hash));
+  dq_init(&cache->lru);
+
+  kmm_free(cache->pool);
+  cache->pool = NULL;
+
+  nxmutex_unlock(&cache->lock);
+  return BLOCKCACHE_POOLSIZE;
+}
+#endif
+
+/****************************************************************************
+ * Name: blockcache_initialize
+ *
+ * Description:
+ *   Allocate the cache memory on first use, or again after the shrinker
+ *   released it.  The readahead staging buffer follows the sector data of
+ *   the entries.
+ *
+ ****************************************************************************/
+
+static int blockcache_initialize(FAR struct blockcache_s *cache)
+{
+  int i;
+
+  if (cache->pool != NULL)
+    {
+      return OK;
+    }
+
+  cache->pool = kmm_malloc(BLOCKCACHE_POOLSIZE);
+  if (cache->pool == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  for (i = 0; i < BLOCKCACHE_NBLOCKS; i++)
+    {
+      cache->entry[i].data = cache->pool + i * BLOCKCACHE_BLOCKSIZE;
+      dq_addlast(&cache->entry[i].node, &cache->lru);
+    }
+
+#ifdef CONFIG_MM_SHRINKER
+  if (cache->shrinker.shrink == NULL)
+    {
+      cache->shrinker.shrink = blockcache_shrink;
+      mm_register_shrinker(&cache->shrinker);
+    }
+#endif
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: blockcache_wait
+ *
+ * Description:
+ *   Wait until a busy entry becomes idle.  Called with the cache locked;
+ *   the lock is released while waiting, so the caller must look up its
+ *   sectors again afterwards.
+ *
+ ****************************************************************************/
+
+static void blockcache_wait(FAR struct blockcache_s *cache)
+{
+  cache->nwaiters++;
+  nxmutex_unlock(&cache->lock);
+  nxsem_wait_uninterruptible(&cache->waitsem);
+  nxmutex_lock(&cache->lock);
+}
+
+/****************************************************************************
+ * Name: blockcache_wakeup
+ *
+ * Description:
+ *   Wake up all threads waiting for busy entries after some went idle.
+ *
+ ****************************************************************************/
+
+static void blockcache_wakeup(FAR struct blockcache_s *cache)
+{
+  while (cache->nwaiters > 0)
+    {
+      cache->nwaiters--;
+      nxsem_post(&cache->waitsem);
+    }
+}
+
+/****************************************************************************
+ * Name: blockcache_find
+ ****************************************************************************/
+
+static FAR struct blockcache_entry_s *
+blockcache_find(FAR struct blockcache_s *cache, FAR struct inode *inode,
+                blkcnt_t sector)
+{
+  FAR struct blockcache_entry_s *entry;
+
+  for (entry = cache->hash[BLOCKCACHE_HASH(inode, sector)];
+       entry != NULL; entry = entry->hnext)
+    {
+      if (entry->inode == inode && entry->sector == sector)
+        {
+          return entry;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: blockcache_touch
+ *
+ * Description:
+ *   Mark an entry as the most recently used one.
+ *
+ ****************************************************************************/
+
+static void blockcache_touch(FAR struct blockcache_s *cache,
+                             FAR struct blockcache_entry_s *entry)
+{
+  dq_rem(&entry->node, &cache->lru);
+  dq_addfirst(&entry->node, &cache->lru);
+}
+
+/****************************************************************************
+ * Name: blockcache_unhash
+ ****************************************************************************/
+
+static void blockcache_unhash(FAR struct blockcache_s *cache,
+                              FAR struct blockcache_entry_s *entry)
+{
+  FAR struct blockcache_entry_s **link;
+
+  link = &cache->hash[BLOCKCACHE_HASH(entry->inode, entry->sector)];
+  while (*link != entry)
+    {
+      DEBUGASSERT(*link != NULL);
+      link = &(*link)->hnext;
+    }
+
+  *link        = entry->hnext;
+  entry->inode = NULL;
+  entry->dirty = false;
+}
+
+/****************************************************************************
+ * Name: blockcache_drop
+ *
+ * Description:
+ *   Forget the sector cached in an idle entry and make it the first one to
+ *   be recycled.
+ *
+ ****************************************************************************/
+
+static void blockcache_drop(FAR struct blockcache_s *cache,
+                            FAR struct blockcache_entry_s *entry)
+{
+  DEBUGASSERT(!entry->busy);
+
+  blockcache_unhash(cache, entry);
+  dq_rem(&entry->node, &cache->lru);
+  dq_addlast(&entry->node, &cache->lru);
+}
+
+/****************************************************************************
+ * Name: blockcache_writeback
+ *
+ * Description:
+ *   Write an idle entry to the device if it is dirty.  The cache is
+ *   unlocked during the write and the entry is busy meanwhile.  If the
+ *   write fails, the entry stays dirty.
+ *
+ ****************************************************************************/
+
+static int blockcache_writeback(FAR struct blockcache_s *cache,
+                                FAR struct blockcache_entry_s *entry)
+{
+  FAR struct inode *inode = entry->inode;
+  ssize_t ret;
+
+  DEBUGASSERT(!entry->busy);
+
+  if (!entry->dirty)
+    {
+      return OK;
+    }
+
+  entry->busy  = true;
+  entry->dirty = false;
+  nxmutex_unlock(&cache->lock);
+
+  ret = inode->u.i_bops->write(inode, entry->data, entry->sector, 1);
+
+  nxmutex_lock(&cache->lock);
+  entry->busy = false;
+  blockcache_wakeup(cache);
+
+  if (ret < 0)
+    {
+      ferr("ERROR: Write back of sector %" PRIuOFF " failed: %zd\n",
+           (off_t)entry->sector, ret);
+      entry->dirty = true;
+      return (int)ret;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: blockcache_alloc
+ *
+ * Description:
+ *   Recycle the least recently used idle entry for (inode, sector).  The
+ *   new entry is the most recently used.
+ *
+ * Returned Value:
+ *   Zero (OK) with the entry in *entryp.  -EAGAIN if a dirty entry had to
+ *   be written back first; the cache was unlocked meanwhile, so the caller
+ *   must look the sector up again before retrying.  Any other negated
+ *   errno value if no entry is available; an entry whose write back failed
+ *   is moved to the head of the LRU list so that the next allocation tries
+ *   another one.
+ *
+ ****************************************************************************/
+
+static int blockcache_alloc(FAR struct blockcache_s *cache,
+                            FAR struct inode *inode, blkcnt_t sector,
+                            FAR struct blockcache_entry_s **entryp)
+{
+  FAR struct blockcache_entry_s *entry;
+  int hash;
+  int ret;
+
+  ret = blockcache_initialize(cache);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  for (entry = (FAR struct blockcache_entry_s *)dq_tail(&cache->lru);
+       entry != NULL && entry->busy;
+       entry = (FAR struct blockcache_entry_s *)dq_prev(&entry->node));
+
+  if (entry == NULL)
+    {
+      return -EBUSY;
+    }
+
+  if (entry->dirty)
+    {
+      ret = blockcache_writeback(cache, entry);
+      if (ret < 0)
+        {
+          blockcache_touch(cache, entry);
+          return ret;
+        }
+
+      return -EAGAIN;
+    }
+
+  if (entry->inode != NULL)
+    {
+      blockcache_unhash(cache, entry);
+    }
+
+  hash          = BLOCKCACHE_HASH(inode, sector);
+  entry->inode  = inode;
+  entry->sector = sector;
+  entry->dirty  = false;
+  entry->hnext  = cache->hash[hash];
+  cache->hash[hash] = entry;
+
+  blockcache_touch(cache, entry);
+  *entryp = entry;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: blockcache_fill
+ *
+ * Description:
+ *   Read the uncached sector 'sector' into the cache together with up to
+ *   CONFIG_FS_BLOCKCACHE_READAHEAD - 1 following sectors that are not
+ *   cached either, and copy the first one to the caller's buffer.  The
+ *   new entries are busy, and the cache unlocked, while they are read.
+ *
+ * Returned Value:
+ *   One on success, -EAGAIN if the caller must look the sector up again,
+ *   or a negated errno value on a read error.
+ *
+ ****************************************************************************/
+
+static ssize_t blockcache_fill(FAR struct blockcache_s *cache,
+                               FAR struct inode *inode,
+                               FAR unsigned char *buffer, blkcnt_t sector,
+                               size_t sectsize)
+{
+  FAR struct blockcache_entry_s *entry;
+  FAR uint8_t *staging;
+  unsigned int nread = 0;
+  ssize_t ret;
+  ssize_t i;
+
+  /* Claim busy entries for the run of uncached sectors */
+
+  while (nread < BLOCKCACHE_READAHEAD)
+    {
+      if (nread > 0 &&
+          blockcache_find(cache, inode, sector + nread) != NULL)
+        {
+          break;
+        }
+
+      ret = blockcache_alloc(cache, inode, sector + nread, &entry);
+      if (ret == -EAGAIN && nread > 0)
+        {
+          continue;
+        }
+      else if (ret < 0)
+        {
+          break;
+        }
+
+      entry->busy = true;
+      nread++;
+    }
+
+  if (nread == 0)
+    {
+      if (ret == -EAGAIN)
+        {
+          return ret;
+        }
+
+      /* No entry available, read the sector without caching it */
+
+      nxmutex_unlock(&cache->lock);
+      ret = inode->u.i_bops->read(inode, buffer, sector, 1);
+      nxmutex_lock(&cache->lock);
+      return ret;
+    }
+
+  /* The busy entries keep the pool from being released.  The readahead
+   * may run past the end of the device; fall back to reading the requested
+   * sector alone if the longer read fails.  Another thread may be using
+   * the staging buffer, then only the requested sector is read.
+   */
+
+  entry = blockcache_find(cache, inode, sector);
+  if (nread > 1 && !cache->staging)
+    {
+      staging = cache->pool + BLOCKCACHE_NBLOCKS * BLOCKCACHE_BLOCKSIZE;
+      cache->staging = true;
+      nxmutex_unlock(&cache->lock);
+
+      ret = inode->u.i_bops->read(inode, staging, sector, nread);
+      if (ret <= 0)
+        {
+          ret = inode->u.i_bops->read(inode, staging, sector, 1);
+        }
+
+      nxmutex_lock(&cache->lock);
+      for (i = 0; i < ret; i++)
+        {
+          memcpy(blockcache_find(cache, inode, sector + i)->data,
+                 staging + i * sectsize, sectsize);
+        }
+
+      cache->staging = false;
+    }
+  else
+    {
+      nxmutex_unlock(&cache->lock);
+      ret = inode->u.i_bops->read(inode, entry->data, sector, 1);
+      nxmutex_lock(&cache->lock);
+    }
+
+  if (ret > 0)
+    {
+      memcpy(buffer, entry->data, sectsize);
+    }
+
+  /* Release the entries, and drop those that were not read */
+
+  for (i = 0; i < nread; i++)
+    {
+      entry = blockcache_find(cache, inode, sector + i);
+      entry->busy = false;
+      if (i >= ret)
+        {
+          blockcache_drop(cache, entry);
+        }
+    }
+
+  blockcache_wakeup(cache);
+
+  if (ret <= 0)
+    {
+      return ret < 0 ? ret : -EIO;
+    }
+
+  return 1;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: blockcache_read
+ *
+ * Description:
+ *   Read sectors from a block driver through the shared block cache.  The
+ *   arguments and return value are those of the block driver read()
+ *   method, plus the sector size of the device.
+ *
+ *   Cached sectors are copied from the cache.  A single uncached sector is
+ *   read into the cache along with a few following sectors (readahead).
+ *   Longer runs of uncached sectors are read directly into the caller's
+ *   buffer so that large sequential transfers do not flush the cache.
+ *   The cache is not locked while the device is accessed.
+ *
+ ****************************************************************************/
+
+ssize_t blockcache_read(FAR struct inode *inode, FAR unsigned char *buffer,
+                        blkcnt_t start_sector, unsigned int nsectors,
+                        size_t sectsize)
+{
+  FAR struct blockcache_s *cache = &g_blockcache;
+  FAR struct blockcache_entry_s *entry;
+  unsigned int remaining = nsectors;
+  unsigned int nrun;
+  ssize_t ret = 0;
+
+  DEBUGASSERT(inode != NULL && inode->u.i_bops != NULL &&
+              inode->u.i_bops->read != NULL);
+
+  if (sectsize > BLOCKCACHE_BLOCKSIZE ||
+      nxmutex_lock(&cache->lock) < 0)
+    {
+      return inode->u.i_bops->read(inode, buffer, start_sector, nsectors);
+    }
+
+  while (remaining > 0)
+    {
+      entry = blockcache_find(cache, inode, start_sector);
+      if (entry != NULL && entry->busy)
+        {
+          blockcache_wait(cache);
+          continue;
+        }
+      else if (entry != NULL)
+        {
+          memcpy(buffer, entry->data, sectsize);
+          blockcache_touch(cache, entry);
+          ret = 1;
+        }
+      else
+        {
+          for (nrun = 1; nrun < remaining &&
+               blockcache_find(cache, inode, start_sector + nrun) == NULL;
+               nrun++);
+
+          if (nrun == 1)
+            {
+              ret = blockcache_fill(cache, inode, buffer, start_sector,
+                                    sectsize);
+              if (ret == -EAGAIN)
+                {
+                  continue;
+                }
+            }
+          else
+            {
+              nxmutex_unlock(&cache->lock);
+              ret = inode->u.i_bops->read(inode, buffer, start_sector,
+                                          nrun);
+              nxmutex_lock(&cache->lock);
+            }
+
+          if (ret <= 0)
+            {
+              break;
+            }
+        }
+
+      buffer       += ret * sectsize;
+      start_sector += ret;
+      remaining    -= ret;
+    }
+
+  nxmutex_unlock(&cache->lock);
+
+  /* Report a partial transfer as such, and an error only if nothing was
+   * read at all.
+   */
+
+  return remaining < nsectors ? (ssize_t)(nsectors - remaining) : ret;
+}
+
+/****************************************************************************
+ * Name: blockcache_write
+ *
+ * Description:
+ *   Write sectors to a block driver through the shared block cache.  The
+ *   arguments and return value are those of the block driver write()
+ *   method, plus the sector size of the device.
+ *
+ *   With CONFIG_FS_BLOCKCACHE_WRITEBACK a single sector write only updates
+ *   the cache; the sector is written to the device when it is evicted or
+ *   when blockcache_flush() is called.  Multi-sector writes always go to
+ *   the device, with the cache unlocked, and refresh the cached copies of
+ *   the sectors written.  Dirty sectors that the write did not reach are
+ *   kept.
+ *
+ ****************************************************************************/
+
+ssize_t blockcache_write(FAR struct inode *inode,
+                         FAR const unsigned char *buffer,
+                         blkcnt_t start_sector, unsigned int nsectors,
+                         size_t sectsize)
+{
+  FAR struct blockcache_s *cache = &g_blockcache;
+  FAR struct blockcache_entry_s *entry;
+  ssize_t ret;
+  ssize_t i;
+
+  DEBUGASSERT(inode != NULL && inode->u.i_bops != NULL &&
+              inode->u.i_bops->write != NULL);
+
+  if (sectsize > BLOCKCACHE_BLOCKSIZE ||
+      nxmutex_lock(&cache->lock) < 0)
+    {
+      return inode->u.i_bops->write(inode, buffer, start_sector, nsectors);
+    }
+
+#ifdef CONFIG_FS_BLOCKCACHE_WRITEBACK
+  while (nsectors == 1)
+    {
+      entry = blockcache_find(cache, inode, start_sector);
+      if (entry != NULL && entry->busy)
+        {
+          blockcache_wait(cache);
+          continue;
+        }
+      else if (entry != NULL)
+        {
+          blockcache_touch(cache, entry);
+        }
+      else
+        {
+          ret = blockcache_alloc(cache, inode, start_sector, &entry);
+          if (ret == -EAGAIN)
+            {
+              continue;
+            }
+          else if (ret < 0)
+            {
+              break;
+            }
+        }
+
+      memcpy(entry->data, buffer, sectsize);
+      entry->dirty = true;
+      nxmutex_unlock(&cache->lock);
+      return 1;
+    }
+#endif
+
+  /* Drop the clean cached copies, which the write supersedes.  Dirty ones
+   * are kept until the write is known to have covered them, otherwise
+   * their data would be lost if the write fails or comes up short.
+   */
+
+  for (i = 0; i < nsectors; )
+    {
+      entry = blockcache_find(cache, inode, start_sector + i);
+      if (entry != NULL && entry->busy)
+        {
+          blockcache_wait(cache);
+          continue;
+        }
+      else if (entry != NULL && !entry->dirty)
+        {
+          blockcache_drop(cache, entry);
+        }
+
+      i++;
+    }
+
+  nxmutex_unlock(&cache->lock);
+  ret = inode->u.i_bops->write(inode, buffer, start_sector, nsectors);
+  nxmutex_lock(&cache->lock);
+
+  /* Only the sectors actually written are refreshed; the dirty entries of
+   * the rest keep their data.  Entries kept or cached meanwhile may hold
+   * older data or be written back after this write, so give them the new
+   * data and write them again.
+   */
+
+  for (i = 0; i < ret; )
+    {
+      entry = blockcache_find(cache, inode, start_sector + i);
+      if (entry != NULL && entry->busy)
+        {
+          blockcache_wait(cache);
+          continue;
+        }
+      else if (entry != NULL)
+        {
+          memcpy(entry->data, buffer + i * sectsize, sectsize);
+          entry->dirty = true;
+        }
+
+      i++;
+    }
+
+  nxmutex_unlock(&cache->lock);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: blockcache_flush
+ *
+ * Description:
+ *   Write all dirty cached sectors of a block driver to the device, or of
+ *   all block drivers if inode is NULL.  Sectors that are being written
+ *   back by another thread are waited for.
+ *
+ * Returned Value:
+ *   Zero on success or the first negated errno value encountered.
+ *
+ ****************************************************************************/
+
+int blockcache_flush(FAR struct inode *inode)
+{
+  FAR struct blockcache_s *cache = &g_blockcache;
+  int ret;
+  int i;
+
+  ret = nxmutex_lock(&cache->lock);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  for (i = 0; i < BLOCKCACHE_NBLOCKS; )
+    {
+      FAR struct blockcache_entry_s *entry = &cache->entry[i];
+      int ret2;
+
+      if (entry->inode != NULL &&
+          (inode == NULL || entry->inode == inode))
+        {
+          if (entry->busy)
+            {
+              blockcache_wait(cache);
+              continue;
+            }
+
+          ret2 = blockcache_writeback(cache, entry);
+          if (ret2 < 0 && ret >= 0)
+            {
+              ret = ret2;
+            }
+        }
+
+      i++;
+    }
+
+  nxmutex_unlock(&cache->lock);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: blockcache_invalidate
+ *
+ * Description:
+ *   Flush and then drop all cached sectors of a block driver.  This must
+ *   be called when a user of the cache closes the block driver, since the
+ *   inode may later be freed and its address reused.
+ *
+ * Returned Value:
+ *   Zero on success or a negated errno value if the flush failed.  The
+ *   sectors are dropped either way.
+ *
+ ****************************************************************************/
+
+int blockcache_invalidate(FAR struct inode *inode)
+{
+  FAR struct blockcache_s *cache = &g_blockcache;
+  int ret;
+  int i;
+
+  DEBUGASSERT(inode != NULL);
+
+  ret = blockcache_flush(inode);
+
+  nxmutex_lock(&cache->lock);
+
+  for (i = 0; i < BLOCKCACHE_NBLOCKS; )
+    {
+      FAR struct blockcache_entry_s *entry = &cache->entry[i];
+
+      if (entry->inode == inode && entry->busy)
+        {
+          blockcache_wait(cache);
+          continue;
+        }
+      else if (entry->inode == inode)
+        {
+          blockcache_drop(cache, entry);
+        }
+
+      i++;
+    }
+
+  nxmutex_unlock(&cache->lock);
+  return ret;
+}
+
+#endif /* CONFIG_FS_BLOCKCACHE */
@@ -472,6 +472,14 @@ static int fat_close(FAR struct file *filep)
       fat_io_free(ff->ff_buffer, fs->fs_hwsectorsize);
     }
 
+#if CONFIG_FAT_READAHEAD > 0
+  if (ff->ff_rabuffer)
+    {
+      fat_io_free(ff->ff_rabuffer,
+                  CONFIG_FAT_READAHEAD * fs->fs_hwsectorsize);
+    }
+#endif
+
   /* Then free the file structure itself. */
 
   fs_heap_free(ff);
@@ -1492,6 +1500,15 @@ static int fat_sync(FAR struct file *filep)
       ret          = fat_updatefsinfo(fs);
     }
 
+#ifdef CONFIG_FS_BLOCKCACHE
+  /* Write back the sectors held in the shared block cache */
+
+  if (ret >= 0)
+    {
+      ret = blockcache_flush(fs->fs_blkdriver);
+    }
+#endif
+
 errout_with_lock:
   nxmutex_unlock(&fs->fs_lock);
   return ret;
@@ -1599,6 +1616,10 @@ static int fat_dup(FAR const struct file *oldp, FAR struct file *newp)
   newff->ff_startcluster     = oldff->ff_startcluster;     /* Start cluster of file on media */
   newff->ff_currentsector    = oldff->ff_currentsector;    /* Current sector */
   newff->ff_cachesector      = 0;                          /* Sector in file buffer */
+#if CONFIG_FAT_READAHEAD > 0
+  newff->ff_rabuffer         = NULL;                       /* Readahead buffer */
+  newff->ff_racount          = 0;                          /* Sectors in readahead buffer */
+#endif
 
   /* Attach the private date to the struct file instance */
 
@@ -2256,6 +2277,9 @@ static int fat_bind(FAR struct inode *blkdriver, FAR const void *data,
   ret = fat_mount(fs, true);
   if (ret != 0)
     {
+#ifdef CONFIG_FS_BLOCKCACHE
+      blockcache_invalidate(blkdriver);
+#endif
       nxmutex_destroy(&fs->fs_lock);
       fs_heap_free(fs);
       return ret;
@@ -2333,6 +2357,10 @@ static int fat_unbind(FAR void *handle, FAR struct inode **blkdriver,
       FAR struct inode *inode = fs->fs_blkdriver;
       if (inode)
         {
+#ifdef CONFIG_FS_BLOCKCACHE
+          blockcache_invalidate(inode);
+#endif
+
           if (inode->u.i_bops && inode->u.i_bops->close)
             {
               inode->u.i_bops->close(inode);
@@ -2358,6 +2386,14 @@ static int fat_unbind(FAR void *handle, FAR struct inode **blkdriver,
       fat_io_free(fs->fs_buffer, fs->fs_hwsectorsize);
     }
 
+#if CONFIG_FAT_ENTRYCACHE_SIZE > 0
+  fs_heap_free(fs->fs_entrycache);
+#endif
+
+#ifdef CONFIG_FAT_FREEMAP
+  fs_heap_free(fs->fs_freemap);
+#endif
+
   nxmutex_destroy(&fs->fs_lock);
   fs_heap_free(fs);
   return OK;
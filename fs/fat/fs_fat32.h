@@ -43,6 +43,20 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* Configuration */
+
+#ifndef CONFIG_FAT_ENTRYCACHE_SIZE
+#  define CONFIG_FAT_ENTRYCACHE_SIZE 0
+#endif
+
+#if (CONFIG_FAT_ENTRYCACHE_SIZE & (CONFIG_FAT_ENTRYCACHE_SIZE - 1)) != 0
+#  error CONFIG_FAT_ENTRYCACHE_SIZE must be a power of two
+#endif
+
+#ifndef CONFIG_FAT_READAHEAD
+#  define CONFIG_FAT_READAHEAD 0
+#endif
+
 /****************************************************************************
  * These offsets describes the master boot record (MBR).
  *
@@ -857,6 +871,16 @@
  * Public Types
  ****************************************************************************/
 
+/* One entry of the FAT entry cache */
+
+#if CONFIG_FAT_ENTRYCACHE_SIZE > 0
+struct fat_entrycache_s
+{
+  uint32_t fe_cluster;             /* Cluster number (0 if unused) */
+  uint32_t fe_next;                /* The FAT entry of that cluster */
+};
+#endif
+
 /* This structure represents the overall mountpoint state.  An instance of
  * this structure is retained as inode private data on each mountpoint that
  * is mounted with a fat32 filesystem.
@@ -891,6 +915,12 @@ struct fat_mountpt_s
   uint8_t  fs_fatsecperclus;       /* MBR: Sectors per allocation unit: 2**n, n=0..7 */
   uint8_t *fs_buffer;              /* This is an allocated buffer to hold one
                                     * sector from the device */
+#if CONFIG_FAT_ENTRYCACHE_SIZE > 0
+  struct fat_entrycache_s *fs_entrycache; /* Direct mapped FAT entry cache */
+#endif
+#ifdef CONFIG_FAT_FREEMAP
+  uint32_t *fs_freemap;            /* One bit per cluster, set if in use */
+#endif
 };
 
 /* This structure represents on open file under the mountpoint.  An instance
@@ -913,6 +943,11 @@ struct fat_file_s
   off_t    ff_cachesector;         /* Current sector in the file buffer */
   off_t    ff_pos;                 /* Current position in the file */
   uint8_t *ff_buffer;              /* File buffer (for partial sector accesses) */
+#if CONFIG_FAT_READAHEAD > 0
+  off_t    ff_rasector;            /* First sector in the readahead buffer */
+  uint8_t  ff_racount;             /* Sectors in the readahead buffer */
+  uint8_t *ff_rabuffer;            /* Readahead buffer (lazily allocated) */
+#endif
 };
 
 /* This structure holds the sequence of directory entries used by one
@@ -44,6 +44,29 @@
 #include "inode/inode.h"
 #include "fs_fat32.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifdef CONFIG_FAT_FREEMAP
+#  define FAT_FREEMAP_NWORDS(fs) (((fs)->fs_nclusters + 2 + 31) / 32)
+#  define FAT_FREEMAP_INUSE(fs, c) \
+     (((fs)->fs_freemap[(c) >> 5] & (UINT32_C(1) << ((c) & 31))) != 0)
+#endif
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static off_t fat_readfatentry(struct fat_mountpt_s *fs, uint32_t clusterno);
+#ifdef CONFIG_FAT_FREEMAP
+static int fat_buildfreemap(struct fat_mountpt_s *fs);
+#endif
+#if CONFIG_FAT_READAHEAD > 0
+static int fat_ffreadahead(struct fat_mountpt_s *fs, struct fat_file_s *ff,
+                           off_t sector);
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -270,6 +293,142 @@ static int fat_checkbootrecord(struct fat_mountpt_s *fs)
   return OK;
 }
 
+#ifdef CONFIG_FAT_FREEMAP
+/****************************************************************************
+ * Name: fat_buildfreemap
+ *
+ * Description:
+ *   Build the in-memory bitmap of allocated clusters by scanning the FAT
+ *   once, or recount the free clusters if the map already exists.  Either
+ *   way, the free cluster count in the FSINFO data is refreshed.
+ *
+ ****************************************************************************/
+
+static int fat_buildfreemap(struct fat_mountpt_s *fs)
+{
+  uint32_t nfreeclusters = 0;
+  uint32_t cluster;
+  off_t next;
+
+  if (fs->fs_freemap != NULL)
+    {
+      for (cluster = 2; cluster < fs->fs_nclusters + 2; cluster++)
+        {
+          if (!FAT_FREEMAP_INUSE(fs, cluster))
+            {
+              nfreeclusters++;
+            }
+        }
+    }
+  else
+    {
+      fs->fs_freemap = fs_heap_zalloc(FAT_FREEMAP_NWORDS(fs) *
+                                      sizeof(uint32_t));
+      if (fs->fs_freemap == NULL)
+        {
+          return -ENOMEM;
+        }
+
+      for (cluster = 2; cluster < fs->fs_nclusters + 2; cluster++)
+        {
+          next = fat_readfatentry(fs, cluster);
+          if (next < 0)
+            {
+              fs_heap_free(fs->fs_freemap);
+              fs->fs_freemap = NULL;
+              return (int)next;
+            }
+          else if (next == 0)
+            {
+              nfreeclusters++;
+            }
+          else
+            {
+              fs->fs_freemap[cluster >> 5] |= UINT32_C(1) << (cluster & 31);
+            }
+        }
+    }
+
+  fs->fs_fsifreecount = nfreeclusters;
+  if (fs->fs_type == FSTYPE_FAT32)
+    {
+      fs->fs_fsidirty = true;
+    }
+
+  return OK;
+}
+#endif
+
+#if CONFIG_FAT_READAHEAD > 0
+/****************************************************************************
+ * Name: fat_ffreadahead
+ *
+ * Description:
+ *   Read one sector into the file's sector buffer.  When the file is being
+ *   read sequentially, the following sectors of the current cluster are
+ *   read with the same request and kept for the next calls.
+ *
+ ****************************************************************************/
+
+static int fat_ffreadahead(struct fat_mountpt_s *fs, struct fat_file_s *ff,
+                           off_t sector)
+{
+  unsigned int nsectors;
+  int ret;
+
+  /* Is the sector already in the readahead window? */
+
+  if (ff->ff_racount > 0 && sector >= ff->ff_rasector &&
+      sector < ff->ff_rasector + ff->ff_racount)
+    {
+      memcpy(ff->ff_buffer,
+             &ff->ff_rabuffer[(sector - ff->ff_rasector) *
+                              fs->fs_hwsectorsize],
+             fs->fs_hwsectorsize);
+      return OK;
+    }
+
+  ff->ff_racount = 0;
+
+  /* Only read ahead if this read continues the previous one.  The sectors
+   * remaining in the current cluster are contiguous on the media.
+   */
+
+  nsectors = CONFIG_FAT_READAHEAD;
+  if (nsectors > ff->ff_sectorsincluster)
+    {
+      nsectors = ff->ff_sectorsincluster;
+    }
+
+  if (nsectors < 2 || (ff->ff_bflags & FFBUFF_VALID) == 0 ||
+      sector != ff->ff_cachesector + 1 || sector != ff->ff_currentsector)
+    {
+      return fat_hwread(fs, ff->ff_buffer, sector, 1);
+    }
+
+  if (ff->ff_rabuffer == NULL)
+    {
+      ff->ff_rabuffer = fat_io_alloc(CONFIG_FAT_READAHEAD *
+                                     fs->fs_hwsectorsize);
+      if (ff->ff_rabuffer == NULL)
+        {
+          return fat_hwread(fs, ff->ff_buffer, sector, 1);
+        }
+    }
+
+  ret = fat_hwread(fs, ff->ff_rabuffer, sector, nsectors);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ff->ff_rasector = sector;
+  ff->ff_racount  = nsectors;
+  memcpy(ff->ff_buffer, ff->ff_rabuffer, fs->fs_hwsectorsize);
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -520,6 +679,15 @@ int fat_mount(struct fat_mountpt_s *fs, bool writeable)
       goto errout;
     }
 
+#if CONFIG_FAT_ENTRYCACHE_SIZE > 0
+  /* The FAT entry cache is optional; run without it if it can't be
+   * allocated.
+   */
+
+  fs->fs_entrycache = fs_heap_zalloc(CONFIG_FAT_ENTRYCACHE_SIZE *
+                                     sizeof(struct fat_entrycache_s));
+#endif
+
   /* Search FAT boot record on the drive.  First check the MBR at sector
    * zero.  This could be either the boot record or a partition that refers
    * to the boot record.
@@ -661,6 +829,16 @@ errout_with_buffer:
   fat_io_free(fs->fs_buffer, fs->fs_hwsectorsize);
   fs->fs_buffer = NULL;
 
+#if CONFIG_FAT_ENTRYCACHE_SIZE > 0
+  fs_heap_free(fs->fs_entrycache);
+  fs->fs_entrycache = NULL;
+#endif
+
+#ifdef CONFIG_FAT_FREEMAP
+  fs_heap_free(fs->fs_freemap);
+  fs->fs_freemap = NULL;
+#endif
+
 errout:
   fs->fs_mounted = false;
   return ret;
@@ -728,8 +906,14 @@ int fat_hwread(struct fat_mountpt_s *fs, uint8_t *buffer,  off_t sector,
       struct inode *inode = fs->fs_blkdriver;
       if (inode && inode->u.i_bops && inode->u.i_bops->read)
         {
+#ifdef CONFIG_FS_BLOCKCACHE
+          ssize_t nsectorsread = blockcache_read(inode, buffer, sector,
+                                                 nsectors,
+                                                 fs->fs_hwsectorsize);
+#else
           ssize_t nsectorsread = inode->u.i_bops->read(inode, buffer,
                                                        sector, nsectors);
+#endif
           if (nsectorsread == nsectors)
             {
               ret = OK;
@@ -761,8 +945,14 @@ int fat_hwwrite(struct fat_mountpt_s *fs, uint8_t *buffer, off_t sector,
       struct inode *inode = fs->fs_blkdriver;
       if (inode && inode->u.i_bops && inode->u.i_bops->write)
         {
+#ifdef CONFIG_FS_BLOCKCACHE
+          ssize_t nsectorswritten =
+              blockcache_write(inode, buffer, sector, nsectors,
+                               fs->fs_hwsectorsize);
+#else
           ssize_t nsectorswritten =
               inode->u.i_bops->write(inode, buffer, sector, nsectors);
+#endif
 
           if (nsectorswritten == nsectors)
             {
@@ -798,17 +988,17 @@ off_t fat_cluster2sector(FAR struct fat_mountpt_s *fs,  uint32_t cluster)
 }
 
 /****************************************************************************
- * Name: fat_getcluster
+ * Name: fat_readfatentry
  *
  * Description:
- *   Get the next cluster start from the FAT.
+ *   Read the FAT entry of a cluster from the FAT itself.
  *
  * Returned Value:
  *   <0: error, 0:cluster unassigned, >=0: start sector of cluster
  *
  ****************************************************************************/
 
-off_t fat_getcluster(struct fat_mountpt_s *fs, uint32_t clusterno)
+static off_t fat_readfatentry(struct fat_mountpt_s *fs, uint32_t clusterno)
 {
   /* Verify that the cluster number is within range */
 
@@ -941,6 +1131,46 @@ off_t fat_getcluster(struct fat_mountpt_s *fs, uint32_t clusterno)
   return (off_t)-EINVAL;
 }
 
+/****************************************************************************
+ * Name: fat_getcluster
+ *
+ * Description:
+ *   Get the next cluster start from the FAT.
+ *
+ * Returned Value:
+ *   <0: error, 0:cluster unassigned, >=0: start sector of cluster
+ *
+ ****************************************************************************/
+
+off_t fat_getcluster(struct fat_mountpt_s *fs, uint32_t clusterno)
+{
+#if CONFIG_FAT_ENTRYCACHE_SIZE > 0
+  struct fat_entrycache_s *entry = NULL;
+  off_t next;
+
+  if (fs->fs_entrycache != NULL && clusterno >= 2)
+    {
+      entry = &fs->fs_entrycache[clusterno &
+                                 (CONFIG_FAT_ENTRYCACHE_SIZE - 1)];
+      if (entry->fe_cluster == clusterno)
+        {
+          return entry->fe_next;
+        }
+    }
+
+  next = fat_readfatentry(fs, clusterno);
+  if (entry != NULL && next >= 0)
+    {
+      entry->fe_cluster = clusterno;
+      entry->fe_next    = next;
+    }
+
+  return next;
+#else
+  return fat_readfatentry(fs, clusterno);
+#endif
+}
+
 /****************************************************************************
  * Name: fat_putcluster
  *
@@ -958,6 +1188,21 @@ int fat_putcluster(struct fat_mountpt_s *fs, uint32_t clusterno,
 
   if (clusterno == 0 || (clusterno >= 2 && clusterno < fs->fs_nclusters + 2))
     {
+#if CONFIG_FAT_ENTRYCACHE_SIZE > 0
+      /* Drop any cached copy of the entry being changed */
+
+      if (fs->fs_entrycache != NULL && clusterno >= 2)
+        {
+          struct fat_entrycache_s *entry =
+            &fs->fs_entrycache[clusterno & (CONFIG_FAT_ENTRYCACHE_SIZE - 1)];
+
+          if (entry->fe_cluster == clusterno)
+            {
+              entry->fe_cluster = 0;
+            }
+        }
+#endif
+
       /* Okay.. Write the next cluster into the FAT.  The way we will do
        * this depends on the type of FAT filesystem we are dealing with.
        */
@@ -1100,6 +1345,24 @@ int fat_putcluster(struct fat_mountpt_s *fs, uint32_t clusterno,
             return -EINVAL;
         }
 
+#ifdef CONFIG_FAT_FREEMAP
+      /* Keep the free cluster map in sync */
+
+      if (fs->fs_freemap != NULL && clusterno >= 2)
+        {
+          if (nextcluster != 0)
+            {
+              fs->fs_freemap[clusterno >> 5] |=
+                UINT32_C(1) << (clusterno & 31);
+            }
+          else
+            {
+              fs->fs_freemap[clusterno >> 5] &=
+                ~(UINT32_C(1) << (clusterno & 31));
+            }
+        }
+#endif
+
       /* Mark the modified sector as "dirty" and return success */
 
       fs->fs_dirty = true;
@@ -1226,6 +1489,17 @@ int32_t fat_extendchain(struct fat_mountpt_s *fs, uint32_t cluster)
       startcluster = cluster;
     }
 
+#ifdef CONFIG_FAT_FREEMAP
+  /* Build the free cluster map on the first allocation.  If that fails,
+   * the FAT is searched directly as before.
+   */
+
+  if (fs->fs_freemap == NULL)
+    {
+      fat_buildfreemap(fs);
+    }
+#endif
+
   /* Loop until (1) we discover that there are not free clusters
    * (return 0), an errors occurs (return -errno), or (3) we find
    * the next cluster (return the new cluster number).
@@ -1260,7 +1534,19 @@ int32_t fat_extendchain(struct fat_mountpt_s *fs, uint32_t cluster)
        * mapped to a group of sectors.
        */
 
-      startsector = fat_getcluster(fs, newcluster);
+#ifdef CONFIG_FAT_FREEMAP
+      if (fs->fs_freemap != NULL && FAT_FREEMAP_INUSE(fs, newcluster))
+        {
+          /* Known to be in use without reading the FAT */
+
+          startsector = 1;
+        }
+      else
+#endif
+        {
+          startsector = fat_getcluster(fs, newcluster);
+        }
+
       if (startsector == 0)
         {
           /* Found have found a free cluster break out */
@@ -1886,6 +2172,18 @@ int fat_ffcacheflush(struct fat_mountpt_s *fs, struct fat_file_s *ff)
           return ret;
         }
 
+#if CONFIG_FAT_READAHEAD > 0
+      /* Keep the readahead copy of the sector (if any) up to date */
+
+      if (ff->ff_racount > 0 && ff->ff_cachesector >= ff->ff_rasector &&
+          ff->ff_cachesector < ff->ff_rasector + ff->ff_racount)
+        {
+          memcpy(&ff->ff_rabuffer[(ff->ff_cachesector - ff->ff_rasector) *
+                                  fs->fs_hwsectorsize],
+                 ff->ff_buffer, fs->fs_hwsectorsize);
+        }
+#endif
+
       /* No longer dirty, but still valid */
 
       ff->ff_bflags &= ~FFBUFF_DIRTY;
@@ -1927,7 +2225,11 @@ int fat_ffcacheread(struct fat_mountpt_s *fs, struct fat_file_s *ff,
 
       /* Then read the specified sector into the cache */
 
+#if CONFIG_FAT_READAHEAD > 0
+      ret = fat_ffreadahead(fs, ff, sector);
+#else
       ret = fat_hwread(fs, ff->ff_buffer, sector, 1);
+#endif
       if (ret < 0)
         {
           return ret;
@@ -1972,6 +2274,12 @@ int fat_ffcacheinvalidate(struct fat_mountpt_s *fs, struct fat_file_s *ff)
       ff->ff_cachesector = 0;
     }
 
+#if CONFIG_FAT_READAHEAD > 0
+  /* The caller may be about to access the device directly */
+
+  ff->ff_racount = 0;
+#endif
+
   return OK;
 }
 
@@ -2035,9 +2343,19 @@ int fat_updatefsinfo(struct fat_mountpt_s *fs)
 
 int fat_computefreeclusters(struct fat_mountpt_s *fs)
 {
+  uint32_t nfreeclusters = 0;
+
+#ifdef CONFIG_FAT_FREEMAP
+  /* Building the free cluster map counts the free clusters too */
+
+  if (fat_buildfreemap(fs) >= 0)
+    {
+      return OK;
+    }
+#endif
+
   /* We have to count the number of free clusters */
 
-  uint32_t nfreeclusters = 0;
   if (fs->fs_type == FSTYPE_FAT12)
     {
       off_t sector;
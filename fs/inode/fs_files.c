@@ -1103,4 +1103,10 @@ int close(int fd)
 void sync(void)
 {
   nxsched_foreach(task_fssync, NULL);
+
+#ifdef CONFIG_FS_BLOCKCACHE
+  /* Write back the sectors still held in the shared block cache */
+
+  blockcache_flush(NULL);
+#endif
 }
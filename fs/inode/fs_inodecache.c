@@ -0,0 +1,216 @@
+/****************************************************************************
+ * fs/inode/fs_inodecache.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <nuttx/spinlock.h>
+
+#include "inode/inode.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define INODE_CACHE_MASK (CONFIG_FS_INODE_CACHE_SIZE - 1)
+
+#if (CONFIG_FS_INODE_CACHE_SIZE & INODE_CACHE_MASK) != 0
+#  error CONFIG_FS_INODE_CACHE_SIZE must be a power of two
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One cached path segment: the result of looking up 'name' among the
+ * children of 'parent'.  A NULL 'node' records that no such child exists.
+ * The entry is only valid while 'gen' matches g_inode_cache_gen.
+ */
+
+struct inode_cache_s
+{
+  FAR struct inode *parent;
+  FAR struct inode *node;
+  FAR struct inode *left;
+  uint32_t gen;
+  uint8_t namelen;
+  char name[CONFIG_FS_INODE_CACHE_NAMELEN];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct inode_cache_s g_inode_cache[CONFIG_FS_INODE_CACHE_SIZE];
+static spinlock_t g_inode_cache_lock = SP_UNLOCKED;
+
+/* Bumped by every change to the inode tree.  Starts at 1 so that the
+ * zeroed entries never match.
+ */
+
+static uint32_t g_inode_cache_gen = 1;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: inode_cache_hash
+ *
+ * Description:
+ *   Hash the first segment of 'name' together with its parent node and
+ *   return the segment length.
+ *
+ ****************************************************************************/
+
+static size_t inode_cache_hash(FAR struct inode *parent,
+                               FAR const char *name, FAR uint32_t *hash)
+{
+  uint32_t h = 2166136261u ^ (uint32_t)((uintptr_t)parent >> 4);
+  size_t len;
+
+  /* FNV-1a over the segment */
+
+  for (len = 0; name[len] != '\0' && name[len] != '/'; len++)
+    {
+      h = (h ^ (uint8_t)name[len]) * 16777619u;
+    }
+
+  *hash = h ^ (h >> 16);
+  return len;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: inode_cache_lookup
+ *
+ * Description:
+ *   Look up the first segment of 'name' among the children of 'parent' in
+ *   the path component cache.  On a hit, return true with the matching
+ *   node (NULL if the name is known to be absent) in 'node' and the node
+ *   to its "left" in 'left'.
+ *
+ * Assumptions:
+ *   The caller holds the g_inode_sem semaphore, for reading at least.
+ *
+ ****************************************************************************/
+
+bool inode_cache_lookup(FAR struct inode *parent, FAR const char *name,
+                        FAR struct inode **node, FAR struct inode **left)
+{
+  FAR struct inode_cache_s *entry;
+  irqstate_t flags;
+  uint32_t hash;
+  size_t len;
+  bool hit;
+
+  len = inode_cache_hash(parent, name, &hash);
+  if (len > CONFIG_FS_INODE_CACHE_NAMELEN)
+    {
+      return false;
+    }
+
+  entry = &g_inode_cache[hash & INODE_CACHE_MASK];
+
+  flags = spin_lock_irqsave(&g_inode_cache_lock);
+  hit = entry->gen == g_inode_cache_gen && entry->parent == parent &&
+        entry->namelen == len && memcmp(entry->name, name, len) == 0;
+  if (hit)
+    {
+      *node = entry->node;
+      *left = entry->left;
+    }
+
+  spin_unlock_irqrestore(&g_inode_cache_lock, flags);
+  return hit;
+}
+
+/****************************************************************************
+ * Name: inode_cache_add
+ *
+ * Description:
+ *   Remember the result of a look up of the first segment of 'name' among
+ *   the children of 'parent'.  'node' is NULL for a negative entry.
+ *
+ ****************************************************************************/
+
+void inode_cache_add(FAR struct inode *parent, FAR const char *name,
+                     FAR struct inode *node, FAR struct inode *left)
+{
+  FAR struct inode_cache_s *entry;
+  irqstate_t flags;
+  uint32_t hash;
+  size_t len;
+
+  len = inode_cache_hash(parent, name, &hash);
+  if (len > CONFIG_FS_INODE_CACHE_NAMELEN)
+    {
+      return;
+    }
+
+  entry = &g_inode_cache[hash & INODE_CACHE_MASK];
+
+  flags = spin_lock_irqsave(&g_inode_cache_lock);
+  entry->parent  = parent;
+  entry->node    = node;
+  entry->left    = left;
+  entry->gen     = g_inode_cache_gen;
+  entry->namelen = len;
+  memcpy(entry->name, name, len);
+  spin_unlock_irqrestore(&g_inode_cache_lock, flags);
+}
+
+/****************************************************************************
+ * Name: inode_cache_invalidate
+ *
+ * Description:
+ *   Drop all cached look ups.  Must be called whenever the shape of the
+ *   inode tree changes.
+ *
+ * Assumptions:
+ *   The caller holds the g_inode_sem semaphore for writing.
+ *
+ ****************************************************************************/
+
+void inode_cache_invalidate(void)
+{
+  irqstate_t flags;
+
+  flags = spin_lock_irqsave(&g_inode_cache_lock);
+  if (++g_inode_cache_gen == 0)
+    {
+      memset(g_inode_cache, 0, sizeof(g_inode_cache));
+      g_inode_cache_gen = 1;
+    }
+
+  spin_unlock_irqrestore(&g_inode_cache_lock, flags);
+}
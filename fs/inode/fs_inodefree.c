@@ -76,6 +76,10 @@ void inode_free(FAR struct inode *inode)
         }
 #endif
 
+#ifdef CONFIG_FS_INODE_HASH
+      fs_heap_free(inode->i_hash);
+#endif
+
       fs_heap_free(inode);
     }
 }
@@ -0,0 +1,323 @@
+/****************************************************************************
+ * fs/inode/fs_inodehash.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <nuttx/fs/fs.h>
+
+#include "inode/inode.h"
+#include "fs_heap.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define SIZEOF_INODE_HASH_S(n) \
+  (sizeof(struct inode_hash_s) + ((n) - 1) * sizeof(FAR struct inode *))
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The index of the children of one directory.  The children stay linked
+ * in sorted order through i_child/i_peer, the index only chains them
+ * through i_hnext by the hash of their name.
+ */
+
+struct inode_hash_s
+{
+  size_t count;                 /* Number of children */
+  size_t mask;                  /* Number of buckets - 1 */
+  FAR struct inode *last;       /* Last inserted child, a sorted insert hint */
+  FAR struct inode *bucket[1];  /* Hash chains */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: inode_hash_name
+ *
+ * Description:
+ *   Hash the first segment of 'name' and return the segment length.
+ *
+ ****************************************************************************/
+
+static size_t inode_hash_name(FAR const char *name, FAR uint32_t *hash)
+{
+  uint32_t h = 2166136261u;
+  size_t len;
+
+  for (len = 0; name[len] != '\0' && name[len] != '/'; len++)
+    {
+      h = (h ^ (uint8_t)name[len]) * 16777619u;
+    }
+
+  *hash = h ^ (h >> 16);
+  return len;
+}
+
+/****************************************************************************
+ * Name: inode_hash_compare
+ *
+ * Description:
+ *   Compare the first segment of 'name' with the name of 'node' in the same
+ *   order as the sorted peer list.
+ *
+ ****************************************************************************/
+
+static int inode_hash_compare(FAR const char *name, FAR struct inode *node)
+{
+  FAR const char *nname = node->i_name;
+
+  for (; *nname != '\0' && *name != '\0' && *name != '/'; name++, nname++)
+    {
+      if (*name != *nname)
+        {
+          return *name > *nname ? 1 : -1;
+        }
+    }
+
+  if (*nname != '\0')
+    {
+      return -1;
+    }
+
+  return *name != '\0' && *name != '/' ? 1 : 0;
+}
+
+/****************************************************************************
+ * Name: inode_hash_add
+ ****************************************************************************/
+
+static void inode_hash_add(FAR struct inode_hash_s *hash,
+                           FAR struct inode *node)
+{
+  uint32_t h;
+
+  inode_hash_name(node->i_name, &h);
+  node->i_hnext = hash->bucket[h & hash->mask];
+  hash->bucket[h & hash->mask] = node;
+}
+
+/****************************************************************************
+ * Name: inode_hash_build
+ *
+ * Description:
+ *   Index all children of 'parent' into a new table of 'nbuckets'.
+ *
+ ****************************************************************************/
+
+static FAR struct inode_hash_s *inode_hash_build(FAR struct inode *parent,
+                                                 size_t count,
+                                                 size_t nbuckets)
+{
+  FAR struct inode_hash_s *hash;
+  FAR struct inode *node;
+
+  hash = fs_heap_zalloc(SIZEOF_INODE_HASH_S(nbuckets));
+  if (hash != NULL)
+    {
+      hash->count = count;
+      hash->mask  = nbuckets - 1;
+      for (node = parent->i_child; node != NULL; node = node->i_peer)
+        {
+          inode_hash_add(hash, node);
+        }
+    }
+
+  return hash;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: inode_hash_lookup
+ *
+ * Description:
+ *   Find the child of 'parent' named by the first segment of 'name'
+ *   through the index of 'parent'.
+ *
+ ****************************************************************************/
+
+FAR struct inode *inode_hash_lookup(FAR struct inode *parent,
+                                    FAR const char *name)
+{
+  FAR struct inode_hash_s *hash = parent->i_hash;
+  FAR struct inode *node;
+  uint32_t h;
+
+  inode_hash_name(name, &h);
+  for (node = hash->bucket[h & hash->mask]; node != NULL;
+       node = node->i_hnext)
+    {
+      if (inode_hash_compare(name, node) == 0)
+        {
+          break;
+        }
+    }
+
+  return node;
+}
+
+/****************************************************************************
+ * Name: inode_hash_left
+ *
+ * Description:
+ *   Return the child of the indexed 'parent' that sorts right before the
+ *   first segment of 'name', NULL if it belongs at the head of the list.
+ *   Nodes are often added in sorted order (sensor0, sensor1...), so the
+ *   walk starts from the last inserted node whenever possible.
+ *
+ ****************************************************************************/
+
+FAR struct inode *inode_hash_left(FAR struct inode *parent,
+                                  FAR const char *name)
+{
+  FAR struct inode_hash_s *hash = parent->i_hash;
+  FAR struct inode *left = NULL;
+  FAR struct inode *node = parent->i_child;
+
+  if (hash->last != NULL && inode_hash_compare(name, hash->last) > 0)
+    {
+      left = hash->last;
+      node = left->i_peer;
+    }
+
+  while (node != NULL && inode_hash_compare(name, node) > 0)
+    {
+      left = node;
+      node = node->i_peer;
+    }
+
+  return left;
+}
+
+/****************************************************************************
+ * Name: inode_hash_insert
+ *
+ * Description:
+ *   Account for 'node' just linked under 'parent'.  The index is created
+ *   once 'parent' has CONFIG_FS_INODE_HASH_THRESHOLD children and doubled
+ *   when the chains get long.  Running out of memory only means that the
+ *   lookups stay linear.
+ *
+ * Assumptions:
+ *   The caller holds the g_inode_sem semaphore for writing.
+ *
+ ****************************************************************************/
+
+void inode_hash_insert(FAR struct inode *parent, FAR struct inode *node)
+{
+  FAR struct inode_hash_s *hash = parent->i_hash;
+  FAR struct inode *child;
+  size_t nbuckets;
+  size_t count;
+
+  if (hash == NULL)
+    {
+      count = 0;
+      for (child = parent->i_child; child != NULL; child = child->i_peer)
+        {
+          count++;
+        }
+
+      if (count < CONFIG_FS_INODE_HASH_THRESHOLD)
+        {
+          return;
+        }
+
+      nbuckets = 1;
+      while (nbuckets < count)
+        {
+          nbuckets <<= 1;
+        }
+
+      parent->i_hash = inode_hash_build(parent, count, nbuckets);
+      return;
+    }
+
+  hash->last = node;
+  if (++hash->count > 2 * (hash->mask + 1))
+    {
+      hash = inode_hash_build(parent, hash->count, 2 * (hash->mask + 1));
+      if (hash != NULL)
+        {
+          hash->last = node;
+          fs_heap_free(parent->i_hash);
+          parent->i_hash = hash;
+          return;
+        }
+
+      hash = parent->i_hash;
+    }
+
+  inode_hash_add(hash, node);
+}
+
+/****************************************************************************
+ * Name: inode_hash_remove
+ *
+ * Description:
+ *   Drop 'node', about to be unlinked from 'parent', from the index.
+ *
+ * Assumptions:
+ *   The caller holds the g_inode_sem semaphore for writing.
+ *
+ ****************************************************************************/
+
+void inode_hash_remove(FAR struct inode *parent, FAR struct inode *node)
+{
+  FAR struct inode_hash_s *hash = parent->i_hash;
+  FAR struct inode **prev;
+  uint32_t h;
+
+  inode_hash_name(node->i_name, &h);
+  for (prev = &hash->bucket[h & hash->mask]; *prev != NULL;
+       prev = &(*prev)->i_hnext)
+    {
+      if (*prev == node)
+        {
+          *prev = node->i_hnext;
+          break;
+        }
+    }
+
+  if (hash->last == node)
+    {
+      hash->last = NULL;
+    }
+
+  node->i_hnext = NULL;
+  hash->count--;
+}
@@ -79,6 +79,14 @@ static FAR struct inode *inode_unlink(FAR const char *path)
       inode = desc.node;
       DEBUGASSERT(inode != NULL);
 
+#ifdef CONFIG_FS_INODE_HASH
+      if (desc.parent != NULL && desc.parent->i_hash != NULL)
+        {
+          desc.peer = inode_hash_left(desc.parent, inode->i_name);
+          inode_hash_remove(desc.parent, inode);
+        }
+#endif
+
       /* If peer is non-null, then remove the node from the right of
        * of that peer node.
        */
@@ -99,6 +107,7 @@ static FAR struct inode *inode_unlink(FAR const char *path)
       inode->i_peer   = NULL;
       inode->i_parent = NULL;
       atomic_fetch_sub(&inode->i_crefs, 1);
+      inode_cache_invalidate();
     }
 
   RELEASE_SEARCH(&desc);
@@ -109,6 +109,13 @@ static void inode_insert(FAR struct inode *inode,
                          FAR struct inode *peer,
                          FAR struct inode *parent)
 {
+#ifdef CONFIG_FS_INODE_HASH
+  if (parent != NULL && parent->i_hash != NULL)
+    {
+      peer = inode_hash_left(parent, inode->i_name);
+    }
+#endif
+
   /* If peer is non-null, then new node simply goes to the right
    * of that peer node.
    */
@@ -129,6 +136,15 @@ static void inode_insert(FAR struct inode *inode,
       inode->i_parent = parent;
       parent->i_child = inode;
     }
+
+#ifdef CONFIG_FS_INODE_HASH
+  if (parent != NULL)
+    {
+      inode_hash_insert(parent, inode);
+    }
+#endif
+
+  inode_cache_invalidate();
 }
 
 /****************************************************************************
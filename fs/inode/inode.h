@@ -211,6 +211,100 @@ void inode_unlock(void);
 
 void inode_runlock(void);
 
+/****************************************************************************
+ * Name: inode_cache_lookup
+ *
+ * Description:
+ *   Look up the first segment of 'name' among the children of 'parent' in
+ *   the path component cache.  On a hit, return true with the matching
+ *   node (NULL if the name is known to be absent) in 'node' and the node
+ *   to its "left" in 'left'.
+ *
+ * Assumptions:
+ *   The caller holds the g_inode_sem semaphore, for reading at least.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_INODE_CACHE
+bool inode_cache_lookup(FAR struct inode *parent, FAR const char *name,
+                        FAR struct inode **node, FAR struct inode **left);
+
+/****************************************************************************
+ * Name: inode_cache_add
+ *
+ * Description:
+ *   Remember the result of a look up of the first segment of 'name' among
+ *   the children of 'parent'.  'node' is NULL for a negative entry.
+ *
+ ****************************************************************************/
+
+void inode_cache_add(FAR struct inode *parent, FAR const char *name,
+                     FAR struct inode *node, FAR struct inode *left);
+
+/****************************************************************************
+ * Name: inode_cache_invalidate
+ *
+ * Description:
+ *   Drop all cached look ups.  Must be called whenever the shape of the
+ *   inode tree changes.
+ *
+ * Assumptions:
+ *   The caller holds the g_inode_sem semaphore for writing.
+ *
+ ****************************************************************************/
+
+void inode_cache_invalidate(void);
+#else
+#  define inode_cache_invalidate()
+#endif
+
+/****************************************************************************
+ * Name: inode_hash_lookup
+ *
+ * Description:
+ *   Find the child of 'parent' named by the first segment of 'name'
+ *   through the index of 'parent'.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_INODE_HASH
+FAR struct inode *inode_hash_lookup(FAR struct inode *parent,
+                                    FAR const char *name);
+
+/****************************************************************************
+ * Name: inode_hash_left
+ *
+ * Description:
+ *   Return the child of the indexed 'parent' that sorts right before the
+ *   first segment of 'name', NULL if it belongs at the head of the list.
+ *
+ ****************************************************************************/
+
+FAR struct inode *inode_hash_left(FAR struct inode *parent,
+                                  FAR const char *name);
+
+/****************************************************************************
+ * Name: inode_hash_insert
+ *
+ * Description:
+ *   Account for 'node' just linked under 'parent', creating the index of
+ *   'parent' once it has enough children.
+ *
+ ****************************************************************************/
+
+void inode_hash_insert(FAR struct inode *parent, FAR struct inode *node);
+
+/****************************************************************************
+ * Name: inode_hash_remove
+ *
+ * Description:
+ *   Drop 'node', about to be unlinked from 'parent', from the index.
+ *
+ ****************************************************************************/
+
+void inode_hash_remove(FAR struct inode *parent, FAR struct inode *node);
+#endif
+
 /****************************************************************************
  * Name: inode_search
  *
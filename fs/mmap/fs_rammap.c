@@ -27,16 +27,24 @@
 #include <nuttx/config.h>
 #include <sys/types.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/param.h>
 
 #include <assert.h>
 #include <debug.h>
 #include <errno.h>
 #include <inttypes.h>
+#include <sched.h>
 #include <string.h>
 #include <unistd.h>
 
+#include <nuttx/arch.h>
 #include <nuttx/fs/fs.h>
+#include <nuttx/irq.h>
 #include <nuttx/kmalloc.h>
+#include <nuttx/mutex.h>
+#include <nuttx/nuttx.h>
+#include <nuttx/queue.h>
 #include <nuttx/sched.h>
 
 #include "fs_rammap.h"
@@ -44,84 +52,317 @@
 #include "fs_heap.h"
 
 /****************************************************************************
- * Public Data
+ * Pre-processor Definitions
  ****************************************************************************/
 
+#ifdef CONFIG_FS_RAMMAP_PAGESIZE
+#  define RAMMAP_PAGESIZE CONFIG_FS_RAMMAP_PAGESIZE
+#else
+#  define RAMMAP_PAGESIZE 0
+#endif
+
+/* The state of a page of a demand filled mapping */
+
+#define RAMMAP_ABSENT    0      /* Not read yet, no access */
+#define RAMMAP_CLEAN     1      /* Same as the file, no access */
+#define RAMMAP_ACCESSED  2      /* Accessible, may differ from the file */
+
 /****************************************************************************
- * Private Functions
+ * Private Types
  ****************************************************************************/
 
+#if RAMMAP_PAGESIZE > 0
+/* With demand filling, entry->priv.p points to this structure instead of
+ * the tagged file pointer.  The pages of a user mapping start without any
+ * access; the first access faults and the page is read from the file.
+ * msync() writes back the pages accessed since they were read or written
+ * back, and takes their access away again.
+ */
+
+struct rammap_s
+{
+  sq_entry_t node;              /* Link in g_rammap_list */
+  FAR struct file *filep;       /* The backing file */
+  enum mm_map_type_e type;      /* Where the region memory came from */
+  FAR uint8_t *vaddr;           /* Page aligned start of the region */
+  off_t offset;                 /* File offset of the region */
+  size_t length;                /* Mapped length */
+  size_t npages;                /* Pages filled on demand, 0 if none */
+  uint8_t state[1];             /* State of each page */
+};
+
+#  define SIZEOF_RAMMAP_S(n) (sizeof(struct rammap_s) + (n) - 1)
+#  define RAMMAP_FILEP(e) (((FAR struct rammap_s *)(e)->priv.p)->filep)
+#  define RAMMAP_TYPE(e)  (((FAR struct rammap_s *)(e)->priv.p)->type)
+#else
+#  define RAMMAP_FILEP(e) ((FAR struct file *)((uintptr_t)(e)->priv.p & ~3))
+#  define RAMMAP_TYPE(e)  ((enum mm_map_type_e)((uintptr_t)(e)->priv.p & 3))
+#endif
+
 /****************************************************************************
- * Name: msync_rammap
+ * Private Data
  ****************************************************************************/
 
-static int msync_rammap(FAR struct mm_map_entry_s *entry, FAR void *start,
-                        size_t length, int flags)
-{
-  FAR struct file *filep = (FAR void *)((uintptr_t)entry->priv.p & ~3);
-  FAR uint8_t *wrbuffer = start;
-  ssize_t nwrite = 0;
-  off_t offset;
-  off_t fpos;
-  off_t opos;
+#if RAMMAP_PAGESIZE > 0
+/* The demand filled mappings of all tasks, looked up by the fault handler.
+ * The lock also protects the page states and the bounce buffer.
+ */
 
-  offset = (uintptr_t)start - (uintptr_t)entry->vaddr;
-  if (length > entry->length - offset)
-    {
-      length = entry->length - offset;
-    }
+static mutex_t g_rammap_lock = NXMUTEX_INITIALIZER;
+static sq_queue_t g_rammap_list;
+static uint8_t g_rammap_page[RAMMAP_PAGESIZE];
+#endif
 
-  opos = file_seek(filep, 0, SEEK_CUR);
-  if (opos < 0)
-    {
-      ferr("ERROR: Get current position failed\n");
-      return opos;
-    }
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
 
-  fpos = file_seek(filep, entry->offset + offset, SEEK_SET);
-  if (fpos < 0)
-    {
-      ferr("ERROR: Seek to position %"PRIdOFF" failed\n", fpos);
-      return fpos;
-    }
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: rammap_write
+ *
+ * Description:
+ *   Write length bytes of the mapped region at the file position pos.
+ *
+ ****************************************************************************/
+
+static int rammap_write(FAR struct file *filep, off_t pos,
+                        FAR const uint8_t *wrbuffer, size_t length)
+{
+  ssize_t nwrite;
 
   while (length > 0)
     {
-      nwrite = file_write(filep, wrbuffer, length);
+      nwrite = file_pwrite(filep, wrbuffer, length, pos);
       if (nwrite < 0)
         {
           /* Handle the special case where the write was interrupted by a
            * signal.
            */
 
-          if (nwrite != -EINTR)
+          if (nwrite == -EINTR)
             {
-              /* All other write errors are bad. */
-
-              ferr("ERROR: Write failed: offset=%"PRIdOFF" nwrite=%zd\n",
-                   entry->offset, nwrite);
-              break;
+              continue;
             }
+
+          /* All other write errors are bad. */
+
+          ferr("ERROR: Write failed: offset=%"PRIdOFF" nwrite=%zd\n",
+               pos, nwrite);
+          return nwrite;
         }
 
       /* Increment number of bytes written */
 
       wrbuffer += nwrite;
       length   -= nwrite;
+      pos      += nwrite;
     }
 
-  /* Restore file pos */
+  return OK;
+}
 
-  fpos = file_seek(filep, opos, SEEK_SET);
-  if (fpos < 0)
+#if RAMMAP_PAGESIZE > 0
+/****************************************************************************
+ * Name: rammap_fill
+ *
+ * Description:
+ *   Give access to a page of a demand filled mapping, reading it from the
+ *   file first if it was never read.  The data past the end of file is
+ *   zeroed.  Called with g_rammap_lock held.
+ *
+ ****************************************************************************/
+
+static int rammap_fill(FAR struct rammap_s *priv, size_t page)
+{
+  FAR uint8_t *addr = priv->vaddr + page * RAMMAP_PAGESIZE;
+  size_t size = MIN(RAMMAP_PAGESIZE, priv->length - page * RAMMAP_PAGESIZE);
+  size_t nread = 0;
+  ssize_t ret;
+
+  if (priv->state[page] == RAMMAP_ACCESSED)
+    {
+      return OK;
+    }
+
+  if (priv->state[page] == RAMMAP_ABSENT)
+    {
+      while (nread < size)
+        {
+          ret = file_pread(priv->filep, g_rammap_page + nread, size - nread,
+                           priv->offset + page * RAMMAP_PAGESIZE + nread);
+          if (ret == -EINTR)
+            {
+              continue;
+            }
+          else if (ret < 0)
+            {
+              ferr("ERROR: Read failed: offset=%"PRIdOFF" ret=%zd\n",
+                   priv->offset, ret);
+              return ret;
+            }
+          else if (ret == 0)
+            {
+              break;
+            }
+
+          nread += ret;
+        }
+
+      memset(g_rammap_page + nread, 0, RAMMAP_PAGESIZE - nread);
+    }
+
+  /* Don't let other tasks see the page before it is filled */
+
+  sched_lock();
+  ret = up_mprotect(addr, RAMMAP_PAGESIZE, true);
+  if (ret >= 0)
     {
-      /* Ensure that we finally seek back to the current file pos */
+      if (priv->state[page] == RAMMAP_ABSENT)
+        {
+          memcpy(addr, g_rammap_page, RAMMAP_PAGESIZE);
+        }
 
-      ferr("ERROR: Seek back to position %"PRIdOFF" failed\n", fpos);
-      return fpos;
+      priv->state[page] = RAMMAP_ACCESSED;
     }
 
-  return nwrite >= 0 ? 0 : nwrite;
+  sched_unlock();
+  return ret;
+}
+
+/****************************************************************************
+ * Name: rammap_sync
+ *
+ * Description:
+ *   Write back the accessed pages first..last of a demand filled mapping
+ *   and take their access away, so that the next change faults again.
+ *   The page is copied with access taken away at the same time, so a
+ *   change made meanwhile is never lost.  Called with g_rammap_lock held.
+ *
+ ****************************************************************************/
+
+static int rammap_sync(FAR struct rammap_s *priv, size_t first, size_t last)
+{
+  FAR uint8_t *addr;
+  size_t size;
+  int ret = OK;
+
+  for (; first <= last && first < priv->npages; first++)
+    {
+      if (priv->state[first] != RAMMAP_ACCESSED)
+        {
+          continue;
+        }
+
+      addr = priv->vaddr + first * RAMMAP_PAGESIZE;
+      size = MIN(RAMMAP_PAGESIZE, priv->length - first * RAMMAP_PAGESIZE);
+
+      sched_lock();
+      memcpy(g_rammap_page, addr, size);
+      if (up_mprotect(addr, RAMMAP_PAGESIZE, false) >= 0)
+        {
+          priv->state[first] = RAMMAP_CLEAN;
+        }
+
+      sched_unlock();
+
+      ret = rammap_write(priv->filep, priv->offset +
+                         first * RAMMAP_PAGESIZE, g_rammap_page, size);
+      if (ret < 0)
+        {
+          /* Let the next msync() try this page again */
+
+          rammap_fill(priv, first);
+          break;
+        }
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: rammap_release
+ *
+ * Description:
+ *   Shorten a demand filled mapping to 'length' bytes, or stop filling it
+ *   if 'length' is zero.  All access is given back to the released pages
+ *   so that the heap may use the memory again.
+ *
+ ****************************************************************************/
+
+static void rammap_release(FAR struct rammap_s *priv, size_t length)
+{
+  size_t npages = ALIGN_UP(length, RAMMAP_PAGESIZE) / RAMMAP_PAGESIZE;
+
+  nxmutex_lock(&g_rammap_lock);
+
+  if (npages == 0)
+    {
+      sq_rem(&priv->node, &g_rammap_list);
+    }
+
+  if (priv->npages > npages)
+    {
+      up_mprotect(priv->vaddr + npages * RAMMAP_PAGESIZE,
+                  (priv->npages - npages) * RAMMAP_PAGESIZE, true);
+    }
+
+  priv->length = length;
+  priv->npages = npages;
+
+  nxmutex_unlock(&g_rammap_lock);
+}
+#endif
+
+/****************************************************************************
+ * Name: msync_rammap
+ ****************************************************************************/
+
+static int msync_rammap(FAR struct mm_map_entry_s *entry, FAR void *start,
+                        size_t length, int flags)
+{
+  FAR struct file *filep = RAMMAP_FILEP(entry);
+#if RAMMAP_PAGESIZE > 0
+  FAR struct rammap_s *priv = entry->priv.p;
+#endif
+  off_t offset;
+  int ret;
+
+  offset = (uintptr_t)start - (uintptr_t)entry->vaddr;
+  if (length > entry->length - offset)
+    {
+      length = entry->length - offset;
+    }
+
+  /* Private and read only mappings never reach the file */
+
+  if ((entry->flags & MAP_SHARED) == 0 ||
+      (entry->prot & PROT_WRITE) == 0 || length == 0)
+    {
+      return OK;
+    }
+
+#if RAMMAP_PAGESIZE > 0
+  if (priv->npages > 0)
+    {
+      ret = nxmutex_lock(&g_rammap_lock);
+      if (ret >= 0)
+        {
+          ret = rammap_sync(priv, offset / RAMMAP_PAGESIZE,
+                            (offset + length - 1) / RAMMAP_PAGESIZE);
+          nxmutex_unlock(&g_rammap_lock);
+        }
+
+      return ret;
+    }
+#endif
+
+  ret = rammap_write(filep, entry->offset + offset,
+                     (FAR uint8_t *)start, length);
+  return ret;
 }
 
 /****************************************************************************
@@ -133,10 +374,13 @@ static int unmap_rammap(FAR struct task_group_s *group,
                         FAR void *start,
                         size_t length)
 {
-  FAR struct file *filep = (FAR void *)((uintptr_t)entry->priv.p & ~3);
-  enum mm_map_type_e type =
-                    (enum mm_map_type_e)((uintptr_t)entry->priv.p & 3);
+  FAR struct file *filep = RAMMAP_FILEP(entry);
+  enum mm_map_type_e type = RAMMAP_TYPE(entry);
+#if RAMMAP_PAGESIZE > 0
+  FAR struct rammap_s *priv = entry->priv.p;
+#endif
   FAR void *newaddr = NULL;
+  size_t alloclen;
   off_t offset;
   int ret = OK;
 
@@ -164,6 +408,13 @@ static int unmap_rammap(FAR struct task_group_s *group,
 
   if (length >= entry->length)
     {
+#if RAMMAP_PAGESIZE > 0
+      if (priv->npages > 0)
+        {
+          rammap_release(priv, 0);
+        }
+#endif
+
       /* Free the region */
 
       if (type == MAP_KERNEL)
@@ -176,6 +427,9 @@ static int unmap_rammap(FAR struct task_group_s *group,
         }
 
       fs_putfilep(filep);
+#if RAMMAP_PAGESIZE > 0
+      fs_heap_free(priv);
+#endif
 
       /* Then remove the mapping from the list */
 
@@ -188,13 +442,27 @@ static int unmap_rammap(FAR struct task_group_s *group,
 
   else
     {
+      length   = offset;
+      alloclen = offset;
+#if RAMMAP_PAGESIZE > 0
+      if (priv->npages > 0)
+        {
+          /* The region keeps whole pages, so the heap never shares a page
+           * whose access is taken away.
+           */
+
+          alloclen = ALIGN_UP(length, RAMMAP_PAGESIZE);
+          rammap_release(priv, length);
+        }
+#endif
+
       if (type == MAP_KERNEL)
         {
-          newaddr = fs_heap_realloc(entry->vaddr, length);
+          newaddr = fs_heap_realloc(entry->vaddr, alloclen);
         }
       else if (type == MAP_USER)
         {
-          newaddr = kumm_realloc(entry->vaddr, length);
+          newaddr = kumm_realloc(entry->vaddr, alloclen);
         }
 
       DEBUGASSERT(newaddr == entry->vaddr);
@@ -209,11 +477,52 @@ static int unmap_rammap(FAR struct task_group_s *group,
  * Public Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: rammap_fault
+ *
+ * Description:
+ *   Called by the architecture fault handler when an access to memory
+ *   without access permissions faults.  If 'addr' lies in a demand filled
+ *   file mapping, the page is read in, or given access again, and true is
+ *   returned so that the access is retried.
+ *
+ ****************************************************************************/
+
+#if RAMMAP_PAGESIZE > 0
+bool rammap_fault(FAR void *addr)
+{
+  FAR struct rammap_s *priv;
+  FAR uint8_t *vaddr = addr;
+  int ret = -EFAULT;
+
+  if (up_interrupt_context() || nxmutex_lock(&g_rammap_lock) < 0)
+    {
+      return false;
+    }
+
+  for (priv = (FAR struct rammap_s *)sq_peek(&g_rammap_list);
+       priv != NULL; priv = (FAR struct rammap_s *)sq_next(&priv->node))
+    {
+      if (vaddr >= priv->vaddr &&
+          vaddr < priv->vaddr + priv->npages * RAMMAP_PAGESIZE)
+        {
+          ret = rammap_fill(priv, (vaddr - priv->vaddr) / RAMMAP_PAGESIZE);
+          break;
+        }
+    }
+
+  nxmutex_unlock(&g_rammap_lock);
+  return ret >= 0;
+}
+#endif
+
 /****************************************************************************
  * Name: rammmap
  *
  * Description:
  *   Support simulation of memory mapped files by copying files into RAM.
+ *   With CONFIG_FS_RAMMAP_PAGESIZE, the pages of user mappings are read
+ *   from the file on their first access instead.
  *
  * Input Parameters:
  *   filep   file descriptor of the backing file -- required.
@@ -237,16 +546,42 @@ static int unmap_rammap(FAR struct task_group_s *group,
 int rammap(FAR struct file *filep, FAR struct mm_map_entry_s *entry,
            enum mm_map_type_e type)
 {
+#if RAMMAP_PAGESIZE > 0
+  FAR struct rammap_s *priv;
+  size_t npages = 0;
+#endif
   FAR uint8_t *rdbuffer;
   ssize_t nread;
   off_t fpos;
   int ret;
   size_t length = entry->length;
 
+#if RAMMAP_PAGESIZE > 0
+  /* Only user mappings are filled on demand: the kernel users expect the
+   * data to be there, and must not fault while holding file system locks.
+   */
+
+  if (type == MAP_USER)
+    {
+      npages = (length + RAMMAP_PAGESIZE - 1) / RAMMAP_PAGESIZE;
+    }
+
+  priv = fs_heap_zalloc(SIZEOF_RAMMAP_S(npages > 0 ? npages : 1));
+  if (priv == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  priv->filep = filep;
+#endif
+
   ret = file_ioctl(filep, BIOC_XIPBASE, (unsigned long)&entry->vaddr);
   if (ret == OK)
     {
       type = MAP_XIP;
+#if RAMMAP_PAGESIZE > 0
+      npages = 0;
+#endif
       goto out;
     }
 
@@ -263,6 +598,42 @@ int rammap(FAR struct file *filep, FAR struct mm_map_entry_s *entry,
    * Not very useful!
    */
 
+#if RAMMAP_PAGESIZE > 0
+  if (npages > 0)
+    {
+      /* Allocate whole pages and take all access away from them, the
+       * first access of each page faults and reads it in.
+       */
+
+      entry->vaddr = kumm_memalign(RAMMAP_PAGESIZE,
+                                   npages * RAMMAP_PAGESIZE);
+      if (entry->vaddr == NULL)
+        {
+          ferr("ERROR: Region allocation failed, length: %zu\n", length);
+          fs_heap_free(priv);
+          return -ENOMEM;
+        }
+
+      ret = up_mprotect(entry->vaddr, npages * RAMMAP_PAGESIZE, false);
+      if (ret < 0)
+        {
+          ferr("ERROR: Protect region failed: %d\n", ret);
+          npages = 0;
+          goto errout_with_region;
+        }
+
+      priv->vaddr  = entry->vaddr;
+      priv->offset = entry->offset;
+      priv->length = length;
+      priv->npages = npages;
+
+      nxmutex_lock(&g_rammap_lock);
+      sq_addlast(&priv->node, &g_rammap_list);
+      nxmutex_unlock(&g_rammap_lock);
+      goto out;
+    }
+#endif
+
   /* Allocate a region of memory of the specified size */
 
   rdbuffer = type == MAP_KERNEL ? fs_heap_malloc(length)
@@ -270,6 +641,9 @@ int rammap(FAR struct file *filep, FAR struct mm_map_entry_s *entry,
   if (!rdbuffer)
     {
       ferr("ERROR: Region allocation failed, length: %zu\n", length);
+#if RAMMAP_PAGESIZE > 0
+      fs_heap_free(priv);
+#endif
       return -ENOMEM;
     }
 
@@ -310,6 +684,8 @@ int rammap(FAR struct file *filep, FAR struct mm_map_entry_s *entry,
               ret = nread;
               goto errout_with_region;
             }
+
+          continue;
         }
 
       /* Check for end of file. */
@@ -333,19 +709,32 @@ int rammap(FAR struct file *filep, FAR struct mm_map_entry_s *entry,
 
 out:
   fs_reffilep(filep);
+#if RAMMAP_PAGESIZE > 0
+  priv->type    = type;
+  entry->priv.p = priv;
+#else
   entry->priv.p = (FAR void *)((uintptr_t)filep | type);
+#endif
   entry->munmap = unmap_rammap;
   entry->msync = msync_rammap;
 
   ret = mm_map_add(get_current_mm(), entry);
   if (ret < 0)
     {
+      fs_putfilep(filep);
       goto errout_with_region;
     }
 
   return OK;
 
 errout_with_region:
+#if RAMMAP_PAGESIZE > 0
+  if (npages > 0)
+    {
+      rammap_release(priv, 0);
+    }
+#endif
+
   if (type == MAP_KERNEL)
     {
       fs_heap_free(entry->vaddr);
@@ -355,5 +744,8 @@ errout_with_region:
       kumm_free(entry->vaddr);
     }
 
+#if RAMMAP_PAGESIZE > 0
+  fs_heap_free(priv);
+#endif
   return ret;
 }
@@ -31,9 +31,11 @@
  *
  * - All of the file must be present in memory.  This limits the size of
  *   files that may be memory mapped (especially on MCUs with no significant
- *   RAM resources).
- * - All mapped files are read-only.  You can write to the in-memory image,
- *   but the file contents will not change.
+ *   RAM resources).  With CONFIG_FS_RAMMAP_PAGESIZE, the memory of a user
+ *   mapping is still allocated whole, but each page is only read from the
+ *   file on its first access.
+ * - The file contents only change when the in-memory image is written back
+ *   with msync().  Private and read only mappings are never written back.
  * - There are not access privileges.
  */
 
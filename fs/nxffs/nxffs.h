@@ -174,6 +174,10 @@
 
 #define NXFFS_NERASED             128
 
+#ifndef CONFIG_NXFFS_INODE_INDEX
+#  define CONFIG_NXFFS_INODE_INDEX 0
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -263,6 +267,16 @@ struct nxffs_wrfile_s
   uint32_t                  crc;        /* Accumulated data block CRC */
 };
 
+#if CONFIG_NXFFS_INODE_INDEX > 0
+/* This structure describes one entry in the in-memory inode index */
+
+struct nxffs_ixentry_s
+{
+  uint32_t                  hash;      /* Hash of the inode name */
+  off_t                     hoffset;   /* FLASH offset to the inode header */
+};
+#endif
+
 /* This structure represents the overall state of on NXFFS instance. */
 
 struct nxffs_volume_s
@@ -281,6 +295,12 @@ struct nxffs_volume_s
   FAR struct nxffs_ofile_s *ofiles;    /* A singly-linked list of open files */
   FAR uint8_t              *cache;     /* On cached erase block for general I/O */
   FAR uint8_t              *pack;      /* A full erase block to support packing */
+#if CONFIG_NXFFS_INODE_INDEX > 0
+  FAR struct nxffs_ixentry_s *index;   /* Inode headers sorted by name hash */
+  uint16_t                  ixcount;   /* Number of entries in the index */
+  uint16_t                  ixalloc;   /* Number of entries allocated */
+  bool                      ixvalid;   /* True: The index holds every inode */
+#endif
 };
 
 /* This structure describes the state of the blocks on the NXFFS volume */
@@ -646,6 +666,151 @@ int nxffs_findinode(FAR struct nxffs_volume_s *volume, FAR const char *name,
 off_t nxffs_inodeend(FAR struct nxffs_volume_s *volume,
                      FAR struct nxffs_entry_s *entry);
 
+#if CONFIG_NXFFS_INODE_INDEX > 0
+/****************************************************************************
+ * Name: nxffs_ixhash
+ *
+ * Description:
+ *   Return the hash of an inode name used to order the inode index.
+ *
+ * Input Parameters:
+ *   name - The inode name.
+ *
+ * Returned Value:
+ *   The hash of the name.
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+uint32_t nxffs_ixhash(FAR const char *name);
+
+/****************************************************************************
+ * Name: nxffs_ixreset
+ *
+ * Description:
+ *   Empty the inode index and mark it valid, as is appropriate before
+ *   inodes are added to it by a full scan of the volume (or after the
+ *   volume has been formatted).
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume.
+ *
+ * Returned Value:
+ *   None
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+void nxffs_ixreset(FAR struct nxffs_volume_s *volume);
+
+/****************************************************************************
+ * Name: nxffs_ixinvalidate
+ *
+ * Description:
+ *   Mark the inode index as not usable.  Inodes will be found by scanning
+ *   the volume until the index is rebuilt.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume.
+ *
+ * Returned Value:
+ *   None
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+void nxffs_ixinvalidate(FAR struct nxffs_volume_s *volume);
+
+/****************************************************************************
+ * Name: nxffs_ixadd
+ *
+ * Description:
+ *   Add a valid inode to the inode index.  If the index is full and cannot
+ *   grow, it is invalidated.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume.
+ *   entry  - Describes the inode.
+ *
+ * Returned Value:
+ *   None
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+void nxffs_ixadd(FAR struct nxffs_volume_s *volume,
+                 FAR const struct nxffs_entry_s *entry);
+
+/****************************************************************************
+ * Name: nxffs_ixremove
+ *
+ * Description:
+ *   Remove a deleted inode from the inode index.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume.
+ *   entry  - Describes the inode.
+ *
+ * Returned Value:
+ *   None
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+void nxffs_ixremove(FAR struct nxffs_volume_s *volume,
+                    FAR const struct nxffs_entry_s *entry);
+
+/****************************************************************************
+ * Name: nxffs_ixbuild
+ *
+ * Description:
+ *   Rebuild the inode index by scanning all of the inodes on the volume.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume.
+ *
+ * Returned Value:
+ *   None.  On a failure, the index is left invalid.
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+void nxffs_ixbuild(FAR struct nxffs_volume_s *volume);
+
+/****************************************************************************
+ * Name: nxffs_ixfind
+ *
+ * Description:
+ *   Return the range of inode index entries with the given name hash.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume.
+ *   hash   - The hash of the inode name.
+ *
+ * Returned Value:
+ *   The index of the first entry with the hash.  The entries with this hash
+ *   continue up to (but not including) the first entry with a different
+ *   hash or the end of the index.
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+int nxffs_ixfind(FAR struct nxffs_volume_s *volume, uint32_t hash);
+#else
+#  define nxffs_ixreset(v)
+#  define nxffs_ixinvalidate(v)
+#  define nxffs_ixadd(v,e)
+#  define nxffs_ixremove(v,e)
+#  define nxffs_ixbuild(v)
+#endif
+
 /****************************************************************************
  * Name: nxffs_verifyblock
  *
@@ -0,0 +1,300 @@
+/****************************************************************************
+ * fs/nxffs/nxffs_index.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <debug.h>
+
+#include "fs_heap.h"
+#include "nxffs.h"
+
+#if CONFIG_NXFFS_INODE_INDEX > 0
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The number of index entries allocated when the index is first used */
+
+#define NXFFS_IXINITIAL 16
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxffs_ixgrow
+ *
+ * Description:
+ *   Make room for one more entry in the inode index, doubling the
+ *   allocation up to the configured maximum.
+ *
+ ****************************************************************************/
+
+static int nxffs_ixgrow(FAR struct nxffs_volume_s *volume)
+{
+  FAR struct nxffs_ixentry_s *index;
+  unsigned int nalloc;
+
+  if (volume->ixcount < volume->ixalloc)
+    {
+      return OK;
+    }
+
+  if (volume->ixalloc >= CONFIG_NXFFS_INODE_INDEX)
+    {
+      return -ENOSPC;
+    }
+
+  nalloc = volume->ixalloc > 0 ? 2 * volume->ixalloc : NXFFS_IXINITIAL;
+  if (nalloc > CONFIG_NXFFS_INODE_INDEX)
+    {
+      nalloc = CONFIG_NXFFS_INODE_INDEX;
+    }
+
+  index = fs_heap_realloc(volume->index,
+                          nalloc * sizeof(struct nxffs_ixentry_s));
+  if (index == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  volume->index   = index;
+  volume->ixalloc = nalloc;
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxffs_ixhash
+ *
+ * Description:
+ *   Return the hash of an inode name used to order the inode index.
+ *
+ ****************************************************************************/
+
+uint32_t nxffs_ixhash(FAR const char *name)
+{
+  uint32_t hash = 2166136261u;
+
+  /* FNV-1a */
+
+  while (*name != '\0')
+    {
+      hash ^= (uint8_t)*name++;
+      hash *= 16777619u;
+    }
+
+  return hash;
+}
+
+/****************************************************************************
+ * Name: nxffs_ixreset
+ *
+ * Description:
+ *   Empty the inode index and mark it valid.
+ *
+ ****************************************************************************/
+
+void nxffs_ixreset(FAR struct nxffs_volume_s *volume)
+{
+  volume->ixcount = 0;
+  volume->ixvalid = true;
+}
+
+/****************************************************************************
+ * Name: nxffs_ixinvalidate
+ *
+ * Description:
+ *   Mark the inode index as not usable and release its memory.
+ *
+ ****************************************************************************/
+
+void nxffs_ixinvalidate(FAR struct nxffs_volume_s *volume)
+{
+  fs_heap_free(volume->index);
+  volume->index   = NULL;
+  volume->ixcount = 0;
+  volume->ixalloc = 0;
+  volume->ixvalid = false;
+}
+
+/****************************************************************************
+ * Name: nxffs_ixfind
+ *
+ * Description:
+ *   Return the position of the first inode index entry with the given name
+ *   hash (or where such an entry would be inserted).
+ *
+ ****************************************************************************/
+
+int nxffs_ixfind(FAR struct nxffs_volume_s *volume, uint32_t hash)
+{
+  int low  = 0;
+  int high = volume->ixcount;
+  int mid;
+
+  while (low < high)
+    {
+      mid = (low + high) / 2;
+      if (volume->index[mid].hash < hash)
+        {
+          low = mid + 1;
+        }
+      else
+        {
+          high = mid;
+        }
+    }
+
+  return low;
+}
+
+/****************************************************************************
+ * Name: nxffs_ixadd
+ *
+ * Description:
+ *   Add a valid inode to the inode index.  Entries with the same hash are
+ *   kept in FLASH order so that a lookup returns the same inode that a scan
+ *   of the volume would.
+ *
+ ****************************************************************************/
+
+void nxffs_ixadd(FAR struct nxffs_volume_s *volume,
+                 FAR const struct nxffs_entry_s *entry)
+{
+  uint32_t hash;
+  int i;
+
+  if (!volume->ixvalid)
+    {
+      return;
+    }
+
+  if (nxffs_ixgrow(volume) < 0)
+    {
+      fwarn("WARNING: Inode index full, falling back to scanning\n");
+      nxffs_ixinvalidate(volume);
+      return;
+    }
+
+  hash = nxffs_ixhash(entry->name);
+  i    = nxffs_ixfind(volume, hash);
+
+  while (i < volume->ixcount && volume->index[i].hash == hash &&
+         volume->index[i].hoffset < entry->hoffset)
+    {
+      i++;
+    }
+
+  memmove(&volume->index[i + 1], &volume->index[i],
+          (volume->ixcount - i) * sizeof(struct nxffs_ixentry_s));
+
+  volume->index[i].hash    = hash;
+  volume->index[i].hoffset = entry->hoffset;
+  volume->ixcount++;
+}
+
+/****************************************************************************
+ * Name: nxffs_ixremove
+ *
+ * Description:
+ *   Remove a deleted inode from the inode index.
+ *
+ ****************************************************************************/
+
+void nxffs_ixremove(FAR struct nxffs_volume_s *volume,
+                    FAR const struct nxffs_entry_s *entry)
+{
+  uint32_t hash;
+  int i;
+
+  if (!volume->ixvalid)
+    {
+      return;
+    }
+
+  hash = nxffs_ixhash(entry->name);
+  for (i = nxffs_ixfind(volume, hash);
+       i < volume->ixcount && volume->index[i].hash == hash;
+       i++)
+    {
+      if (volume->index[i].hoffset == entry->hoffset)
+        {
+          volume->ixcount--;
+          memmove(&volume->index[i], &volume->index[i + 1],
+                  (volume->ixcount - i) * sizeof(struct nxffs_ixentry_s));
+          return;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: nxffs_ixbuild
+ *
+ * Description:
+ *   Rebuild the inode index by scanning all of the inodes on the volume,
+ *   in the same way that nxffs_findinode() scans when there is no index.
+ *
+ ****************************************************************************/
+
+void nxffs_ixbuild(FAR struct nxffs_volume_s *volume)
+{
+  struct nxffs_entry_s entry;
+  off_t offset;
+  int ret;
+
+  nxffs_ixreset(volume);
+
+  offset = volume->inoffset;
+  while (volume->ixvalid)
+    {
+      ret = nxffs_nextentry(volume, offset, &entry);
+      if (ret < 0)
+        {
+          if (ret != -ENOENT)
+            {
+              ferr("ERROR: nxffs_nextentry failed: %d\n", -ret);
+              nxffs_ixinvalidate(volume);
+            }
+
+          break;
+        }
+
+      nxffs_ixadd(volume, &entry);
+
+      offset = nxffs_inodeend(volume, &entry);
+      nxffs_freeentry(&entry);
+    }
+}
+
+#endif /* CONFIG_NXFFS_INODE_INDEX > 0 */
@@ -353,6 +353,10 @@ int nxffs_limits(FAR struct nxffs_volume_s *volume)
   int nerased;
   int ret;
 
+  /* The inode index is rebuilt as the inodes are found below */
+
+  nxffs_ixreset(volume);
+
   /* Get the offset to the first valid block on the FLASH */
 
   block = 0;
@@ -360,6 +364,7 @@ int nxffs_limits(FAR struct nxffs_volume_s *volume)
   if (ret < 0)
     {
       ferr("ERROR: Failed to find a valid block: %d\n", -ret);
+      nxffs_ixinvalidate(volume);
       return ret;
     }
 
@@ -378,6 +383,7 @@ int nxffs_limits(FAR struct nxffs_volume_s *volume)
       if (ret != -ENOENT)
         {
           ferr("ERROR: nxffs_nextentry failed: %d\n", -ret);
+          nxffs_ixinvalidate(volume);
           return ret;
         }
 
@@ -398,6 +404,7 @@ int nxffs_limits(FAR struct nxffs_volume_s *volume)
 
       /* Discard this entry and set the next offset. */
 
+      nxffs_ixadd(volume, &entry);
       offset = nxffs_inodeend(volume, &entry);
       nxffs_freeentry(&entry);
     }
@@ -406,10 +413,24 @@ int nxffs_limits(FAR struct nxffs_volume_s *volume)
 
   if (!noinodes)
     {
-      while (nxffs_nextentry(volume, offset, &entry) == OK)
+      for (; ; )
         {
+          ret = nxffs_nextentry(volume, offset, &entry);
+          if (ret < 0)
+            {
+              /* Inodes past a read failure are not in the index */
+
+              if (ret != -ENOENT)
+                {
+                  nxffs_ixinvalidate(volume);
+                }
+
+              break;
+            }
+
           /* Discard the entry and guess the next offset. */
 
+          nxffs_ixadd(volume, &entry);
           offset = nxffs_inodeend(volume, &entry);
           nxffs_freeentry(&entry);
         }
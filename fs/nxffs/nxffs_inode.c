@@ -47,8 +47,10 @@
  * Name: nxffs_rdentry
  *
  * Description:
- *   Read the inode entry at this offset.  Called only from
- *   nxffs_nextentry().
+ *   Read the inode entry at this offset.  The erase block holding the
+ *   header must already be in the volume cache, as it is when called from
+ *   nxffs_nextentry(); nxffs_findinode() loads it before reading an
+ *   indexed header.
  *
  * Input Parameters:
  *   volume - Describes the current volume.
@@ -372,6 +374,60 @@ int nxffs_findinode(FAR struct nxffs_volume_s *volume, FAR const char *name,
   off_t offset;
   int ret;
 
+#if CONFIG_NXFFS_INODE_INDEX > 0
+  /* If the index holds every inode, only the inode headers with the same
+   * name hash need to be read.
+   */
+
+  if (volume->ixvalid)
+    {
+      uint32_t hash = nxffs_ixhash(name);
+      int i;
+
+      for (i = nxffs_ixfind(volume, hash);
+           i < volume->ixcount && volume->index[i].hash == hash;
+           i++)
+        {
+          /* Load the erase block holding the header into the cache */
+
+          nxffs_ioseek(volume, volume->index[i].hoffset);
+          ret = nxffs_rdcache(volume, volume->ioblock);
+          if (ret < 0)
+            {
+              ferr("ERROR: Failed to read block %jd: %d\n",
+                   (intmax_t)volume->ioblock, -ret);
+              return ret;
+            }
+
+          ret = nxffs_rdentry(volume, volume->index[i].hoffset, entry);
+          if (ret < 0)
+            {
+              /* The index is out of step with the FLASH.  Drop it and
+               * scan.
+               */
+
+              ferr("ERROR: Bad indexed inode at %jd: %d\n",
+                   (intmax_t)volume->index[i].hoffset, -ret);
+              nxffs_ixinvalidate(volume);
+              break;
+            }
+
+          if (strcmp(name, entry->name) == 0)
+            {
+              return OK;
+            }
+
+          nxffs_freeentry(entry);
+        }
+
+      if (volume->ixvalid)
+        {
+          finfo("No inode found in the index\n");
+          return -ENOENT;
+        }
+    }
+#endif
+
   /* Start with the first valid inode that was discovered when the volume
    * was created (or modified after the last file system re-packing).
    */
@@ -1396,6 +1396,13 @@ int nxffs_pack(FAR struct nxffs_volume_s *volume)
    */
 
 start_pack:
+
+  /* Inode headers move while packing.  Drop the inode index now and
+   * rebuild it when done.
+   */
+
+  nxffs_ixinvalidate(volume);
+
   pack.ioblock     = nxffs_getblock(volume, iooffset);
   pack.iooffset    = nxffs_getoffset(volume, iooffset, pack.ioblock);
   volume->froffset = iooffset;
@@ -1611,5 +1618,6 @@ start_pack:
 errout_with_pack:
   nxffs_freeentry(&pack.src.entry);
   nxffs_freeentry(&pack.dest.entry);
+  nxffs_ixbuild(volume);
   return ret;
 }
@@ -272,8 +272,9 @@ int nxffs_reformat(FAR struct nxffs_volume_s *volume)
 {
   int ret;
 
-  /* Erase and reformat the entire volume */
+  /* Erase and reformat the entire volume.  There will be no inodes. */
 
+  nxffs_ixinvalidate(volume);
   ret = nxffs_format(volume);
   if (ret < 0)
     {
@@ -287,8 +288,10 @@ int nxffs_reformat(FAR struct nxffs_volume_s *volume)
   if (ret < 0)
     {
       ferr("ERROR: Bad block check failed: %d\n", -ret);
+      return ret;
     }
 
+  nxffs_ixreset(volume);
   return ret;
 }
 
@@ -440,6 +440,9 @@ static ssize_t memdump_read(FAR struct file *filep, FAR char *buffer,
 #if CONFIG_MM_HEAP_BIGGEST_COUNT > 0
                   "/biggest"
 #endif
+#if CONFIG_MM_HEAP_LEAK_SITES > 0
+                  "/aged <age>"
+#endif
 #if CONFIG_MM_BACKTRACE > 0
                   "/on/off"
 #endif
@@ -456,6 +459,9 @@ static ssize_t memdump_read(FAR struct file *filep, FAR char *buffer,
 #if CONFIG_MM_HEAP_BIGGEST_COUNT > 0
                   "biggest: dump allocated top n node\n"
 #endif
+#if CONFIG_MM_HEAP_LEAK_SITES > 0
+                 "aged: sum nodes older than age by call site\n"
+#endif
 #if CONFIG_MM_BACKTRACE > 0
                  "on/off: set backtrace enabled state\n"
 #endif
@@ -499,6 +505,9 @@ static ssize_t memdump_write(FAR struct file *filep, FAR const char *buffer,
 #if CONFIG_MM_BACKTRACE > 0
   FAR struct tcb_s *tcb;
 #endif
+#if CONFIG_MM_HEAP_LEAK_SITES > 0
+  unsigned long age;
+#endif
 
   DEBUGASSERT(buffer != NULL && buflen > 0);
 
@@ -604,6 +613,22 @@ static ssize_t memdump_write(FAR struct file *filep, FAR const char *buffer,
         break;
 #endif
 
+#if CONFIG_MM_HEAP_LEAK_SITES > 0
+      case 'a':
+        dump.pid = PID_MM_AGED;
+
+        /* Only the nodes allocated at least age sequence numbers ago */
+
+        age = strtoul(buffer + 4, NULL, 0);
+        if (age >= g_mm_seqno)
+          {
+            return buflen;
+          }
+
+        dump.seqmax = g_mm_seqno - age;
+        break;
+#endif
+
       case 'o':
         dump.pid = PID_MM_ORPHAN;
 #  if CONFIG_MM_BACKTRACE >= 0
@@ -425,6 +425,8 @@ void mm_notify_pressure(size_t remaining, size_t largest)
   FAR dq_entry_t *tmp;
   uint32_t flags;
 
+  mm_shrink_pressure(remaining);
+
   flags       = spin_lock_irqsave(&g_pressure_lock);
   g_remaining = remaining;
   g_largest   = largest;
@@ -648,6 +648,52 @@ static ssize_t proc_status(FAR struct proc_file_s *procfile,
                            &offset);
 
   totalsize += copysize;
+
+#ifdef CONFIG_MM_ACCOUNTING
+  /* Show the heap usage and limit of the task group */
+
+  if (tcb->group != NULL)
+    {
+      FAR struct task_group_s *group = tcb->group;
+
+      buffer    += copysize;
+      remaining -= copysize;
+
+      if (totalsize >= buflen)
+        {
+          return totalsize;
+        }
+
+      if (group->tg_datalimit.rlim_cur == RLIM_INFINITY)
+        {
+          linesize = procfs_snprintf(procfile->line, STATUS_LINELEN,
+                                     "%-12s%" PRIu32 "\n%-12s%zu\n"
+                                     "%-12sunlimited\n",
+                                     "HeapUsed:",
+                                     (uint32_t)atomic_read(
+                                       &group->tg_heapused),
+                                     "HeapPeak:", group->tg_heappeak,
+                                     "HeapLimit:");
+        }
+      else
+        {
+          linesize = procfs_snprintf(procfile->line, STATUS_LINELEN,
+                                     "%-12s%" PRIu32 "\n%-12s%zu\n"
+                                     "%-12s%" PRIu64 "\n",
+                                     "HeapUsed:",
+                                     (uint32_t)atomic_read(
+                                       &group->tg_heapused),
+                                     "HeapPeak:", group->tg_heappeak,
+                                     "HeapLimit:",
+                                     (uint64_t)group->tg_datalimit.rlim_cur);
+        }
+
+      copysize   = procfs_memcpy(procfile->line, linesize, buffer,
+                                 remaining, &offset);
+      totalsize += copysize;
+    }
+#endif
+
   return totalsize;
 }
 
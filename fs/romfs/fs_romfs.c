@@ -1227,6 +1227,9 @@ static int romfs_bind(FAR struct inode *blkdriver, FAR const void *data,
   return 0;
 
 errout_with_buffer:
+#ifdef CONFIG_FS_BLOCKCACHE
+  blockcache_invalidate(blkdriver);
+#endif
   fs_heap_free(rm->rm_devbuffer);
 
 errout_with_mount:
@@ -1295,6 +1298,13 @@ static int romfs_unbind(FAR void *handle, FAR struct inode **blkdriver,
           FAR struct inode *inode = rm->rm_blkdriver;
           if (inode)
             {
+#ifdef CONFIG_FS_BLOCKCACHE
+              if (INODE_IS_BLOCK(inode))
+                {
+                  blockcache_invalidate(inode);
+                }
+#endif
+
               if (INODE_IS_BLOCK(inode) && inode->u.i_bops->close != NULL)
                 {
                   inode->u.i_bops->close(inode);
@@ -571,7 +571,12 @@ static int romfs_hwwrite(FAR struct romfs_mountpt_s *rm, FAR uint8_t *buffer,
 
   if (inode->u.i_bops->write)
     {
+#ifdef CONFIG_FS_BLOCKCACHE
+      ret = blockcache_write(inode, buffer, sector, nsectors,
+                             rm->rm_hwsectorsize);
+#else
       ret = inode->u.i_bops->write(inode, buffer, sector, nsectors);
+#endif
     }
 
   if (ret == (ssize_t)nsectors)
@@ -769,8 +774,14 @@ int romfs_hwread(FAR struct romfs_mountpt_s *rm, FAR uint8_t *buffer,
       /* In non-XIP mode, we have to read the data from the device */
 
       FAR struct inode *inode = rm->rm_blkdriver;
+#ifdef CONFIG_FS_BLOCKCACHE
+      ssize_t nsectorsread =
+        blockcache_read(inode, buffer, sector, nsectors,
+                        rm->rm_hwsectorsize);
+#else
       ssize_t nsectorsread =
         inode->u.i_bops->read(inode, buffer, sector, nsectors);
+#endif
 
       if (nsectorsread < 0)
         {
@@ -26,6 +26,7 @@
 
 #include <nuttx/config.h>
 
+#include <sys/param.h>
 #include <sys/stat.h>
 #include <sys/statfs.h>
 #include <stdint.h>
@@ -58,6 +59,25 @@
 #  warning CONFIG_FS_TMPFS_FILE_FREEGUARD needs to be > ALLOCGUARD
 #endif
 
+#ifdef CONFIG_FS_TMPFS_DIRECTORY_HASH
+#  define TMPFS_HASH_NONE      UINT16_MAX
+#  define TMPFS_HASH_MINBUCKETS 16
+#  define TMPFS_HASH_MAXBUCKETS 32768
+#  define TMPFS_HASH_BUCKET(tdo, hash) ((hash) & ((tdo)->tdo_nbuckets - 1))
+#else
+#  define tmpfs_hash_insert(tdo, index)
+#  define tmpfs_hash_remove(tdo, index)
+#endif
+
+#ifdef CONFIG_FS_TMPFS_PAGED
+#  define TMPFS_PAGESIZE       CONFIG_FS_TMPFS_PAGESIZE
+#  define TMPFS_NPAGES(n)      (((n) + TMPFS_PAGESIZE - 1) / TMPFS_PAGESIZE)
+#  define TMPFS_NPAGES_MIN     4
+#  define tmpfs_is_paged(tfo)  ((tfo)->tfo_pages != NULL)
+#else
+#  define tmpfs_is_paged(tfo)  false
+#endif
+
 #define tmpfs_lock(fs) \
            nxrmutex_lock(&fs->tfs_lock)
 #define tmpfs_lock_object(to) \
@@ -96,8 +116,31 @@ static int  tmpfs_realloc_directory(FAR struct tmpfs_directory_s *tdo,
               unsigned int nentries);
 static int  tmpfs_realloc_file(FAR struct tmpfs_file_s *tfo,
               size_t newsize);
+#ifdef CONFIG_FS_TMPFS_PAGED
+static int  tmpfs_grow_pages(FAR struct tmpfs_file_s *tfo, size_t npages);
+static int  tmpfs_page_file(FAR struct tmpfs_file_s *tfo);
+static int  tmpfs_truncate_pages(FAR struct tmpfs_file_s *tfo,
+              size_t newsize);
+static void tmpfs_read_pages(FAR struct tmpfs_file_s *tfo,
+              FAR char *buffer, size_t pos, size_t nbytes);
+static ssize_t tmpfs_write_pages(FAR struct tmpfs_file_s *tfo,
+              FAR const char *buffer, size_t pos, size_t nbytes);
+#endif
+static int  tmpfs_resize_file(FAR struct tmpfs_file_s *tfo,
+              size_t newsize);
+static void tmpfs_free_filedata(FAR struct tmpfs_file_s *tfo);
 static void tmpfs_release_lockedobject(FAR struct tmpfs_object_s *to);
 static void tmpfs_release_lockedfile(FAR struct tmpfs_file_s *tfo);
+#ifdef CONFIG_FS_TMPFS_DIRECTORY_HASH
+static uint32_t tmpfs_hash_name(FAR const char *name, size_t len);
+static int  tmpfs_hash_rebuild(FAR struct tmpfs_directory_s *tdo);
+static FAR uint16_t *tmpfs_hash_link(FAR struct tmpfs_directory_s *tdo,
+              unsigned int index);
+static void tmpfs_hash_insert(FAR struct tmpfs_directory_s *tdo,
+              unsigned int index);
+static void tmpfs_hash_remove(FAR struct tmpfs_directory_s *tdo,
+              unsigned int index);
+#endif
 static int  tmpfs_release_file(FAR struct tmpfs_file_s *tfo);
 static int  tmpfs_find_dirent(FAR struct tmpfs_directory_s *tdo,
               FAR const char *name, size_t len);
@@ -346,6 +389,306 @@ static int tmpfs_realloc_file(FAR struct tmpfs_file_s *tfo,
   return OK;
 }
 
+#ifdef CONFIG_FS_TMPFS_PAGED
+/****************************************************************************
+ * Name: tmpfs_grow_pages
+ ****************************************************************************/
+
+static int tmpfs_grow_pages(FAR struct tmpfs_file_s *tfo, size_t npages)
+{
+  FAR uint8_t **newpages;
+  size_t newcount;
+
+  if (npages <= tfo->tfo_npages)
+    {
+      return OK;
+    }
+
+  /* Grow the page table geometrically so that appending to the file only
+   * reallocates the table (never the data) an amortized O(1) number of
+   * times.
+   */
+
+  newcount = tfo->tfo_npages * 2;
+  if (newcount < npages)
+    {
+      newcount = npages;
+    }
+
+  if (newcount > SIZE_MAX / sizeof(FAR uint8_t *))
+    {
+      return -ENOMEM;
+    }
+
+  newpages = fs_heap_realloc(tfo->tfo_pages,
+                             newcount * sizeof(FAR uint8_t *));
+  if (newpages == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  /* New entries are holes until they are written */
+
+  memset(&newpages[tfo->tfo_npages], 0,
+         (newcount - tfo->tfo_npages) * sizeof(FAR uint8_t *));
+
+  tfo->tfo_alloc += (newcount - tfo->tfo_npages) * sizeof(FAR uint8_t *);
+  tfo->tfo_npages = newcount;
+  tfo->tfo_pages  = newpages;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: tmpfs_page_file
+ *
+ * Description:
+ *   Convert a contiguous file (no larger than one page) into a paged file.
+ *   The existing data block becomes the first page.
+ *
+ ****************************************************************************/
+
+static int tmpfs_page_file(FAR struct tmpfs_file_s *tfo)
+{
+  FAR uint8_t **pages;
+  FAR uint8_t *page = NULL;
+
+  DEBUGASSERT(!tmpfs_is_paged(tfo) && tfo->tfo_size <= TMPFS_PAGESIZE);
+
+  pages = fs_heap_zalloc(TMPFS_NPAGES_MIN * sizeof(FAR uint8_t *));
+  if (pages == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  if (tfo->tfo_size > 0)
+    {
+      page = fs_heap_realloc(tfo->tfo_data, TMPFS_PAGESIZE);
+      if (page == NULL)
+        {
+          fs_heap_free(pages);
+          return -ENOMEM;
+        }
+
+      memset(&page[tfo->tfo_size], 0, TMPFS_PAGESIZE - tfo->tfo_size);
+    }
+  else
+    {
+      fs_heap_free(tfo->tfo_data);
+    }
+
+  pages[0]        = page;
+  tfo->tfo_data   = NULL;
+  tfo->tfo_pages  = pages;
+  tfo->tfo_npages = TMPFS_NPAGES_MIN;
+  tfo->tfo_alloc  = TMPFS_NPAGES_MIN * sizeof(FAR uint8_t *) +
+                    (page != NULL ? TMPFS_PAGESIZE : 0);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: tmpfs_truncate_pages
+ ****************************************************************************/
+
+static int tmpfs_truncate_pages(FAR struct tmpfs_file_s *tfo,
+                                size_t newsize)
+{
+  size_t npages = TMPFS_NPAGES(newsize);
+  size_t offset;
+  size_t i;
+  int ret;
+
+  if (newsize > tfo->tfo_size)
+    {
+      /* Growing.  Only the page table is extended; the new region is a
+       * hole until it is written.
+       */
+
+      ret = tmpfs_grow_pages(tfo, npages);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      tfo->tfo_size = newsize;
+      return OK;
+    }
+
+  /* Shrinking.  Free the pages that lie wholly beyond the new end of file
+   * and zero the tail of the last page so that a later extension reads
+   * back as zero.
+   */
+
+  for (i = npages; i < tfo->tfo_npages; i++)
+    {
+      if (tfo->tfo_pages[i] != NULL)
+        {
+          fs_heap_free(tfo->tfo_pages[i]);
+          tfo->tfo_pages[i] = NULL;
+          tfo->tfo_alloc -= TMPFS_PAGESIZE;
+        }
+    }
+
+  offset = newsize % TMPFS_PAGESIZE;
+  if (offset != 0 && tfo->tfo_pages[npages - 1] != NULL)
+    {
+      memset(&tfo->tfo_pages[npages - 1][offset], 0,
+             TMPFS_PAGESIZE - offset);
+    }
+
+  /* Drop back to an (empty) contiguous file when truncated to zero */
+
+  if (newsize == 0)
+    {
+      fs_heap_free(tfo->tfo_pages);
+      tfo->tfo_pages  = NULL;
+      tfo->tfo_npages = 0;
+      tfo->tfo_alloc  = 0;
+    }
+
+  tfo->tfo_size = newsize;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: tmpfs_read_pages
+ ****************************************************************************/
+
+static void tmpfs_read_pages(FAR struct tmpfs_file_s *tfo,
+                             FAR char *buffer, size_t pos, size_t nbytes)
+{
+  while (nbytes > 0)
+    {
+      FAR uint8_t *page = tfo->tfo_pages[pos / TMPFS_PAGESIZE];
+      size_t offset = pos % TMPFS_PAGESIZE;
+      size_t ncopy = TMPFS_PAGESIZE - offset;
+
+      if (ncopy > nbytes)
+        {
+          ncopy = nbytes;
+        }
+
+      /* Holes read back as zero */
+
+      if (page != NULL)
+        {
+          memcpy(buffer, &page[offset], ncopy);
+        }
+      else
+        {
+          memset(buffer, 0, ncopy);
+        }
+
+      buffer += ncopy;
+      pos    += ncopy;
+      nbytes -= ncopy;
+    }
+}
+
+/****************************************************************************
+ * Name: tmpfs_write_pages
+ *
+ * Description:
+ *   Copy data into a paged file, allocating pages for any holes that are
+ *   written.  The page table must already cover the region.  Returns the
+ *   number of bytes written, which may be short if memory is exhausted.
+ *
+ ****************************************************************************/
+
+static ssize_t tmpfs_write_pages(FAR struct tmpfs_file_s *tfo,
+                                 FAR const char *buffer, size_t pos,
+                                 size_t nbytes)
+{
+  ssize_t nwritten = 0;
+
+  while (nbytes > 0)
+    {
+      FAR uint8_t **pagep = &tfo->tfo_pages[pos / TMPFS_PAGESIZE];
+      size_t offset = pos % TMPFS_PAGESIZE;
+      size_t ncopy = TMPFS_PAGESIZE - offset;
+
+      if (ncopy > nbytes)
+        {
+          ncopy = nbytes;
+        }
+
+      if (*pagep == NULL)
+        {
+          *pagep = fs_heap_zalloc(TMPFS_PAGESIZE);
+          if (*pagep == NULL)
+            {
+              return nwritten > 0 ? nwritten : -ENOMEM;
+            }
+
+          tfo->tfo_alloc += TMPFS_PAGESIZE;
+        }
+
+      memcpy(&(*pagep)[offset], buffer, ncopy);
+
+      buffer   += ncopy;
+      pos      += ncopy;
+      nbytes   -= ncopy;
+      nwritten += ncopy;
+    }
+
+  return nwritten;
+}
+#endif
+
+/****************************************************************************
+ * Name: tmpfs_resize_file
+ *
+ * Description:
+ *   Change the size of a file, converting it to the paged representation
+ *   if it grows beyond one page.
+ *
+ ****************************************************************************/
+
+static int tmpfs_resize_file(FAR struct tmpfs_file_s *tfo, size_t newsize)
+{
+#ifdef CONFIG_FS_TMPFS_PAGED
+  int ret;
+
+  if (!tmpfs_is_paged(tfo) && newsize > TMPFS_PAGESIZE)
+    {
+      ret = tmpfs_page_file(tfo);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  if (tmpfs_is_paged(tfo))
+    {
+      return tmpfs_truncate_pages(tfo, newsize);
+    }
+#endif
+
+  return tmpfs_realloc_file(tfo, newsize);
+}
+
+/****************************************************************************
+ * Name: tmpfs_free_filedata
+ ****************************************************************************/
+
+static void tmpfs_free_filedata(FAR struct tmpfs_file_s *tfo)
+{
+#ifdef CONFIG_FS_TMPFS_PAGED
+  size_t i;
+
+  if (tmpfs_is_paged(tfo))
+    {
+      for (i = 0; i < tfo->tfo_npages; i++)
+        {
+          fs_heap_free(tfo->tfo_pages[i]);
+        }
+
+      fs_heap_free(tfo->tfo_pages);
+    }
+#endif
+
+  fs_heap_free(tfo->tfo_data);
+}
+
 /****************************************************************************
  * Name: tmpfs_release_lockedobject
  ****************************************************************************/
@@ -383,7 +726,7 @@ static void tmpfs_release_lockedfile(FAR struct tmpfs_file_s *tfo)
     {
       tmpfs_unlock_file(tfo);
       nxrmutex_destroy(&tfo->tfo_lock);
-      fs_heap_free(tfo->tfo_data);
+      tmpfs_free_filedata(tfo);
       fs_heap_free(tfo);
     }
 
@@ -418,6 +761,166 @@ static int tmpfs_release_file(FAR struct tmpfs_file_s *tfo)
   return OK;
 }
 
+#ifdef CONFIG_FS_TMPFS_DIRECTORY_HASH
+/****************************************************************************
+ * Name: tmpfs_hash_name
+ *
+ * Description:
+ *   FNV-1a hash of the first len characters of a name.
+ *
+ ****************************************************************************/
+
+static uint32_t tmpfs_hash_name(FAR const char *name, size_t len)
+{
+  uint32_t hash = 2166136261u;
+
+  while (len-- > 0)
+    {
+      hash ^= (uint8_t)*name++;
+      hash *= 16777619u;
+    }
+
+  return hash;
+}
+
+/****************************************************************************
+ * Name: tmpfs_hash_rebuild
+ *
+ * Description:
+ *   (Re)build the hash index of a directory with at least as many buckets
+ *   as there are entries.  On failure any existing index is retained; it
+ *   is still correct, just more heavily loaded.
+ *
+ ****************************************************************************/
+
+static int tmpfs_hash_rebuild(FAR struct tmpfs_directory_s *tdo)
+{
+  FAR uint16_t *newhash;
+  unsigned int nbuckets = TMPFS_HASH_MINBUCKETS;
+  unsigned int bucket;
+  unsigned int i;
+
+  while (nbuckets < tdo->tdo_nentries && nbuckets < TMPFS_HASH_MAXBUCKETS)
+    {
+      nbuckets <<= 1;
+    }
+
+  newhash = fs_heap_malloc(nbuckets * sizeof(uint16_t));
+  if (newhash == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  fs_heap_free(tdo->tdo_hash);
+  tdo->tdo_hash     = newhash;
+  tdo->tdo_nbuckets = nbuckets;
+
+  for (i = 0; i < nbuckets; i++)
+    {
+      newhash[i] = TMPFS_HASH_NONE;
+    }
+
+  for (i = 0; i < tdo->tdo_nentries; i++)
+    {
+      bucket = TMPFS_HASH_BUCKET(tdo, tdo->tdo_entry[i].tde_hash);
+      tdo->tdo_entry[i].tde_next = newhash[bucket];
+      newhash[bucket] = i;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: tmpfs_hash_link
+ *
+ * Description:
+ *   Return the hash chain link that refers to the entry at index.
+ *
+ ****************************************************************************/
+
+static FAR uint16_t *tmpfs_hash_link(FAR struct tmpfs_directory_s *tdo,
+                                     unsigned int index)
+{
+  FAR uint16_t *link;
+
+  link = &tdo->tdo_hash[TMPFS_HASH_BUCKET(tdo,
+                                          tdo->tdo_entry[index].tde_hash)];
+  while (*link != index)
+    {
+      DEBUGASSERT(*link != TMPFS_HASH_NONE);
+      link = &tdo->tdo_entry[*link].tde_next;
+    }
+
+  return link;
+}
+
+/****************************************************************************
+ * Name: tmpfs_hash_insert
+ *
+ * Description:
+ *   Add the newly appended entry at index to the hash index, building or
+ *   growing the index first if the directory has become large enough.
+ *
+ ****************************************************************************/
+
+static void tmpfs_hash_insert(FAR struct tmpfs_directory_s *tdo,
+                              unsigned int index)
+{
+  unsigned int bucket;
+
+  if (tdo->tdo_hash == NULL ?
+      tdo->tdo_nentries >= CONFIG_FS_TMPFS_DIRECTORY_HASHMIN :
+      tdo->tdo_nentries > tdo->tdo_nbuckets &&
+      tdo->tdo_nbuckets < TMPFS_HASH_MAXBUCKETS)
+    {
+      /* A successful rebuild already includes the new entry */
+
+      if (tmpfs_hash_rebuild(tdo) >= 0)
+        {
+          return;
+        }
+    }
+
+  if (tdo->tdo_hash != NULL)
+    {
+      bucket = TMPFS_HASH_BUCKET(tdo, tdo->tdo_entry[index].tde_hash);
+      tdo->tdo_entry[index].tde_next = tdo->tdo_hash[bucket];
+      tdo->tdo_hash[bucket] = index;
+    }
+}
+
+/****************************************************************************
+ * Name: tmpfs_hash_remove
+ *
+ * Description:
+ *   Remove the entry at index from the hash index.  The caller is about to
+ *   move the final directory entry into the vacated slot, so the link that
+ *   refers to the final entry is redirected to index as well.
+ *
+ ****************************************************************************/
+
+static void tmpfs_hash_remove(FAR struct tmpfs_directory_s *tdo,
+                              unsigned int index)
+{
+  unsigned int last = tdo->tdo_nentries - 1;
+  FAR uint16_t *link;
+
+  if (tdo->tdo_hash == NULL)
+    {
+      return;
+    }
+
+  link  = tmpfs_hash_link(tdo, index);
+  *link = tdo->tdo_entry[index].tde_next;
+
+  if (index != last)
+    {
+      link  = tmpfs_hash_link(tdo, last);
+      *link = index;
+    }
+}
+#endif
+
 /****************************************************************************
  * Name: tmpfs_find_dirent
  ****************************************************************************/
@@ -441,6 +944,29 @@ static int tmpfs_find_dirent(FAR struct tmpfs_directory_s *tdo,
         }
     }
 
+#ifdef CONFIG_FS_TMPFS_DIRECTORY_HASH
+  /* Large directories are searched through the hash index */
+
+  if (tdo->tdo_hash != NULL)
+    {
+      uint32_t hash = tmpfs_hash_name(name, len);
+
+      for (i = tdo->tdo_hash[TMPFS_HASH_BUCKET(tdo, hash)];
+           i != TMPFS_HASH_NONE;
+           i = tdo->tdo_entry[i].tde_next)
+        {
+          if (tdo->tdo_entry[i].tde_hash == hash &&
+              strncmp(tdo->tdo_entry[i].tde_name, name, len) == 0 &&
+              tdo->tdo_entry[i].tde_name[len] == 0)
+            {
+              return i;
+            }
+        }
+
+      return -ENOENT;
+    }
+#endif
+
   /* Search the list of directory entries for a match */
 
   for (i = 0;
@@ -481,6 +1007,8 @@ static int tmpfs_remove_dirent(FAR struct tmpfs_directory_s *tdo,
 
   /* Remove by replacing this entry with the final directory entry */
 
+  tmpfs_hash_remove(tdo, index);
+
   last = tdo->tdo_nentries - 1;
   if (index != last)
     {
@@ -551,7 +1079,11 @@ static int tmpfs_add_dirent(FAR struct tmpfs_directory_s *tdo,
   tde             = &tdo->tdo_entry[index];
   tde->tde_object = to;
   tde->tde_name   = newname;
+#ifdef CONFIG_FS_TMPFS_DIRECTORY_HASH
+  tde->tde_hash   = tmpfs_hash_name(newname, namelen);
+#endif
 
+  tmpfs_hash_insert(tdo, index);
   return OK;
 }
 
@@ -1189,7 +1721,14 @@ static int tmpfs_statfs_callout(FAR struct tmpfs_directory_s *tdo,
 
       tmptfo             = (FAR struct tmpfs_file_s *)to;
       tmpbuf->tsf_alloc += sizeof(struct tmpfs_file_s);
-      tmpbuf->tsf_avail += to->to_alloc - tmptfo->tfo_size;
+
+      /* Sparse paged files may be larger than their allocation */
+
+      if (to->to_alloc > tmptfo->tfo_size)
+        {
+          tmpbuf->tsf_avail += to->to_alloc - tmptfo->tfo_size;
+        }
+
       tmpbuf->tsf_files++;
     }
   else /* if (to->to_type == TMPFS_DIRECTORY) */
@@ -1206,6 +1745,12 @@ static int tmpfs_statfs_callout(FAR struct tmpfs_directory_s *tdo,
                SIZEOF_TMPFS_DIRECTORY(tmptdo->tdo_nentries);
 
       tmpbuf->tsf_alloc += sizeof(struct tmpfs_directory_s);
+#ifdef CONFIG_FS_TMPFS_DIRECTORY_HASH
+      if (tmptdo->tdo_hash != NULL)
+        {
+          tmpbuf->tsf_alloc += tmptdo->tdo_nbuckets * sizeof(uint16_t);
+        }
+#endif
       tmpbuf->tsf_avail += avail;
       tmpbuf->tsf_ffree += avail / sizeof(struct tmpfs_dirent_s);
     }
@@ -1234,6 +1779,8 @@ static int tmpfs_free_callout(FAR struct tmpfs_directory_s *tdo,
 
   /* Remove by replacing this entry with the final directory entry */
 
+  tmpfs_hash_remove(tdo, index);
+
   tde  = &tdo->tdo_entry[index];
   to   = tde->tde_object;
   last = tdo->tdo_nentries - 1;
@@ -1265,13 +1812,16 @@ static int tmpfs_free_callout(FAR struct tmpfs_directory_s *tdo,
           return TMPFS_UNLINKED;
         }
 
-      fs_heap_free(tfo->tfo_data);
+      tmpfs_free_filedata(tfo);
     }
   else /* if (to->to_type == TMPFS_DIRECTORY) */
     {
       tdo = (FAR struct tmpfs_directory_s *)to;
 
       fs_heap_free(tdo->tdo_entry);
+#ifdef CONFIG_FS_TMPFS_DIRECTORY_HASH
+      fs_heap_free(tdo->tdo_hash);
+#endif
     }
 
   /* Free the object now */
@@ -1438,7 +1988,7 @@ static int tmpfs_open(FAR struct file *filep, FAR const char *relpath,
 
           if (tfo->tfo_size > 0)
             {
-              ret = tmpfs_realloc_file(tfo, 0);
+              ret = tmpfs_resize_file(tfo, 0);
               if (ret < 0)
                 {
                   goto errout_with_filelock;
@@ -1586,6 +2136,14 @@ static ssize_t tmpfs_read(FAR struct file *filep, FAR char *buffer,
 
   /* Copy data from the memory object to the user buffer */
 
+#ifdef CONFIG_FS_TMPFS_PAGED
+  if (tmpfs_is_paged(tfo))
+    {
+      tmpfs_read_pages(tfo, buffer, startpos, nread);
+      filep->f_pos += nread;
+    }
+  else
+#endif
   if (tfo->tfo_data != NULL)
     {
       memcpy(buffer, &tfo->tfo_data[startpos], nread);
@@ -1611,6 +2169,9 @@ static ssize_t tmpfs_write(FAR struct file *filep, FAR const char *buffer,
 {
   FAR struct tmpfs_file_s *tfo;
   ssize_t nwritten;
+#ifdef CONFIG_FS_TMPFS_PAGED
+  size_t oldsize;
+#endif
   off_t startpos;
   off_t endpos;
   int ret;
@@ -1644,12 +2205,15 @@ static ssize_t tmpfs_write(FAR struct file *filep, FAR const char *buffer,
 
   nwritten = buflen;
   endpos   = startpos + buflen;
+#ifdef CONFIG_FS_TMPFS_PAGED
+  oldsize  = tfo->tfo_size;
+#endif
 
   if (endpos > tfo->tfo_size)
     {
       /* Reallocate the file to handle the write past the end of the file. */
 
-      ret = tmpfs_realloc_file(tfo, (size_t)endpos);
+      ret = tmpfs_resize_file(tfo, (size_t)endpos);
       if (ret < 0)
         {
           goto errout_with_lock;
@@ -1658,6 +2222,29 @@ static ssize_t tmpfs_write(FAR struct file *filep, FAR const char *buffer,
 
   /* Copy data from the memory object to the user buffer */
 
+#ifdef CONFIG_FS_TMPFS_PAGED
+  if (tmpfs_is_paged(tfo))
+    {
+      nwritten = tmpfs_write_pages(tfo, buffer, startpos, nwritten);
+      if (nwritten < (ssize_t)buflen)
+        {
+          /* Out of memory.  Don't leave the file extended past the data
+           * that was actually written, nor at all if nothing was.
+           */
+
+          if (nwritten <= 0)
+            {
+              tmpfs_truncate_pages(tfo, oldsize);
+              ret = nwritten < 0 ? nwritten : -ENOMEM;
+              goto errout_with_lock;
+            }
+
+          endpos = startpos + nwritten;
+          tmpfs_truncate_pages(tfo, MAX(oldsize, (size_t)endpos));
+        }
+    }
+  else
+#endif
   if (tfo->tfo_data != NULL)
     {
       memcpy(&tfo->tfo_data[startpos], buffer, nwritten);
@@ -1765,7 +2352,7 @@ static int tmpfs_unmap(FAR struct task_group_s *group,
     {
       entry->length = offset;
       tmpfs_lock_file(tfo);
-      ret = tmpfs_realloc_file(tfo, offset);
+      ret = tmpfs_resize_file(tfo, offset);
       tmpfs_unlock_file(tfo);
     }
 
@@ -1785,6 +2372,15 @@ static int tmpfs_mmap(FAR struct file *filep, FAR struct mm_map_entry_s *map)
 
   DEBUGASSERT(tfo != NULL);
 
+  /* Only contiguous files can be mapped in place.  Returning -ENOTTY lets
+   * mmap() fall back to a RAM copy of a paged file.
+   */
+
+  if (tmpfs_is_paged(tfo))
+    {
+      return -ENOTTY;
+    }
+
   if (map->offset >= 0 && map->offset < tfo->tfo_size &&
       map->length && map->offset + map->length <= tfo->tfo_size)
     {
@@ -1842,6 +2438,13 @@ static int tmpfs_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
     {
       FAR uintptr_t *ptr = (FAR uintptr_t *)arg;
 
+      /* A paged file has no single base address */
+
+      if (tmpfs_is_paged(tfo))
+        {
+          return -ENOTTY;
+        }
+
       *ptr = (uintptr_t)tfo->tfo_data;
       return OK;
     }
@@ -1970,17 +2573,17 @@ static int tmpfs_truncate(FAR struct file *filep, off_t length)
     {
       /* The size is changing.. up or down.  Reallocate the file memory. */
 
-      ret = tmpfs_realloc_file(tfo, (size_t)length);
+      ret = tmpfs_resize_file(tfo, (size_t)length);
       if (ret < 0)
         {
           goto errout_with_lock;
         }
 
       /* If the size has increased, then we need to zero the newly added
-       * memory.
+       * memory.  Paged files leave the new region as a hole instead.
        */
 
-      if (length > oldsize)
+      if (length > oldsize && !tmpfs_is_paged(tfo))
         {
           memset(&tfo->tfo_data[oldsize], 0, length - oldsize);
         }
@@ -2260,6 +2863,9 @@ static int tmpfs_unbind(FAR void *handle, FAR struct inode **blkdriver,
 
   nxrmutex_destroy(&tdo->tdo_lock);
   fs_heap_free(tdo->tdo_entry);
+#ifdef CONFIG_FS_TMPFS_DIRECTORY_HASH
+  fs_heap_free(tdo->tdo_hash);
+#endif
   fs_heap_free(tdo);
 
   nxrmutex_destroy(&fs->tfs_lock);
@@ -2426,7 +3032,7 @@ static int tmpfs_unlink(FAR struct inode *mountpt, FAR const char *relpath)
   else
     {
       nxrmutex_destroy(&tfo->tfo_lock);
-      fs_heap_free(tfo->tfo_data);
+      tmpfs_free_filedata(tfo);
       fs_heap_free(tfo);
     }
 
@@ -2569,6 +3175,9 @@ static int tmpfs_rmdir(FAR struct inode *mountpt, FAR const char *relpath)
 
   nxrmutex_destroy(&tdo->tdo_lock);
   fs_heap_free(tdo->tdo_entry);
+#ifdef CONFIG_FS_TMPFS_DIRECTORY_HASH
+  fs_heap_free(tdo->tdo_hash);
+#endif
   fs_heap_free(tdo);
 
   /* Release the reference and lock on the parent directory */
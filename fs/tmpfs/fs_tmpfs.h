@@ -70,6 +70,10 @@ struct tmpfs_dirent_s
 {
   FAR struct tmpfs_object_s *tde_object;
   FAR char *tde_name;
+#ifdef CONFIG_FS_TMPFS_DIRECTORY_HASH
+  uint32_t tde_hash;     /* Hash of tde_name */
+  uint16_t tde_next;     /* Next entry in the same hash chain */
+#endif
 };
 
 /* The generic form of a TMPFS memory object */
@@ -101,6 +105,10 @@ struct tmpfs_directory_s
 
   uint16_t tdo_nentries; /* Number of directory entries */
   FAR struct tmpfs_dirent_s *tdo_entry;
+#ifdef CONFIG_FS_TMPFS_DIRECTORY_HASH
+  uint16_t tdo_nbuckets; /* Number of hash buckets (power of two) */
+  FAR uint16_t *tdo_hash; /* First entry of each hash chain (NULL if none) */
+#endif
 };
 
 #define SIZEOF_TMPFS_DIRECTORY(n) ((n) * sizeof(struct tmpfs_dirent_s))
@@ -129,6 +137,10 @@ struct tmpfs_file_s
   uint8_t       tfo_flags; /* See TFO_FLAG_* definitions */
   size_t        tfo_size;  /* Valid file size */
   FAR uint8_t  *tfo_data;  /* File data starts here */
+#ifdef CONFIG_FS_TMPFS_PAGED
+  FAR uint8_t **tfo_pages; /* Page table of a paged file (NULL if none) */
+  size_t        tfo_npages; /* Number of entries in tfo_pages */
+#endif
 };
 
 /* This structure represents one instance of a TMPFS file system */
@@ -42,6 +42,7 @@
 #include <nuttx/list.h>
 #include <nuttx/mutex.h>
 #include <nuttx/signal.h>
+#include <nuttx/spinlock.h>
 
 #include "inode/inode.h"
 #include "fs_heap.h"
@@ -53,8 +54,9 @@
 struct epoll_node_s
 {
   struct list_node         node;
+  struct list_node         ready;   /* Link in the ready list if notified */
+  pollevent_t              revents; /* Pending events of an EPOLLET fd */
   epoll_data_t             data;
-  bool                     notified;
   struct pollfd            pfd;
   FAR struct epoll_head_s *eph;
 };
@@ -67,6 +69,12 @@ struct epoll_head_s
   int                   crefs;
   mutex_t               lock;
   sem_t                 sem;
+  spinlock_t            readylock;
+  struct list_node      ready;    /* The ready list, store all the epoll
+                                   * node notified since the last
+                                   * epoll_wait, filled by the poll callback
+                                   * and protected by readylock.
+                                   */
   struct list_node      setup;    /* The setup list, store all the setuped
                                    * epoll node.
                                    */
@@ -242,6 +250,8 @@ static int epoll_do_create(int size, int flags)
 
   epn = (FAR epoll_node_t *)(eph + 1);
 
+  spin_lock_init(&eph->readylock);
+  list_initialize(&eph->ready);
   list_initialize(&eph->setup);
   list_initialize(&eph->teardown);
   list_initialize(&eph->oneshot);
@@ -300,7 +310,6 @@ static int epoll_setup(FAR epoll_head_t *eph)
        * cover the situation several poll event pending on one fd.
        */
 
-      epn->notified    = false;
       epn->pfd.revents = 0;
       ret = poll_fdsetup(epn->pfd.fd, &epn->pfd, true);
       if (ret < 0)
@@ -322,8 +331,9 @@ static int epoll_setup(FAR epoll_head_t *eph)
  * Name: epoll_teardown
  *
  * Description:
- *   Teardown all the notifed fd and check the notified fd's event with user
- *   expected event.
+ *   Walk the ready list filled by epoll_default_cb(), teardown the notified
+ *   level triggered and oneshot fd, and report the expected events.  Edge
+ *   triggered fd stay set up, so the cost only depends on the ready fd.
  *
  * Input Parameters:
  *   eph       - The epoll head pointer
@@ -339,49 +349,107 @@ static int epoll_setup(FAR epoll_head_t *eph)
 static int epoll_teardown(FAR epoll_head_t *eph, FAR struct epoll_event *evs,
                           int maxevents)
 {
-  FAR epoll_node_t *tepn;
   FAR epoll_node_t *epn;
+  pollevent_t revents;
+  irqstate_t flags;
   int i = 0;
 
   nxmutex_lock(&eph->lock);
 
-  list_for_every_entry_safe(&eph->setup, epn, tepn, epoll_node_t, node)
+  /* Only visit the notified fd, the idle ones stay set up untouched */
+
+  while (i < maxevents)
     {
-      /* Only check the notifed fd */
+      flags = spin_lock_irqsave(&eph->readylock);
+      epn = list_remove_head_type(&eph->ready, epoll_node_t, ready);
+      if (epn == NULL)
+        {
+          spin_unlock_irqrestore(&eph->readylock, flags);
+          break;
+        }
+
+      /* An edge triggered fd stays set up, consume the events reported so
+       * far, the next change notifies it again.
+       */
 
-      if (!epn->notified)
+      if ((epn->pfd.events & (EPOLLET | EPOLLONESHOT)) == EPOLLET)
         {
+          revents = epn->revents;
+          epn->revents = 0;
+          spin_unlock_irqrestore(&eph->readylock, flags);
+
+          if (revents != 0)
+            {
+              evs[i].data     = epn->data;
+              evs[i++].events = revents;
+            }
+
           continue;
         }
 
-      /* Teradown all the notified fd */
+      spin_unlock_irqrestore(&eph->readylock, flags);
+
+      /* Teardown the notified level triggered or oneshot fd, it is set up
+       * again by the next epoll_wait to check for still pending events.
+       */
 
       poll_fdsetup(epn->pfd.fd, &epn->pfd, false);
-      list_delete(&epn->node);
 
-      if (epn->pfd.revents != 0 && i < maxevents)
+      flags = spin_lock_irqsave(&eph->readylock);
+      if (list_in_list(&epn->ready))
+        {
+          list_delete(&epn->ready);
+        }
+
+      spin_unlock_irqrestore(&eph->readylock, flags);
+
+      list_delete(&epn->node);
+      if (epn->pfd.revents != 0)
         {
           evs[i].data     = epn->data;
           evs[i++].events = epn->pfd.revents;
           if ((epn->pfd.events & EPOLLONESHOT) != 0)
             {
               list_add_tail(&eph->oneshot, &epn->node);
+              continue;
             }
-          else
-            {
-              list_add_tail(&eph->teardown, &epn->node);
-            }
-        }
-      else
-        {
-          list_add_tail(&eph->teardown, &epn->node);
         }
+
+      list_add_tail(&eph->teardown, &epn->node);
     }
 
   nxmutex_unlock(&eph->lock);
   return i;
 }
 
+/****************************************************************************
+ * Name: epoll_unready
+ *
+ * Description:
+ *   Remove a torn down epoll node from the ready list.
+ *
+ * Input Parameters:
+ *   eph - The epoll head pointer
+ *   epn - The epoll node
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+static void epoll_unready(FAR epoll_head_t *eph, FAR epoll_node_t *epn)
+{
+  irqstate_t flags;
+
+  flags = spin_lock_irqsave(&eph->readylock);
+  if (list_in_list(&epn->ready))
+    {
+      list_delete(&epn->ready);
+    }
+
+  spin_unlock_irqrestore(&eph->readylock, flags);
+}
+
 /****************************************************************************
  * Name: epoll_default_cb
  *
@@ -400,10 +468,30 @@ static int epoll_teardown(FAR epoll_head_t *eph, FAR struct epoll_event *evs,
 static void epoll_default_cb(FAR struct pollfd *fds)
 {
   FAR epoll_node_t *epn = fds->arg;
+  FAR epoll_head_t *eph = epn->eph;
+  pollevent_t revents;
+  irqstate_t flags;
   int semcount = 0;
 
-  epn->notified = true;
-  if (fds->revents != 0)
+  flags = spin_lock_irqsave(&eph->readylock);
+  revents = fds->revents;
+  if ((fds->events & (EPOLLET | EPOLLONESHOT)) == EPOLLET)
+    {
+      /* An edge triggered fd stays set up across epoll_wait, collect its
+       * events here for epoll_teardown() to consume.
+       */
+
+      epn->revents |= revents;
+      fds->revents  = 0;
+    }
+
+  if (!list_in_list(&epn->ready))
+    {
+      list_add_tail(&eph->ready, &epn->ready);
+    }
+
+  spin_unlock_irqrestore(&eph->readylock, flags);
+  if (revents != 0)
     {
       nxsem_get_value(&epn->eph->sem, &semcount);
       if (semcount < 1)
@@ -558,7 +646,7 @@ int epoll_ctl(int epfd, int op, int fd, FAR struct epoll_event *ev)
         epn = container_of(list_remove_head(&eph->free), epoll_node_t, node);
         epn->eph         = eph;
         epn->data        = ev->data;
-        epn->notified    = false;
+        epn->revents     = 0;
         epn->pfd.events  = ev->events | POLLALWAYS;
         epn->pfd.fd      = fd;
         epn->pfd.arg     = epn;
@@ -582,6 +670,7 @@ int epoll_ctl(int epfd, int op, int fd, FAR struct epoll_event *ev)
             if (epn->pfd.fd == fd)
               {
                 poll_fdsetup(fd, &epn->pfd, false);
+                epoll_unready(eph, epn);
                 list_delete(&epn->node);
                 list_add_tail(&eph->free, &epn->node);
                 goto out;
@@ -619,9 +708,10 @@ int epoll_ctl(int epfd, int op, int fd, FAR struct epoll_event *ev)
                 if (epn->pfd.events != (ev->events | POLLALWAYS))
                   {
                     poll_fdsetup(fd, &epn->pfd, false);
+                    epoll_unready(eph, epn);
 
-                    epn->notified    = false;
                     epn->data        = ev->data;
+                    epn->revents     = 0;
                     epn->pfd.events  = ev->events | POLLALWAYS;
                     epn->pfd.fd      = fd;
                     epn->pfd.revents = 0;
@@ -643,7 +733,6 @@ int epoll_ctl(int epfd, int op, int fd, FAR struct epoll_event *ev)
               {
                 if (epn->pfd.events != (ev->events | POLLALWAYS))
                   {
-                    epn->notified    = false;
                     epn->data        = ev->data;
                     epn->pfd.events  = ev->events | POLLALWAYS;
                     epn->pfd.fd      = fd;
@@ -667,7 +756,6 @@ int epoll_ctl(int epfd, int op, int fd, FAR struct epoll_event *ev)
           {
             if (epn->pfd.fd == fd)
               {
-                epn->notified    = false;
                 epn->data        = ev->data;
                 epn->pfd.events  = ev->events | POLLALWAYS;
                 epn->pfd.fd      = fd;
@@ -729,11 +817,17 @@ retry:
       goto err;
     }
 
-  /* Wait the poll ready */
+  /* Wait the poll ready, unless some edge triggered fd is still pending
+   * from the last call.
+   */
 
   nxsig_procmask(SIG_SETMASK, sigmask, &oldsigmask);
 
-  if (timeout == 0)
+  if (!list_is_empty(&eph->ready))
+    {
+      ret = OK;
+    }
+  else if (timeout == 0)
     {
       ret = -ETIMEDOUT;
     }
@@ -804,9 +898,15 @@ retry:
       goto err;
     }
 
-  /* Wait the poll ready */
+  /* Wait the poll ready, unless some edge triggered fd is still pending
+   * from the last call.
+   */
 
-  if (timeout == 0)
+  if (!list_is_empty(&eph->ready))
+    {
+      ret = OK;
+    }
+  else if (timeout == 0)
     {
       ret = -ETIMEDOUT;
     }
@@ -0,0 +1,1095 @@
+/****************************************************************************
+ * fs/vfs/fs_ioring.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/ioring.h>
+#include <sys/uio.h>
+#include <assert.h>
+#include <debug.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/mutex.h>
+#include <nuttx/mm/mm.h>
+#include <nuttx/queue.h>
+#include <nuttx/semaphore.h>
+#include <nuttx/spinlock.h>
+#include <nuttx/wqueue.h>
+#include <nuttx/net/net.h>
+
+#ifdef CONFIG_BUILD_PROTECTED
+#  include <nuttx/userspace.h>
+#endif
+
+#include "inode/inode.h"
+#include "sched/sched.h"
+#include "fs_heap.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define IORING_SIZE(sq, cq) (sizeof(struct ioring_s) + \
+                             (sq) * sizeof(struct ioring_sqe) + \
+                             (cq) * sizeof(struct ioring_cqe))
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct ioring_dev_s;
+
+/* One submitted request, executed on the ioring worker pool */
+
+struct ioring_req_s
+{
+  sq_entry_t               flink;    /* Link in the free list */
+  struct work_s            work;     /* Queued to the worker pool */
+  struct ioring_sqe        sqe;      /* Copy of the submission entry */
+  FAR struct file         *filep;    /* The file of sqe.fd */
+  FAR struct ioring_dev_s *dev;      /* The owning ring */
+  FAR sem_t               *pollsem;  /* Poll wait in progress, if any */
+  bool                     canceled; /* The ring was closed */
+  pid_t                    pid;      /* Process that owns the new fds */
+};
+
+/* This structure describes the internal state of one ring.  The geometry
+ * of the rings and the indices the kernel advances are kept here as well,
+ * since the application may overwrite the copies in struct ioring_s.
+ */
+
+struct ioring_dev_s
+{
+  mutex_t                  lock;     /* Protects the completion queue */
+  sem_t                    waitsem;  /* Wakes ioring_enter() waiters */
+  int                      nwaiters; /* Number of waiters on waitsem */
+  int                      crefs;    /* Open files and requests in flight */
+  uint32_t                 inflight; /* Requests queued or running */
+  uint32_t                 nreqs;    /* Size of reqs[] */
+  uint32_t                 sq_head;  /* Next SQE to consume */
+  uint32_t                 cq_tail;  /* Next CQE to fill */
+  uint32_t                 sq_mask;  /* Number of SQEs - 1 */
+  uint32_t                 cq_mask;  /* Number of CQEs - 1 */
+  FAR struct ioring_sqe   *sqes;     /* The submission queue */
+  FAR struct ioring_cqe   *cqes;     /* The completion queue */
+  FAR struct ioring_s     *ring;     /* Shared with the application */
+  sq_queue_t               freereqs; /* Available requests */
+  FAR struct ioring_req_s *reqs;     /* All requests */
+  FAR struct pollfd       *fds[CONFIG_FS_IORING_NPOLLWAITERS];
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int ioring_do_open(FAR struct file *filep);
+static int ioring_do_close(FAR struct file *filep);
+static int ioring_do_poll(FAR struct file *filep, FAR struct pollfd *fds,
+                          bool setup);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct file_operations g_ioring_fops =
+{
+  ioring_do_open,   /* open */
+  ioring_do_close,  /* close */
+  NULL,             /* read */
+  NULL,             /* write */
+  NULL,             /* seek */
+  NULL,             /* ioctl */
+  NULL,             /* mmap */
+  NULL,             /* truncate */
+  ioring_do_poll    /* poll */
+};
+
+static struct inode g_ioring_inode =
+{
+  NULL,                   /* i_parent */
+  NULL,                   /* i_peer */
+  NULL,                   /* i_child */
+  1,                      /* i_crefs */
+  FSNODEFLAG_TYPE_DRIVER, /* i_flags */
+  {
+    &g_ioring_fops        /* u */
+  }
+};
+
+/* The worker pool shared by all rings, created on first use */
+
+static FAR struct kwork_wqueue_s *g_ioring_wqueue;
+static mutex_t g_ioring_lock = NXMUTEX_INITIALIZER;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: ioring_release
+ *
+ * Description:
+ *   Drop one reference to the ring, freeing it with the last one.  Called
+ *   with dev->lock held, which is released.
+ *
+ ****************************************************************************/
+
+static void ioring_release(FAR struct ioring_dev_s *dev)
+{
+  if (--dev->crefs > 0)
+    {
+      nxmutex_unlock(&dev->lock);
+      return;
+    }
+
+  nxmutex_unlock(&dev->lock);
+  nxmutex_destroy(&dev->lock);
+  nxsem_destroy(&dev->waitsem);
+  kumm_free(dev->ring);
+  fs_heap_free(dev);
+}
+
+/****************************************************************************
+ * Name: ioring_cq_pending
+ *
+ * Description:
+ *   Return the number of completions the application has not consumed
+ *   yet.  cq_head is written by the application, so the result is clamped
+ *   to the size of the completion queue.
+ *
+ ****************************************************************************/
+
+static uint32_t ioring_cq_pending(FAR struct ioring_dev_s *dev)
+{
+  uint32_t pending = dev->cq_tail - dev->ring->cq_head;
+
+  return pending > dev->cq_mask + 1 ? dev->cq_mask + 1 : pending;
+}
+
+/****************************************************************************
+ * Name: ioring_access_ok
+ *
+ * Description:
+ *   Check that a buffer named in a submission entry lies in memory the
+ *   application may access: user .data/.bss or the user heap, or the user
+ *   text if the kernel only reads from it.  There is nothing to check in
+ *   the flat build.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_BUILD_PROTECTED
+static bool ioring_access_ok(FAR const void *addr, size_t len, bool write)
+{
+  uintptr_t start = (uintptr_t)addr;
+  uintptr_t end   = start + len;
+
+  if (len == 0)
+    {
+      return true;
+    }
+
+  if (end < start)
+    {
+      return false;
+    }
+
+  if (start >= USERSPACE->us_datastart && end <= USERSPACE->us_bssend)
+    {
+      return true;
+    }
+
+  if (!write && start >= USERSPACE->us_textstart &&
+      end <= USERSPACE->us_textend)
+    {
+      return true;
+    }
+
+  /* The user heap also holds the user stacks */
+
+  return mm_heapmember(USR_HEAP, (FAR void *)start) &&
+         mm_heapmember(USR_HEAP, (FAR void *)(end - 1));
+}
+#else
+#  define ioring_access_ok(addr, len, write) true
+#endif
+
+/****************************************************************************
+ * Name: ioring_complete
+ *
+ * Description:
+ *   Post one completion and wake up the waiters.  The caller holds
+ *   dev->lock.  The submission path guarantees that the completion queue
+ *   has room for every request in flight.
+ *
+ ****************************************************************************/
+
+static void ioring_complete(FAR struct ioring_dev_s *dev,
+                            FAR void *user_data, int res)
+{
+  FAR struct ioring_cqe *cqe;
+
+  cqe            = &dev->cqes[dev->cq_tail & dev->cq_mask];
+  cqe->user_data = user_data;
+  cqe->res       = res;
+  cqe->flags     = 0;
+
+  /* Publish the entry before the new tail */
+
+  UP_DMB();
+  dev->ring->cq_tail = ++dev->cq_tail;
+
+  while (dev->nwaiters > 0)
+    {
+      dev->nwaiters--;
+      nxsem_post(&dev->waitsem);
+    }
+
+  poll_notify(dev->fds, CONFIG_FS_IORING_NPOLLWAITERS, POLLIN);
+}
+
+/****************************************************************************
+ * Name: ioring_poll_wait
+ *
+ * Description:
+ *   Wait for one of 'events' on the file of a request, like poll() with an
+ *   infinite timeout, but on a file structure since the workers don't
+ *   share the fd table of the submitter.  Closing the ring ends the wait
+ *   with -ECANCELED, so that idle files can't hold on to the workers.
+ *
+ ****************************************************************************/
+
+static int ioring_poll_wait(FAR struct ioring_req_s *req, pollevent_t events)
+{
+  FAR struct ioring_dev_s *dev = req->dev;
+  struct pollfd fds;
+  bool waiting = false;
+  sem_t sem;
+  int ret;
+
+  memset(&fds, 0, sizeof(fds));
+  fds.events = events;
+  fds.arg    = &sem;
+  fds.cb     = poll_default_cb;
+
+  nxsem_init(&sem, 0, 0);
+  ret = file_poll(req->filep, &fds, true);
+  if (ret >= 0)
+    {
+      nxmutex_lock(&dev->lock);
+      if (req->canceled)
+        {
+          ret = -ECANCELED;
+        }
+      else if (fds.revents == 0)
+        {
+          req->pollsem = &sem;
+          waiting = true;
+        }
+
+      nxmutex_unlock(&dev->lock);
+
+      if (waiting)
+        {
+          ret = nxsem_wait_uninterruptible(&sem);
+
+          nxmutex_lock(&dev->lock);
+          req->pollsem = NULL;
+          if (req->canceled)
+            {
+              ret = -ECANCELED;
+            }
+
+          nxmutex_unlock(&dev->lock);
+        }
+
+      file_poll(req->filep, &fds, false);
+    }
+
+  nxsem_destroy(&sem);
+  return ret < 0 ? ret : (int)fds.revents;
+}
+
+/****************************************************************************
+ * Name: ioring_rw_wait
+ *
+ * Description:
+ *   Before READ/WRITE on a pipe, a tty or another character driver that
+ *   may block indefinitely, wait for it to become ready with
+ *   ioring_poll_wait(), so that closing the ring takes the worker back.
+ *   Regular files, block and MTD devices, files opened with O_NONBLOCK
+ *   and files without poll support are transferred right away.
+ *
+ ****************************************************************************/
+
+static int ioring_rw_wait(FAR struct ioring_req_s *req, pollevent_t events)
+{
+  FAR struct inode *inode = req->filep->f_inode;
+  int ret;
+
+  if ((req->filep->f_oflags & O_NONBLOCK) != 0 || inode == NULL ||
+      INODE_IS_MOUNTPT(inode) || INODE_IS_BLOCK(inode) ||
+      INODE_IS_MTD(inode))
+    {
+      return OK;
+    }
+
+  ret = ioring_poll_wait(req, events);
+  return ret == -ENOSYS ? OK : ret;
+}
+
+/****************************************************************************
+ * Name: ioring_rwv
+ *
+ * Description:
+ *   Perform READV or WRITEV on a kernel copy of the iovec array, so that
+ *   the application can't change it after it was checked.  The vectored
+ *   transfers only work at the current file position.
+ *
+ ****************************************************************************/
+
+static int ioring_rwv(FAR struct ioring_req_s *req)
+{
+  FAR struct ioring_sqe *sqe = &req->sqe;
+  bool isread = sqe->opcode == IORING_OP_READV;
+  FAR struct iovec *iov;
+  size_t size;
+  uint32_t i;
+  int ret;
+
+  if (sqe->off >= 0 || sqe->len == 0 ||
+      sqe->len > SIZE_MAX / sizeof(struct iovec))
+    {
+      return -EINVAL;
+    }
+
+  size = sqe->len * sizeof(struct iovec);
+  if (!ioring_access_ok(sqe->addr, size, false))
+    {
+      return -EFAULT;
+    }
+
+  iov = fs_heap_malloc(size);
+  if (iov == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  memcpy(iov, sqe->addr, size);
+  for (i = 0; i < sqe->len; i++)
+    {
+      if (!ioring_access_ok(iov[i].iov_base, iov[i].iov_len, isread))
+        {
+          fs_heap_free(iov);
+          return -EFAULT;
+        }
+    }
+
+  ret = ioring_rw_wait(req, isread ? POLLIN : POLLOUT);
+  if (ret >= 0)
+    {
+      ret = isread ? file_readv(req->filep, iov, sqe->len) :
+                     file_writev(req->filep, iov, sqe->len);
+    }
+
+  fs_heap_free(iov);
+  return ret;
+}
+
+#ifdef CONFIG_NET
+/****************************************************************************
+ * Name: ioring_accept
+ *
+ * Description:
+ *   Accept a connection and install the new socket in the fd table of the
+ *   submitter.
+ *
+ ****************************************************************************/
+
+static int ioring_accept(FAR struct ioring_req_s *req,
+                         FAR struct socket *psock)
+{
+  FAR struct ioring_sqe *sqe = &req->sqe;
+  FAR socklen_t *uaddrlen = sqe->addr2;
+  FAR struct socket *newsock;
+  FAR struct tcb_s *tcb;
+  socklen_t addrlen = 0;
+  int oflags = O_RDWR;
+  int ret;
+
+  if ((sqe->op_flags & ~(SOCK_NONBLOCK | SOCK_CLOEXEC)) != 0)
+    {
+      return -EINVAL;
+    }
+
+  /* Work on a copy of the address length, so that the application can't
+   * change it after the address buffer was checked.
+   */
+
+  if (uaddrlen != NULL)
+    {
+      if (!ioring_access_ok(uaddrlen, sizeof(*uaddrlen), true))
+        {
+          return -EFAULT;
+        }
+
+      addrlen = *uaddrlen;
+    }
+
+  if (!ioring_access_ok(sqe->addr, addrlen, true))
+    {
+      return -EFAULT;
+    }
+
+  /* Wait for a connection without blocking the worker for good */
+
+  ret = ioring_poll_wait(req, POLLIN);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  newsock = fs_heap_zalloc(sizeof(*newsock));
+  if (newsock == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  ret = psock_accept(psock, sqe->addr, uaddrlen != NULL ? &addrlen : NULL,
+                     newsock, sqe->op_flags);
+  if (ret < 0)
+    {
+      fs_heap_free(newsock);
+      return ret;
+    }
+
+  if (uaddrlen != NULL)
+    {
+      *uaddrlen = addrlen;
+    }
+
+  if (sqe->op_flags & SOCK_CLOEXEC)
+    {
+      oflags |= O_CLOEXEC;
+    }
+
+  if (sqe->op_flags & SOCK_NONBLOCK)
+    {
+      oflags |= O_NONBLOCK;
+    }
+
+  tcb = nxsched_get_tcb(req->pid);
+  ret = tcb != NULL ? sockfd_allocate_from_tcb(tcb, newsock, oflags) :
+                      -ESRCH;
+  if (ret < 0)
+    {
+      psock_close(newsock);
+      fs_heap_free(newsock);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: ioring_sockio
+ *
+ * Description:
+ *   Perform SEND or RECV.  Unless MSG_DONTWAIT is given, wait for the
+ *   socket to become ready and then transfer without blocking, so that a
+ *   closed ring can take the worker back.
+ *
+ ****************************************************************************/
+
+static int ioring_sockio(FAR struct ioring_req_s *req,
+                         FAR struct socket *psock)
+{
+  FAR struct ioring_sqe *sqe = &req->sqe;
+  bool isrecv = sqe->opcode == IORING_OP_RECV;
+  int ret;
+
+  if (!ioring_access_ok(sqe->addr, sqe->len, isrecv))
+    {
+      return -EFAULT;
+    }
+
+  for (; ; )
+    {
+      if ((sqe->op_flags & MSG_DONTWAIT) == 0)
+        {
+          ret = ioring_poll_wait(req, isrecv ? POLLIN : POLLOUT);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+
+      ret = isrecv ?
+            psock_recv(psock, sqe->addr, sqe->len,
+                       sqe->op_flags | MSG_DONTWAIT) :
+            psock_send(psock, sqe->addr, sqe->len,
+                       sqe->op_flags | MSG_DONTWAIT);
+      if (ret != -EAGAIN || (sqe->op_flags & MSG_DONTWAIT) != 0)
+        {
+          return ret;
+        }
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: ioring_execute
+ *
+ * Description:
+ *   Perform one request on the worker thread.
+ *
+ ****************************************************************************/
+
+static int ioring_execute(FAR struct ioring_req_s *req)
+{
+  FAR struct ioring_sqe *sqe = &req->sqe;
+  FAR struct file *filep = req->filep;
+#ifdef CONFIG_NET
+  FAR struct socket *psock;
+#endif
+  int ret;
+
+  switch (sqe->opcode)
+    {
+      case IORING_OP_NOP:
+        return OK;
+
+      case IORING_OP_READ:
+        if (!ioring_access_ok(sqe->addr, sqe->len, true))
+          {
+            return -EFAULT;
+          }
+
+        ret = ioring_rw_wait(req, POLLIN);
+        if (ret < 0)
+          {
+            return ret;
+          }
+
+        return sqe->off < 0 ?
+               file_read(filep, sqe->addr, sqe->len) :
+               file_pread(filep, sqe->addr, sqe->len, sqe->off);
+
+      case IORING_OP_WRITE:
+        if (!ioring_access_ok(sqe->addr, sqe->len, false))
+          {
+            return -EFAULT;
+          }
+
+        ret = ioring_rw_wait(req, POLLOUT);
+        if (ret < 0)
+          {
+            return ret;
+          }
+
+        return sqe->off < 0 ?
+               file_write(filep, sqe->addr, sqe->len) :
+               file_pwrite(filep, sqe->addr, sqe->len, sqe->off);
+
+      case IORING_OP_READV:
+      case IORING_OP_WRITEV:
+        return ioring_rwv(req);
+
+      case IORING_OP_FSYNC:
+        return file_fsync(filep);
+
+      case IORING_OP_POLL:
+        return ioring_poll_wait(req, sqe->op_flags);
+
+#ifdef CONFIG_NET
+      case IORING_OP_ACCEPT:
+      case IORING_OP_SEND:
+      case IORING_OP_RECV:
+        psock = file_socket(filep);
+        if (psock == NULL)
+          {
+            return -ENOTSOCK;
+          }
+
+        if (sqe->opcode == IORING_OP_ACCEPT)
+          {
+            return ioring_accept(req, psock);
+          }
+
+        return ioring_sockio(req, psock);
+#endif
+
+      default:
+        return -EINVAL;
+    }
+}
+
+/****************************************************************************
+ * Name: ioring_worker
+ ****************************************************************************/
+
+static void ioring_worker(FAR void *arg)
+{
+  FAR struct ioring_req_s *req = arg;
+  FAR struct ioring_dev_s *dev = req->dev;
+  int res;
+
+  res = ioring_execute(req);
+  if (req->filep != NULL)
+    {
+      fs_putfilep(req->filep);
+      req->filep = NULL;
+    }
+
+  nxmutex_lock(&dev->lock);
+  ioring_complete(dev, req->sqe.user_data, res);
+  dev->inflight--;
+  sq_addlast(&req->flink, &dev->freereqs);
+  ioring_release(dev);
+}
+
+/****************************************************************************
+ * Name: ioring_submit
+ *
+ * Description:
+ *   Consume up to 'to_submit' entries of the submission queue.  The
+ *   caller holds dev->lock.
+ *
+ ****************************************************************************/
+
+static int ioring_submit(FAR struct ioring_dev_s *dev, unsigned int to_submit)
+{
+  FAR struct ioring_req_s *req;
+  unsigned int n;
+  uint32_t avail;
+  int ret;
+
+  /* sq_tail is written by the application, never consume more than one
+   * ring's worth of entries.
+   */
+
+  avail = dev->ring->sq_tail - dev->sq_head;
+  if (avail > dev->sq_mask + 1)
+    {
+      avail = dev->sq_mask + 1;
+    }
+
+  if (to_submit > avail)
+    {
+      to_submit = avail;
+    }
+
+  for (n = 0; n < to_submit; n++)
+    {
+      /* Stop if a completion for one more request might not fit in the
+       * completion queue.
+       */
+
+      if (dev->inflight + ioring_cq_pending(dev) > dev->cq_mask)
+        {
+          break;
+        }
+
+      req = (FAR struct ioring_req_s *)sq_remfirst(&dev->freereqs);
+      if (req == NULL)
+        {
+          break;
+        }
+
+      UP_DMB();
+      memcpy(&req->sqe, &dev->sqes[dev->sq_head & dev->sq_mask],
+             sizeof(req->sqe));
+      dev->ring->sq_head = ++dev->sq_head;
+
+      req->filep    = NULL;
+      req->pollsem  = NULL;
+      req->canceled = false;
+      req->pid      = nxsched_getpid();
+      ret           = -EINVAL;
+      if (req->sqe.flags == 0)
+        {
+          ret = req->sqe.opcode == IORING_OP_NOP ? OK :
+                fs_getfilep(req->sqe.fd, &req->filep);
+        }
+
+      if (ret >= 0)
+        {
+          dev->inflight++;
+          dev->crefs++;
+          ret = work_queue_wq(g_ioring_wqueue, &req->work, ioring_worker,
+                              req, 0);
+          if (ret < 0)
+            {
+              dev->inflight--;
+              dev->crefs--;
+              if (req->filep != NULL)
+                {
+                  fs_putfilep(req->filep);
+                  req->filep = NULL;
+                }
+            }
+        }
+
+      /* Report the failure to start through the completion queue */
+
+      if (ret < 0)
+        {
+          ioring_complete(dev, req->sqe.user_data, ret);
+          sq_addlast(&req->flink, &dev->freereqs);
+        }
+    }
+
+  return n;
+}
+
+/****************************************************************************
+ * Name: ioring_do_open
+ ****************************************************************************/
+
+static int ioring_do_open(FAR struct file *filep)
+{
+  FAR struct ioring_dev_s *dev = filep->f_priv;
+  int ret;
+
+  ret = nxmutex_lock(&dev->lock);
+  if (ret >= 0)
+    {
+      dev->crefs++;
+      nxmutex_unlock(&dev->lock);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: ioring_do_close
+ *
+ * Description:
+ *   Drop a reference to the ring.  With the last open file, the requests
+ *   not started yet are canceled and the running ones that wait for a file
+ *   or socket to become ready are woken up to complete with -ECANCELED.
+ *   The running ones keep the ring alive until they complete.
+ *
+ ****************************************************************************/
+
+static int ioring_do_close(FAR struct file *filep)
+{
+  FAR struct ioring_dev_s *dev = filep->f_priv;
+  FAR struct ioring_req_s *req;
+  uint32_t i;
+
+  nxmutex_lock(&dev->lock);
+  if (dev->crefs == dev->inflight + 1)
+    {
+      for (i = 0; i < dev->nreqs; i++)
+        {
+          req = &dev->reqs[i];
+          if (work_cancel_wq(g_ioring_wqueue, &req->work) == OK)
+            {
+              if (req->filep != NULL)
+                {
+                  fs_putfilep(req->filep);
+                  req->filep = NULL;
+                }
+
+              sq_addlast(&req->flink, &dev->freereqs);
+              dev->inflight--;
+              dev->crefs--;
+            }
+          else
+            {
+              req->canceled = true;
+              if (req->pollsem != NULL)
+                {
+                  nxsem_post(req->pollsem);
+                }
+            }
+        }
+    }
+
+  ioring_release(dev);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: ioring_do_poll
+ *
+ * Description:
+ *   The ring is readable while completions are pending.
+ *
+ ****************************************************************************/
+
+static int ioring_do_poll(FAR struct file *filep, FAR struct pollfd *fds,
+                          bool setup)
+{
+  FAR struct ioring_dev_s *dev = filep->f_priv;
+  int ret;
+  int i;
+
+  ret = nxmutex_lock(&dev->lock);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (!setup)
+    {
+      FAR struct pollfd **slot = (FAR struct pollfd **)fds->priv;
+
+      *slot     = NULL;
+      fds->priv = NULL;
+      goto out;
+    }
+
+  for (i = 0; i < CONFIG_FS_IORING_NPOLLWAITERS; i++)
+    {
+      if (dev->fds[i] == NULL)
+        {
+          dev->fds[i] = fds;
+          fds->priv   = &dev->fds[i];
+          break;
+        }
+    }
+
+  if (i >= CONFIG_FS_IORING_NPOLLWAITERS)
+    {
+      fds->priv = NULL;
+      ret       = -EBUSY;
+      goto out;
+    }
+
+  if (ioring_cq_pending(dev) > 0)
+    {
+      poll_notify(&fds, 1, POLLIN);
+    }
+
+out:
+  nxmutex_unlock(&dev->lock);
+  return ret;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: ioring_setup
+ *
+ * Description:
+ *   Create a ring of at least 'entries' submission queue entries (rounded
+ *   up to a power of two) and twice as many completion queue entries.
+ *
+ * Returned Value:
+ *   A file descriptor for the ring on success, with the shared rings
+ *   described in 'p'; -1 with errno set on failure.
+ *
+ ****************************************************************************/
+
+int ioring_setup(unsigned int entries, FAR struct ioring_params *p)
+{
+  FAR struct ioring_dev_s *dev;
+  FAR struct ioring_s *ring;
+  uint32_t sqsize;
+  uint32_t i;
+  int ret;
+
+  if (entries == 0 || entries > CONFIG_FS_IORING_MAXENTRIES || p == NULL)
+    {
+      ret = -EINVAL;
+      goto errout;
+    }
+
+  for (sqsize = 1; sqsize < entries; sqsize <<= 1)
+    {
+    }
+
+  /* Start the worker pool shared by all rings */
+
+  nxmutex_lock(&g_ioring_lock);
+  if (g_ioring_wqueue == NULL)
+    {
+      g_ioring_wqueue = work_queue_create("ioring",
+                                          CONFIG_FS_IORING_PRIORITY, NULL,
+                                          CONFIG_FS_IORING_STACKSIZE,
+                                          CONFIG_FS_IORING_NWORKERS);
+    }
+
+  nxmutex_unlock(&g_ioring_lock);
+  if (g_ioring_wqueue == NULL)
+    {
+      ret = -ENOMEM;
+      goto errout;
+    }
+
+  /* At most one request in flight per completion queue entry */
+
+  dev = fs_heap_zalloc(sizeof(*dev) +
+                       2 * sqsize * sizeof(struct ioring_req_s));
+  if (dev == NULL)
+    {
+      ret = -ENOMEM;
+      goto errout;
+    }
+
+  /* The rings live in memory the application can access */
+
+  ring = kumm_zalloc(IORING_SIZE(sqsize, 2 * sqsize));
+  if (ring == NULL)
+    {
+      ret = -ENOMEM;
+      goto errout_with_dev;
+    }
+
+  ring->sq_mask = sqsize - 1;
+  ring->cq_mask = 2 * sqsize - 1;
+  ring->sqes    = (FAR struct ioring_sqe *)(ring + 1);
+  ring->cqes    = (FAR struct ioring_cqe *)(ring->sqes + sqsize);
+
+  nxmutex_init(&dev->lock);
+  nxsem_init(&dev->waitsem, 0, 0);
+  dev->crefs   = 1;
+  dev->ring    = ring;
+  dev->sq_mask = ring->sq_mask;
+  dev->cq_mask = ring->cq_mask;
+  dev->sqes    = ring->sqes;
+  dev->cqes    = ring->cqes;
+  dev->nreqs   = 2 * sqsize;
+  dev->reqs  = (FAR struct ioring_req_s *)(dev + 1);
+  for (i = 0; i < dev->nreqs; i++)
+    {
+      dev->reqs[i].dev = dev;
+      sq_addlast(&dev->reqs[i].flink, &dev->freereqs);
+    }
+
+  ret = file_allocate(&g_ioring_inode, O_RDWR, 0, dev, 0, true);
+  if (ret < 0)
+    {
+      goto errout_with_ring;
+    }
+
+  p->sq_entries = sqsize;
+  p->cq_entries = 2 * sqsize;
+  p->ring       = ring;
+  return ret;
+
+errout_with_ring:
+  nxsem_destroy(&dev->waitsem);
+  nxmutex_destroy(&dev->lock);
+  kumm_free(ring);
+errout_with_dev:
+  fs_heap_free(dev);
+errout:
+  set_errno(-ret);
+  return ERROR;
+}
+
+/****************************************************************************
+ * Name: ioring_enter
+ *
+ * Description:
+ *   Submit up to 'to_submit' new entries of the submission queue and, with
+ *   IORING_ENTER_GETEVENTS, wait until at least 'min_complete' completions
+ *   are pending.  The wait ends early if fewer requests are in flight than
+ *   needed.
+ *
+ * Returned Value:
+ *   The number of entries submitted; -1 with errno set on failure.
+ *
+ ****************************************************************************/
+
+int ioring_enter(int fd, unsigned int to_submit, unsigned int min_complete,
+                 unsigned int flags)
+{
+  FAR struct ioring_dev_s *dev;
+  FAR struct file *filep;
+  uint32_t pending;
+  int submitted;
+  int ret;
+
+  ret = fs_getfilep(fd, &filep);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  if (filep->f_inode != &g_ioring_inode)
+    {
+      ret = -EBADF;
+      goto errout_with_filep;
+    }
+
+  dev = filep->f_priv;
+  ret = nxmutex_lock(&dev->lock);
+  if (ret < 0)
+    {
+      goto errout_with_filep;
+    }
+
+  submitted = ioring_submit(dev, to_submit);
+
+  /* Wait for the completions, all posted under dev->lock */
+
+  while ((flags & IORING_ENTER_GETEVENTS) != 0)
+    {
+      pending = ioring_cq_pending(dev);
+      if (pending >= min_complete || pending + dev->inflight < min_complete)
+        {
+          break;
+        }
+
+      dev->nwaiters++;
+      nxmutex_unlock(&dev->lock);
+      ret = nxsem_wait(&dev->waitsem);
+      nxmutex_lock(&dev->lock);
+      if (ret < 0)
+        {
+          if (dev->nwaiters > 0)
+            {
+              dev->nwaiters--;
+            }
+
+          if (submitted == 0)
+            {
+              nxmutex_unlock(&dev->lock);
+              goto errout_with_filep;
+            }
+
+          break;
+        }
+    }
+
+  nxmutex_unlock(&dev->lock);
+  fs_putfilep(filep);
+  return submitted;
+
+errout_with_filep:
+  fs_putfilep(filep);
+errout:
+  set_errno(-ret);
+  return ERROR;
+}
@@ -196,6 +196,10 @@ next_subdir:
   /* Copy the inode state from the old inode to the newly allocated inode */
 
   newinode->i_child   = oldinode->i_child;   /* Link to lower level inode */
+#ifdef CONFIG_FS_INODE_HASH
+  newinode->i_hash    = oldinode->i_hash;    /* Index of the children */
+  oldinode->i_hash    = NULL;
+#endif
   newinode->i_flags   = oldinode->i_flags;   /* Flags for inode */
   newinode->u.i_ops   = oldinode->u.i_ops;   /* Inode operations */
 #ifdef CONFIG_PSEUDOFS_ATTRIBUTES
@@ -242,6 +246,7 @@ next_subdir:
 
   oldinode->i_child  = NULL;
   oldinode->i_parent = NULL;
+  inode_cache_invalidate();
   ret = OK;
 
 errout_with_lock:
@@ -28,6 +28,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <string.h>
+#include <sys/param.h>
 #include <sys/stat.h>
 #include <sys/statfs.h>
 #include <nuttx/mutex.h>
@@ -39,6 +40,14 @@
 
 #include "fs_heap.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_ZIPFS_CHECKPOINT_INTERVAL
+#  define CONFIG_ZIPFS_CHECKPOINT_INTERVAL 0
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -56,11 +65,52 @@ struct zipfs_mountpt_s
   char abspath[1];
 };
 
+#if CONFIG_ZIPFS_CHECKPOINT_INTERVAL > 0
+/* The inflate state saved at a deflate block boundary.  Inflation can be
+ * restarted here with the bit offset and the history of the last 32 KiB
+ * of output.
+ */
+
+struct zipfs_checkpoint_s
+{
+  off_t uoffset;             /* Offset in the uncompressed data */
+  off_t coffset;             /* Offset of the next byte of compressed data */
+  int bits;                  /* Bits of the previous byte still unused */
+  uInt wsize;                /* Length of the history */
+  FAR uint8_t *window;       /* History of the uncompressed data */
+};
+
+/* A chunk of uncompressed data */
+
+struct zipfs_chunk_s
+{
+  off_t offset;              /* Offset in the uncompressed data */
+  size_t len;                /* Valid data length (zero means none) */
+  uint32_t lru;              /* Time of the last access */
+  FAR uint8_t *buffer;       /* Uncompressed data */
+};
+#endif
+
 struct zipfs_file_s
 {
   unzFile uf;
   mutex_t lock;
   FAR char *seekbuf;
+#if CONFIG_ZIPFS_CHECKPOINT_INTERVAL > 0
+  int method;                /* Compression method, or -1 to use minizip */
+  struct file zfile;         /* The archive, for reading the member data */
+  off_t datapos;             /* Archive offset of the member data */
+  off_t csize;               /* Compressed size of the member */
+  off_t usize;               /* Uncompressed size of the member */
+  off_t inpos;               /* Compressed data read so far */
+  off_t outpos;              /* Uncompressed data inflated so far */
+  z_stream strm;             /* Raw inflate state */
+  FAR struct zipfs_checkpoint_s *cps;
+  int ncps;
+  off_t cpinterval;          /* Spacing of the checkpoints */
+  uint32_t clock;
+  struct zipfs_chunk_s chunks[CONFIG_ZIPFS_CACHE_NCHUNKS];
+#endif
   char relpath[1];
 };
 
@@ -243,6 +293,406 @@ static int zipfs_convert_result(int ziperr)
     }
 }
 
+#if CONFIG_ZIPFS_CHECKPOINT_INTERVAL > 0
+static int zipfs_raw_open(FAR struct zipfs_mountpt_s *fs,
+                          FAR struct zipfs_file_s *fp)
+{
+  unz_file_info64 file_info;
+  int ret;
+
+  fp->method = -1;
+
+  ret = unzGetCurrentFileInfo64(fp->uf, &file_info,
+                                NULL, 0, NULL, 0, NULL, 0);
+  ret = zipfs_convert_result(ret);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  /* Leave encrypted members and unknown methods to minizip */
+
+  if ((file_info.flag & 1) != 0 ||
+      (file_info.compression_method != 0 &&
+       file_info.compression_method != Z_DEFLATED))
+    {
+      return OK;
+    }
+
+  ret = file_open(&fp->zfile, fs->abspath, O_RDONLY);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (file_info.compression_method == Z_DEFLATED)
+    {
+      fp->seekbuf = fs_heap_malloc(CONFIG_ZIPFS_SEEK_BUFSIZE);
+      if (fp->seekbuf == NULL)
+        {
+          file_close(&fp->zfile);
+          return -ENOMEM;
+        }
+
+      if (inflateInit2(&fp->strm, -MAX_WBITS) != Z_OK)
+        {
+          fs_heap_free(fp->seekbuf);
+          fp->seekbuf = NULL;
+          file_close(&fp->zfile);
+          return -ENOMEM;
+        }
+    }
+
+  fp->datapos = unzGetCurrentFileZStreamPos64(fp->uf);
+  fp->csize   = file_info.compressed_size;
+  fp->usize   = file_info.uncompressed_size;
+  fp->method  = file_info.compression_method;
+  fp->cpinterval = CONFIG_ZIPFS_CHECKPOINT_INTERVAL;
+  return OK;
+}
+
+static void zipfs_raw_close(FAR struct zipfs_file_s *fp)
+{
+  int i;
+
+  if (fp->method < 0)
+    {
+      return;
+    }
+
+  if (fp->method == Z_DEFLATED)
+    {
+      inflateEnd(&fp->strm);
+    }
+
+  for (i = 0; i < fp->ncps; i++)
+    {
+      fs_heap_free(fp->cps[i].window);
+    }
+
+  for (i = 0; i < CONFIG_ZIPFS_CACHE_NCHUNKS; i++)
+    {
+      fs_heap_free(fp->chunks[i].buffer);
+    }
+
+  fs_heap_free(fp->cps);
+  file_close(&fp->zfile);
+}
+
+/* Refill the inflate input buffer (the seek buffer) from the archive */
+
+static int zipfs_raw_input(FAR struct zipfs_file_s *fp)
+{
+  ssize_t nread;
+  size_t len;
+
+  len = MIN(CONFIG_ZIPFS_SEEK_BUFSIZE, fp->csize - fp->inpos);
+  if (len == 0)
+    {
+      return -EIO;
+    }
+
+  nread = file_pread(&fp->zfile, fp->seekbuf, len,
+                     fp->datapos + fp->inpos);
+  if (nread <= 0)
+    {
+      return nread < 0 ? nread : -EIO;
+    }
+
+  fp->inpos         += nread;
+  fp->strm.next_in   = (FAR Bytef *)fp->seekbuf;
+  fp->strm.avail_in  = nread;
+  return OK;
+}
+
+/* Save a checkpoint if the inflate stream is at a block boundary and far
+ * enough past the last one.  Once the table is full, every other
+ * checkpoint is dropped and the spacing doubled, so the checkpoints keep
+ * covering the whole member however large it is.
+ */
+
+static void zipfs_checkpoint_add(FAR struct zipfs_file_s *fp)
+{
+  FAR struct zipfs_checkpoint_s *cp;
+  off_t last;
+  int i;
+
+  if ((fp->strm.data_type & 128) == 0 || (fp->strm.data_type & 64) != 0)
+    {
+      return;
+    }
+
+  last = fp->ncps > 0 ? fp->cps[fp->ncps - 1].uoffset : 0;
+  if (fp->outpos < last + fp->cpinterval)
+    {
+      return;
+    }
+
+  if (fp->ncps >= CONFIG_ZIPFS_CHECKPOINT_MAX)
+    {
+      for (i = 0; i < fp->ncps; i++)
+        {
+          if ((i & 1) != 0)
+            {
+              fs_heap_free(fp->cps[i].window);
+            }
+          else
+            {
+              fp->cps[i / 2] = fp->cps[i];
+            }
+        }
+
+      fp->ncps = (fp->ncps + 1) / 2;
+      fp->cpinterval *= 2;
+
+      last = fp->cps[fp->ncps - 1].uoffset;
+      if (fp->outpos < last + fp->cpinterval)
+        {
+          return;
+        }
+    }
+
+  if (fp->cps == NULL)
+    {
+      fp->cps = fs_heap_zalloc(CONFIG_ZIPFS_CHECKPOINT_MAX *
+                               sizeof(struct zipfs_checkpoint_s));
+      if (fp->cps == NULL)
+        {
+          return;
+        }
+    }
+
+  cp = &fp->cps[fp->ncps];
+  if (inflateGetDictionary(&fp->strm, NULL, &cp->wsize) != Z_OK)
+    {
+      return;
+    }
+
+  cp->window = fs_heap_malloc(cp->wsize);
+  if (cp->window == NULL)
+    {
+      return;
+    }
+
+  inflateGetDictionary(&fp->strm, cp->window, &cp->wsize);
+  cp->uoffset = fp->outpos;
+  cp->coffset = fp->inpos - fp->strm.avail_in;
+  cp->bits    = fp->strm.data_type & 7;
+  fp->ncps++;
+}
+
+/* Restart inflation at a checkpoint, or at the start if cp is NULL */
+
+static int zipfs_checkpoint_restore(FAR struct zipfs_file_s *fp,
+                                    FAR struct zipfs_checkpoint_s *cp)
+{
+  uint8_t byte;
+  ssize_t nread;
+
+  inflateReset(&fp->strm);
+  fp->strm.avail_in = 0;
+
+  if (cp == NULL)
+    {
+      fp->inpos  = 0;
+      fp->outpos = 0;
+      return OK;
+    }
+
+  if (cp->bits != 0)
+    {
+      /* The stream resumes inside the previous byte */
+
+      nread = file_pread(&fp->zfile, &byte, 1,
+                         fp->datapos + cp->coffset - 1);
+      if (nread != 1)
+        {
+          return nread < 0 ? nread : -EIO;
+        }
+
+      inflatePrime(&fp->strm, cp->bits, byte >> (8 - cp->bits));
+    }
+
+  inflateSetDictionary(&fp->strm, cp->window, cp->wsize);
+  fp->inpos  = cp->coffset;
+  fp->outpos = cp->uoffset;
+  return OK;
+}
+
+/* Inflate up to len bytes at the current stream position */
+
+static ssize_t zipfs_inflate(FAR struct zipfs_file_s *fp,
+                             FAR uint8_t *buf, size_t len)
+{
+  uInt avail;
+  int ret;
+
+  fp->strm.next_out  = buf;
+  fp->strm.avail_out = len;
+
+  while (fp->strm.avail_out > 0)
+    {
+      if (fp->strm.avail_in == 0)
+        {
+          ret = zipfs_raw_input(fp);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+
+      /* Stop at each block boundary so that checkpoints can be taken */
+
+      avail = fp->strm.avail_out;
+      ret = inflate(&fp->strm, Z_BLOCK);
+      fp->outpos += avail - fp->strm.avail_out;
+
+      if (ret == Z_STREAM_END)
+        {
+          break;
+        }
+      else if (ret != Z_OK)
+        {
+          return ret == Z_MEM_ERROR ? -ENOMEM : -EIO;
+        }
+
+      zipfs_checkpoint_add(fp);
+    }
+
+  return len - fp->strm.avail_out;
+}
+
+/* Read the uncompressed data at offset pos of the member */
+
+static ssize_t zipfs_raw_fill(FAR struct zipfs_file_s *fp, off_t pos,
+                              FAR uint8_t *buf, size_t len)
+{
+  FAR struct zipfs_checkpoint_s *cp = NULL;
+  ssize_t ret;
+  int i;
+
+  len = MIN(len, fp->usize - pos);
+  if (fp->method == 0)
+    {
+      return file_pread(&fp->zfile, buf, len, fp->datapos + pos);
+    }
+
+  /* Find the last checkpoint at or before pos and restart from it if the
+   * stream is past pos or the checkpoint is nearer than the stream.
+   */
+
+  for (i = 0; i < fp->ncps && fp->cps[i].uoffset <= pos; i++)
+    {
+      cp = &fp->cps[i];
+    }
+
+  if (pos < fp->outpos || (cp != NULL && cp->uoffset > fp->outpos))
+    {
+      ret = zipfs_checkpoint_restore(fp, cp);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  /* Inflate forward to pos, using the caller's buffer as scratch */
+
+  while (fp->outpos < pos)
+    {
+      ret = zipfs_inflate(fp, buf, MIN(len, pos - fp->outpos));
+      if (ret <= 0)
+        {
+          return ret < 0 ? ret : -EIO;
+        }
+    }
+
+  return zipfs_inflate(fp, buf, len);
+}
+
+static ssize_t zipfs_raw_read(FAR struct file *filep, FAR char *buffer,
+                              size_t buflen)
+{
+  FAR struct zipfs_file_s *fp = filep->f_priv;
+  FAR struct zipfs_chunk_s *chunk;
+  off_t pos = filep->f_pos;
+  size_t nread = 0;
+  ssize_t ret = 0;
+  off_t base;
+  size_t n;
+  int i;
+
+  while (nread < buflen && pos < fp->usize)
+    {
+      /* Find the chunk holding pos, or recycle the least recently used
+       * chunk for it.
+       */
+
+      base  = pos - pos % CONFIG_ZIPFS_CACHE_CHUNKSIZE;
+      chunk = &fp->chunks[0];
+
+      for (i = 0; i < CONFIG_ZIPFS_CACHE_NCHUNKS; i++)
+        {
+          if (fp->chunks[i].len > 0 && fp->chunks[i].offset == base)
+            {
+              chunk = &fp->chunks[i];
+              break;
+            }
+          else if (fp->chunks[i].lru < chunk->lru)
+            {
+              chunk = &fp->chunks[i];
+            }
+        }
+
+      if (chunk->len == 0 || chunk->offset != base)
+        {
+          chunk->len = 0;
+          if (chunk->buffer == NULL)
+            {
+              chunk->buffer = fs_heap_malloc(CONFIG_ZIPFS_CACHE_CHUNKSIZE);
+              if (chunk->buffer == NULL)
+                {
+                  ret = -ENOMEM;
+                  break;
+                }
+            }
+
+          ret = zipfs_raw_fill(fp, base, chunk->buffer,
+                               CONFIG_ZIPFS_CACHE_CHUNKSIZE);
+          if (ret <= 0)
+            {
+              ret = ret < 0 ? ret : -EIO;
+              break;
+            }
+
+          chunk->offset = base;
+          chunk->len    = ret;
+        }
+
+      if (pos - base >= chunk->len)
+        {
+          /* The member data ended before its recorded size */
+
+          ret = -EIO;
+          break;
+        }
+
+      n = MIN(chunk->len - (pos - base), buflen - nread);
+      memcpy(buffer + nread, chunk->buffer + (pos - base), n);
+      chunk->lru = ++fp->clock;
+      nread += n;
+      pos   += n;
+    }
+
+  if (nread == 0 && ret < 0)
+    {
+      return ret;
+    }
+
+  filep->f_pos = pos;
+  return nread;
+}
+#endif
+
 static int zipfs_open(FAR struct file *filep, FAR const char *relpath,
                       int oflags, mode_t mode)
 {
@@ -252,7 +702,7 @@ static int zipfs_open(FAR struct file *filep, FAR const char *relpath,
 
   DEBUGASSERT(fs != NULL);
 
-  fp = fs_heap_malloc(sizeof(*fp) + strlen(relpath));
+  fp = fs_heap_zalloc(sizeof(*fp) + strlen(relpath));
   if (fp == NULL)
     {
       return -ENOMEM;
@@ -283,9 +733,16 @@ static int zipfs_open(FAR struct file *filep, FAR const char *relpath,
       goto err_with_zip;
     }
 
+#if CONFIG_ZIPFS_CHECKPOINT_INTERVAL > 0
+  ret = zipfs_raw_open(fs, fp);
+  if (ret < 0)
+    {
+      goto err_with_zip;
+    }
+#endif
+
   if (ret == OK)
     {
-      fp->seekbuf = NULL;
       strcpy(fp->relpath, relpath);
       filep->f_priv = fp;
     }
@@ -307,6 +764,10 @@ static int zipfs_close(FAR struct file *filep)
   FAR struct zipfs_file_s *fp = filep->f_priv;
   int ret;
 
+#if CONFIG_ZIPFS_CHECKPOINT_INTERVAL > 0
+  zipfs_raw_close(fp);
+#endif
+
   ret = zipfs_convert_result(unzClose(fp->uf));
   nxmutex_destroy(&fp->lock);
   fs_heap_free(fp->seekbuf);
@@ -321,6 +782,15 @@ static ssize_t zipfs_read(FAR struct file *filep, FAR char *buffer,
   ssize_t ret;
 
   nxmutex_lock(&fp->lock);
+#if CONFIG_ZIPFS_CHECKPOINT_INTERVAL > 0
+  if (fp->method >= 0)
+    {
+      ret = zipfs_raw_read(filep, buffer, buflen);
+      nxmutex_unlock(&fp->lock);
+      return ret;
+    }
+#endif
+
   ret = zipfs_convert_result(unzReadCurrentFile(fp->uf, buffer, buflen));
   if (ret > 0)
     {
@@ -398,6 +868,24 @@ static off_t zipfs_seek(FAR struct file *filep, off_t offset,
         goto err_with_lock;
     }
 
+#if CONFIG_ZIPFS_CHECKPOINT_INTERVAL > 0
+  if (fp->method >= 0)
+    {
+      /* Reads position the inflate stream themselves */
+
+      if (offset < 0)
+        {
+          ret = -EINVAL;
+        }
+      else
+        {
+          filep->f_pos = offset;
+        }
+
+      goto err_with_lock;
+    }
+#endif
+
   if (filep->f_pos == offset)
     {
       goto err_with_lock;
@@ -2995,6 +2995,27 @@ int up_debugpoint_remove(int type, FAR void *addr, size_t size);
 
 #endif
 
+/****************************************************************************
+ * Name: up_mprotect
+ *
+ * Description:
+ *   Change the access permissions of a range of memory.
+ *
+ * Input Parameters:
+ *   addr   - The start address, aligned to the protection granule.
+ *   size   - The size of the range, a multiple of the protection granule.
+ *   access - True to allow read and write access, false to forbid any
+ *            access.
+ *
+ * Returned Value:
+ *  Zero on success; a negated errno value on failure
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_ARCH_HAVE_MPROTECT
+int up_mprotect(FAR void *addr, size_t size, bool access);
+#endif
+
 /****************************************************************************
  * Name: up_alloc_irq_msi
  *
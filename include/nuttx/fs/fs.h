@@ -420,6 +420,10 @@ struct inode
   struct timespec   i_ctime;    /* Time of last status change */
 #endif
   FAR void         *i_private;  /* Per inode driver private data */
+#ifdef CONFIG_FS_INODE_HASH
+  FAR struct inode *i_hnext;    /* Link in the parent's child index */
+  FAR struct inode_hash_s *i_hash; /* Index of the children, if many */
+#endif
   char              i_name[1];  /* Name of inode (variable) */
 };
 
@@ -1357,6 +1361,54 @@ int close_blockdriver(FAR struct inode *inode);
 int find_blockdriver(FAR const char *pathname, int mountflags,
                      FAR struct inode **ppinode);
 
+/****************************************************************************
+ * Name: blockcache_read, blockcache_write
+ *
+ * Description:
+ *   Read or write sectors of a block driver through the shared block
+ *   cache.  The arguments and return value are those of the block driver
+ *   read() and write() methods, plus the sector size of the device.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_BLOCKCACHE
+ssize_t blockcache_read(FAR struct inode *inode, FAR unsigned char *buffer,
+                        blkcnt_t start_sector, unsigned int nsectors,
+                        size_t sectsize);
+ssize_t blockcache_write(FAR struct inode *inode,
+                         FAR const unsigned char *buffer,
+                         blkcnt_t start_sector, unsigned int nsectors,
+                         size_t sectsize);
+
+/****************************************************************************
+ * Name: blockcache_flush
+ *
+ * Description:
+ *   Write the dirty cached sectors of a block driver (or of all block
+ *   drivers if inode is NULL) to the media.
+ *
+ * Returned Value:
+ *   Zero on success or a negated errno on failure.
+ *
+ ****************************************************************************/
+
+int blockcache_flush(FAR struct inode *inode);
+
+/****************************************************************************
+ * Name: blockcache_invalidate
+ *
+ * Description:
+ *   Flush and drop all cached sectors of a block driver.  Users of the
+ *   cache call this when they close the block driver.
+ *
+ * Returned Value:
+ *   Zero on success or a negated errno if the flush failed.
+ *
+ ****************************************************************************/
+
+int blockcache_invalidate(FAR struct inode *inode);
+#endif
+
 /****************************************************************************
  * Name: find_mtddriver
  *
@@ -1631,6 +1683,20 @@ int file_mmap(FAR struct file *filep, FAR void *start, size_t length,
 
 int file_munmap(FAR void *start, size_t length);
 
+/****************************************************************************
+ * Name: rammap_fault
+ *
+ * Description:
+ *   Called by the architecture fault handler with the faulting address.
+ *   Returns true if the fault was a first access to a page of a demand
+ *   filled file mapping, which is now accessible.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_FS_RAMMAP_PAGESIZE) && CONFIG_FS_RAMMAP_PAGESIZE > 0
+bool rammap_fault(FAR void *addr);
+#endif
+
 /****************************************************************************
  * Name: file_ioctl
  *
@@ -1856,6 +1922,27 @@ int file_pipe(FAR struct file *filep[2], size_t bufsize, int flags);
 int nx_mkfifo(FAR const char *pathname, mode_t mode, size_t bufsize);
 #endif
 
+/****************************************************************************
+ * Name: file_splice and file_tee
+ *
+ * Description:
+ *   Equivalent to the standard splice() and tee() functions except that
+ *   they accept struct file instances instead of file descriptors.
+ *
+ * Returned Value:
+ *   The number of bytes moved (duplicated) is returned on success; a
+ *   negated errno value is returned on a failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_PIPES
+ssize_t file_splice(FAR struct file *infile, FAR off_t *off_in,
+                    FAR struct file *outfile, FAR off_t *off_out,
+                    size_t len, unsigned int flags);
+ssize_t file_tee(FAR struct file *infile, FAR struct file *outfile,
+                 size_t len, unsigned int flags);
+#endif
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
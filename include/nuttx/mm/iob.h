@@ -57,6 +57,27 @@
 #  define CONFIG_IOB_THROTTLE 0
 #endif
 
+/* Per-CPU caching of free I/O buffers is disabled by default */
+
+#if !defined(CONFIG_IOB_PERCPU_CACHE)
+#  define CONFIG_IOB_PERCPU_CACHE 0
+#endif
+
+/* The pool of large I/O buffers is disabled by default */
+
+#if !defined(CONFIG_IOB_LARGE_NBUFFERS)
+#  define CONFIG_IOB_LARGE_NBUFFERS 0
+#endif
+
+#if CONFIG_IOB_LARGE_NBUFFERS > 0 && !defined(CONFIG_IOB_ALLOC)
+#  error CONFIG_IOB_LARGE_NBUFFERS requires CONFIG_IOB_ALLOC
+#endif
+
+#if CONFIG_IOB_LARGE_NBUFFERS > 0 && \
+    CONFIG_IOB_LARGE_BUFSIZE <= CONFIG_IOB_BUFSIZE
+#  error CONFIG_IOB_LARGE_BUFSIZE must be larger than CONFIG_IOB_BUFSIZE
+#endif
+
 /* Some I/O buffers should be allocated */
 
 #if !defined(CONFIG_IOB_NBUFFERS)
@@ -81,7 +102,7 @@
 /* IOB helpers */
 
 #define IOB_DATA(p)      (&(p)->io_data[(p)->io_offset])
-#define IOB_FREESPACE(p) (CONFIG_IOB_BUFSIZE - (p)->io_len - (p)->io_offset)
+#define IOB_FREESPACE(p) (IOB_BUFSIZE(p) - (p)->io_len - (p)->io_offset)
 
 #if CONFIG_IOB_NCHAINS > 0
 /* Queue helpers */
@@ -221,6 +242,74 @@ FAR struct iob_s *iob_alloc(bool throttled);
 
 FAR struct iob_s *iob_tryalloc(bool throttled);
 
+/****************************************************************************
+ * Name: iob_alloc_size
+ *
+ * Description:
+ *   Allocate an I/O buffer for 'size' bytes of data.  If 'size' is larger
+ *   than CONFIG_IOB_BUFSIZE and a large I/O buffer is free, the large buffer
+ *   is returned.  Otherwise, this is the same as iob_alloc() and the caller
+ *   must be prepared to receive a normal buffer.
+ *
+ * Input Parameters:
+ *   size      - The amount of data the caller intends to store.
+ *   throttled - An indication of the IOB allocation is "throttled"
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_alloc_size(unsigned int size, bool throttled);
+
+/****************************************************************************
+ * Name: iob_tryalloc_size
+ *
+ * Description:
+ *   The same as iob_alloc_size() but without waiting for a buffer to become
+ *   free.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_tryalloc_size(unsigned int size, bool throttled);
+
+/****************************************************************************
+ * Name: iob_alloc_batch
+ *
+ * Description:
+ *   Allocate 'count' I/O buffers linked together through io_flink.  When
+ *   enough buffers are free, the whole list is taken from the free list in
+ *   one operation; otherwise the buffers are allocated one at a time,
+ *   waiting if necessary.  This function cannot be called from any
+ *   interrupt level logic.
+ *
+ * Input Parameters:
+ *   count     - The number of I/O buffers to allocate.
+ *   throttled - An indication of the IOB allocation is "throttled"
+ *
+ * Returned Value:
+ *   The head of the list of I/O buffers, or NULL on failure.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_alloc_batch(unsigned int count, bool throttled);
+
+/****************************************************************************
+ * Name: iob_tryalloc_batch
+ *
+ * Description:
+ *   Try to allocate 'count' I/O buffers linked together through io_flink
+ *   without waiting.  Either all of the buffers are allocated or none.
+ *
+ * Input Parameters:
+ *   count     - The number of I/O buffers to allocate.
+ *   throttled - An indication of the IOB allocation is "throttled"
+ *
+ * Returned Value:
+ *   The head of the list of I/O buffers, or NULL if not enough buffers are
+ *   available.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_tryalloc_batch(unsigned int count, bool throttled);
+
 #ifdef CONFIG_IOB_ALLOC
 /****************************************************************************
  * Name: iob_alloc_dynamic
@@ -347,7 +436,8 @@ void iob_notifier_teardown(int key);
  *
  * Description:
  *   Free an entire buffer chain, starting at the beginning of the I/O
- *   buffer chain
+ *   buffer chain.  Pre-allocated buffers are returned to the free list in
+ *   a single operation when no allocation is waiting for them.
  *
  ****************************************************************************/
 
@@ -166,12 +166,44 @@
 #define MM_ALLOC_MAGIC   0xaa
 #define MM_FREE_MAGIC    0x55
 
+/* Heap region attributes (mm_region_setattr()) and allocation hints
+ * (mm_malloc_hint(), mm_sethint()).  A hint selects the regions having all
+ * of the requested attributes; MM_REGION_LOCAL in a hint selects the
+ * regions local to the calling CPU.  Unless MM_HINT_STRICT is given, the
+ * allocation falls back to any region when the selected ones are full.
+ */
+
+#define MM_REGION_FAST   (1 << 0)  /* Fast memory (TCM, internal SRAM) */
+#define MM_REGION_DMA    (1 << 1)  /* Accessible by DMA masters */
+#define MM_REGION_LOCAL  (1 << 2)  /* Local to the CPU in bits 8-15 */
+#define MM_HINT_STRICT   (1 << 7)  /* Don't fall back to other regions */
+
+#define MM_REGION_CPU(cpu)   (MM_REGION_LOCAL | ((unsigned int)(cpu) << 8))
+#define MM_REGION_GETCPU(a)  (((a) >> 8) & 0xff)
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
 
 struct mm_heap_s; /* Forward reference */
 
+#ifdef CONFIG_MM_SHRINKER
+/* A shrinker releases memory held by a cache when the system runs low on
+ * memory.  'shrink' is called with the heap that is short of memory (NULL
+ * when the free memory dropped below CONFIG_MM_SHRINKER_THRESHOLD) and the
+ * number of bytes wanted, and returns the number of bytes it released.  It
+ * is called from the context of the failing allocation, so it must not
+ * wait for other threads and should only free memory.
+ */
+
+struct mm_shrinker_s
+{
+  FAR struct mm_shrinker_s *flink;  /* Implementation private */
+  CODE size_t (*shrink)(FAR struct mm_shrinker_s *shrinker,
+                        FAR struct mm_heap_s *heap, size_t size);
+};
+#endif
+
 struct mempool_init_s
 {
   FAR const size_t *poolsize;
@@ -282,8 +314,22 @@ void kmm_addregion(FAR void *heapstart, size_t heapsize);
 
 FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size) malloc_like1(2);
 
+#ifdef CONFIG_MM_REGION_ATTR
+FAR void *mm_malloc_hint(FAR struct mm_heap_s *heap, size_t size,
+                         unsigned int hint) malloc_like1(2);
+#else
+#  define mm_malloc_hint(heap, size, hint) mm_malloc(heap, size)
+#endif
+
 void mm_free_delaylist(FAR struct mm_heap_s *heap);
 
+#if defined(CONFIG_MM_FREE_DELAY_IDLE) && \
+    (defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__))
+void mm_free_delaylist_idle(void);
+#else
+#  define mm_free_delaylist_idle()
+#endif
+
 /* Functions contained in kmm_malloc.c **************************************/
 
 #ifdef CONFIG_MM_KERNEL_HEAP
@@ -458,10 +504,45 @@ FAR void kmm_checkcorruption(void);
 
 #ifdef CONFIG_FS_PROCFS_INCLUDE_PRESSURE
 void mm_notify_pressure(size_t remaining, size_t largest);
+#elif defined(CONFIG_MM_SHRINKER)
+#  define mm_notify_pressure(remaining, largest) mm_shrink_pressure(remaining)
 #else
 #  define mm_notify_pressure(remaining, largest)
 #endif
 
+/* Functions contained in mm_shrinker.c *************************************/
+
+#if defined(CONFIG_MM_SHRINKER) && \
+    (defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__))
+int mm_register_shrinker(FAR struct mm_shrinker_s *shrinker);
+void mm_unregister_shrinker(FAR struct mm_shrinker_s *shrinker);
+size_t mm_shrink(FAR struct mm_heap_s *heap, size_t size);
+void mm_shrink_pressure(size_t remaining);
+#else
+#  define mm_shrink(heap, size) 0
+#  define mm_shrink_pressure(remaining)
+#endif
+
+/* Functions contained in mm_guard.c ****************************************/
+
+#ifdef CONFIG_MM_GUARD
+bool mm_guard_fault(FAR void *addr);
+#endif
+
+/* Functions contained in mm_region.c ***************************************/
+
+#ifdef CONFIG_MM_REGION_ATTR
+int mm_region_setattr(FAR struct mm_heap_s *heap, FAR void *start,
+                      unsigned int attr);
+#endif
+
+#if defined(CONFIG_MM_REGION_ATTR) && \
+    (defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__))
+unsigned int mm_sethint(unsigned int hint);
+#else
+#  define mm_sethint(hint) 0
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
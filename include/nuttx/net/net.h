@@ -141,6 +141,7 @@ struct file;    /* Forward reference */
 struct stat;    /* Forward reference */
 struct socket;  /* Forward reference */
 struct pollfd;  /* Forward reference */
+struct tcb_s;   /* Forward reference */
 
 struct sock_intf_s
 {
@@ -579,6 +580,26 @@ FAR struct iob_s *net_ioballoc(bool throttled);
 
 int sockfd_allocate(FAR struct socket *psock, int oflags);
 
+/****************************************************************************
+ * Name: sockfd_allocate_from_tcb
+ *
+ * Description:
+ *   Allocate a socket descriptor in the file list of another task
+ *
+ * Input Parameters:
+ *   tcb      The task that will own the descriptor.
+ *   psock    A pointer to socket structure.
+ *   oflags   Open mode flags.
+ *
+ * Returned Value:
+ *   The file descriptor == index into the files array of the task, or a
+ *   negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int sockfd_allocate_from_tcb(FAR struct tcb_s *tcb,
+                             FAR struct socket *psock, int oflags);
+
 /****************************************************************************
  * Name: sockfd_socket
  *
@@ -44,10 +44,13 @@
  * CONFIG_MM_PGSIZE - The page size.  Must be one of {1024, 2048,
  *   4096, 8192, or 16384}.  This is easily extensible, but only those
  *   values are currently support.
+ * CONFIG_MM_PGALLOC_GRAN or CONFIG_MM_PGALLOC_BUDDY - Selects the granule
+ *   allocator or the buddy allocator as the backend.
  * CONFIG_DEBUG_PGALLOC - Just like CONFIG_DEBUG_MM, but only generates
  *   output from the page allocation logic.
  *
- * Dependencies:  CONFIG_ARCH_USE_MMU and CONFIG_GRAN
+ * Dependencies:  CONFIG_ARCH_USE_MMU, and CONFIG_GRAN for the granule
+ *   backend
  */
 
 #ifndef CONFIG_MM_PGALLOC_PGSIZE
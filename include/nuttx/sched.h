@@ -50,6 +50,11 @@
 #include <nuttx/tls.h>
 #include <nuttx/spinlock_type.h>
 
+#ifdef CONFIG_MM_ACCOUNTING
+#  include <sys/resource.h>
+#  include <nuttx/atomic.h>
+#endif
+
 #include <arch/arch.h>
 
 /****************************************************************************
@@ -547,6 +552,15 @@ struct task_group_s
 
   struct mm_map_s tg_mm_map;        /* Task group virtual memory mappings   */
 
+#ifdef CONFIG_MM_ACCOUNTING
+  /* Heap accounting ********************************************************/
+
+  atomic_t tg_heapused;             /* Heap bytes allocated by the group    */
+  uint32_t tg_heapgen;              /* Tells groups with the same pid apart */
+  size_t   tg_heappeak;             /* Peak value of tg_heapused            */
+  struct rlimit tg_datalimit;       /* RLIMIT_DATA limit on tg_heapused     */
+#endif
+
   spinlock_t tg_lock;               /* SpinLock for group */
   rmutex_t   tg_mutex;              /* Mutex for group */
 };
@@ -612,6 +626,9 @@ struct tcb_s
 #ifdef CONFIG_SMP
   uint8_t  cpu;                          /* CPU index if running/assigned   */
   cpu_set_t affinity;                    /* Bit set of permitted CPUs       */
+#endif
+#ifdef CONFIG_MM_REGION_ATTR
+  uint8_t  mm_hint;                      /* Default heap region hint        */
 #endif
   uint32_t flags;                        /* Misc. general status flags      */
   int16_t  lockcount;                    /* 0=preemptible (not-locked)      */
@@ -0,0 +1,164 @@
+/****************************************************************************
+ * include/sys/ioring.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_SYS_IORING_H
+#define __INCLUDE_SYS_IORING_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Submission queue entry operations */
+
+#define IORING_OP_NOP       0  /* Complete immediately */
+#define IORING_OP_READ      1  /* read()/pread() into addr, len bytes */
+#define IORING_OP_WRITE     2  /* write()/pwrite() from addr, len bytes */
+#define IORING_OP_READV     3  /* readv() into the iovec array addr[len] */
+#define IORING_OP_WRITEV    4  /* writev() from the iovec array addr[len] */
+#define IORING_OP_FSYNC     5  /* fsync() */
+#define IORING_OP_POLL      6  /* Wait for op_flags poll events on fd */
+#define IORING_OP_ACCEPT    7  /* accept4() with addr, addr2 as addrlen */
+#define IORING_OP_SEND      8  /* send() from addr, len bytes */
+#define IORING_OP_RECV      9  /* recv() into addr, len bytes */
+
+/* ioring_enter() flags */
+
+#define IORING_ENTER_GETEVENTS (1 << 0) /* Wait for min_complete CQEs */
+
+/****************************************************************************
+ * Public Type Definitions
+ ****************************************************************************/
+
+/* One I/O request, written by the application into the submission queue */
+
+struct ioring_sqe
+{
+  uint8_t       opcode;     /* IORING_OP_* */
+  uint8_t       flags;      /* Reserved, must be zero */
+  uint16_t      reserved;
+  int           fd;         /* The file or socket descriptor */
+  off_t         off;        /* READ/WRITE: file offset, -1 for current */
+  FAR void     *addr;       /* Buffer, iovec array or sockaddr */
+  FAR void     *addr2;      /* ACCEPT: socklen_t in/out */
+  uint32_t      len;        /* Buffer length or iovec count */
+  uint32_t      op_flags;   /* POLL: events, ACCEPT/SEND/RECV: flags */
+  FAR void     *user_data;  /* Passed back untouched in the completion */
+};
+
+/* The result of one request, read by the application from the completion
+ * queue.
+ */
+
+struct ioring_cqe
+{
+  FAR void     *user_data;  /* user_data of the request */
+  int32_t       res;        /* Result, or a negated errno value */
+  uint32_t      flags;      /* Reserved */
+};
+
+/* The rings shared by the application and the kernel.  The application
+ * fills sqes[sq_tail & sq_mask] and advances sq_tail, the kernel consumes
+ * up to sq_tail on ioring_enter().  The kernel fills cqes[cq_tail &
+ * cq_mask] and advances cq_tail, the application consumes entries and
+ * advances cq_head.  The heads and tails only grow and wrap around.  The
+ * masks and queue pointers are for the application only; the kernel keeps
+ * its own copies and never uses the ones found here.
+ */
+
+struct ioring_s
+{
+  volatile uint32_t sq_head;         /* Next SQE the kernel consumes */
+  volatile uint32_t sq_tail;         /* Next SQE the application fills */
+  volatile uint32_t cq_head;         /* Next CQE the application reads */
+  volatile uint32_t cq_tail;         /* Next CQE the kernel fills */
+  uint32_t          sq_mask;         /* Number of SQEs - 1 */
+  uint32_t          cq_mask;         /* Number of CQEs - 1 */
+  FAR struct ioring_sqe *sqes;       /* The submission queue */
+  FAR struct ioring_cqe *cqes;       /* The completion queue */
+};
+
+struct ioring_params
+{
+  uint32_t          sq_entries;      /* Out: number of SQEs */
+  uint32_t          cq_entries;      /* Out: number of CQEs */
+  FAR struct ioring_s *ring;         /* Out: the shared rings */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: ioring_setup
+ *
+ * Description:
+ *   Create a ring of at least 'entries' submission queue entries (rounded
+ *   up to a power of two) and twice as many completion queue entries.
+ *
+ * Returned Value:
+ *   A file descriptor for the ring on success, with the shared rings
+ *   described in 'p'; -1 with errno set on failure.  The fd is readable
+ *   (poll()/epoll) while completions are pending.
+ *
+ ****************************************************************************/
+
+int ioring_setup(unsigned int entries, FAR struct ioring_params *p);
+
+/****************************************************************************
+ * Name: ioring_enter
+ *
+ * Description:
+ *   Submit up to 'to_submit' new entries of the submission queue and, with
+ *   IORING_ENTER_GETEVENTS, wait until at least 'min_complete' completions
+ *   are pending.
+ *
+ * Returned Value:
+ *   The number of entries submitted; -1 with errno set on failure.
+ *
+ ****************************************************************************/
+
+int ioring_enter(int fd, unsigned int to_submit, unsigned int min_complete,
+                 unsigned int flags);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INCLUDE_SYS_IORING_H */
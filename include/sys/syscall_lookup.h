@@ -75,6 +75,13 @@ SYSCALL_LOOKUP(sethostname,                2)
   SYSCALL_LOOKUP(getegid,                  0)
 #endif
 
+/* Resource limits */
+
+#ifdef CONFIG_MM_ACCOUNTING
+  SYSCALL_LOOKUP(setrlimit,                2)
+  SYSCALL_LOOKUP(getrlimit,                2)
+#endif
+
 /* Semaphores */
 
 SYSCALL_LOOKUP(nxsem_destroy,              1)
@@ -218,6 +225,10 @@ SYSCALL_LOOKUP(pwrite,                     4)
 #ifdef CONFIG_EVENT_FD
   SYSCALL_LOOKUP(eventfd,                  2)
 #endif
+#ifdef CONFIG_FS_IORING
+  SYSCALL_LOOKUP(ioring_setup,             2)
+  SYSCALL_LOOKUP(ioring_enter,             4)
+#endif
 #ifdef CONFIG_TIMER_FD
   SYSCALL_LOOKUP(timerfd_create,           2)
   SYSCALL_LOOKUP(timerfd_settime,          4)
@@ -277,6 +288,11 @@ SYSCALL_LOOKUP(munmap,                     2)
   SYSCALL_LOOKUP(nx_mkfifo,                3)
 #endif
 
+#ifdef CONFIG_PIPES
+  SYSCALL_LOOKUP(splice,                   6)
+  SYSCALL_LOOKUP(tee,                      4)
+#endif
+
 #ifndef CONFIG_DISABLE_MOUNTPOINT
   SYSCALL_LOOKUP(mount,                    5)
   SYSCALL_LOOKUP(mkdir,                    2)
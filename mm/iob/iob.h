@@ -29,8 +29,10 @@
 
 #include <nuttx/config.h>
 
+#include <stdbool.h>
 #include <debug.h>
 
+#include <nuttx/nuttx.h>
 #include <nuttx/mm/iob.h>
 #include <nuttx/semaphore.h>
 #include <nuttx/spinlock.h>
@@ -51,6 +53,42 @@
 #  define iobinfo                _none
 #endif /* CONFIG_DEBUG_FEATURES && CONFIG_IOB_DEBUG */
 
+/* Large I/O buffers are recognized by the location of their payload, which
+ * stays with the buffer's data when the payload is moved between IOBs.
+ */
+
+#if CONFIG_IOB_LARGE_NBUFFERS > 0
+#  define IOB_LARGE_ALIGN_SIZE  ALIGN_UP(CONFIG_IOB_LARGE_BUFSIZE, \
+                                         CONFIG_IOB_ALIGNMENT)
+#  define IOB_LARGE_BUFFER_SIZE (IOB_LARGE_ALIGN_SIZE * \
+                                 CONFIG_IOB_LARGE_NBUFFERS)
+#  define IOB_IS_LARGE(p) \
+     ((p)->io_data >= g_iob_large_buffer && \
+      (p)->io_data < g_iob_large_buffer + IOB_LARGE_BUFFER_SIZE)
+#else
+#  define IOB_IS_LARGE(p)       false
+#endif
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+#if CONFIG_IOB_PERCPU_CACHE > 0
+/* A per-CPU cache of free I/O buffers.  The cache is normally only touched
+ * by its owning CPU with local interrupts disabled; the spinlock is needed
+ * only so that other CPUs can reclaim the cached buffers.
+ */
+
+struct iob_cache_s
+{
+  FAR struct iob_s *ic_head;   /* List of cached I/O buffers */
+  int16_t           ic_count;  /* Number of I/O buffers in the list */
+#ifdef CONFIG_SMP
+  spinlock_t        ic_lock;   /* Protects the cache from reclaim */
+#endif
+};
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -98,6 +136,22 @@ extern int16_t g_qentry_wait;
 
 extern volatile spinlock_t g_iob_lock;
 
+#if CONFIG_IOB_LARGE_NBUFFERS > 0
+/* The payload memory of the large I/O buffers */
+
+extern uint8_t g_iob_large_buffer[IOB_LARGE_BUFFER_SIZE];
+
+/* A list of all free, unallocated large I/O buffers */
+
+extern FAR struct iob_s *g_iob_large_freelist;
+#endif
+
+#if CONFIG_IOB_PERCPU_CACHE > 0
+/* The per-CPU I/O buffer caches */
+
+extern struct iob_cache_s g_iob_cache[CONFIG_SMP_NCPUS];
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -137,6 +191,103 @@ FAR struct iob_qentry_s *iob_tryalloc_qentry(void);
 
 FAR struct iob_qentry_s *iob_free_qentry(FAR struct iob_qentry_s *iobq);
 
+/****************************************************************************
+ * Name: iob_release
+ *
+ * Description:
+ *   Return a list of pre-allocated I/O buffers, linked through io_flink, to
+ *   the global free list.  Buffers are handed to waiting allocators first.
+ *   This function is intended only for internal use by the IOB module.
+ *
+ ****************************************************************************/
+
+void iob_release(FAR struct iob_s *iob);
+
+#if CONFIG_IOB_LARGE_NBUFFERS > 0
+
+/****************************************************************************
+ * Name: iob_tryalloc_large
+ *
+ * Description:
+ *   Try to take a buffer from the pool of large I/O buffers.  Returns NULL
+ *   if the pool is exhausted.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_tryalloc_large(void);
+
+/****************************************************************************
+ * Name: iob_free_large
+ *
+ * Description:
+ *   Return a large I/O buffer to the pool of large I/O buffers.
+ *
+ ****************************************************************************/
+
+void iob_free_large(FAR struct iob_s *iob);
+
+/****************************************************************************
+ * Name: iob_upgrade
+ *
+ * Description:
+ *   Move the data of a normal I/O buffer into a large buffer in place, so
+ *   that 'iob' can hold CONFIG_IOB_LARGE_BUFSIZE bytes.  Returns true if
+ *   'iob' is a large buffer on return.
+ *
+ ****************************************************************************/
+
+bool iob_upgrade(FAR struct iob_s *iob);
+
+#endif /* CONFIG_IOB_LARGE_NBUFFERS > 0 */
+
+#if CONFIG_IOB_PERCPU_CACHE > 0
+
+/****************************************************************************
+ * Name: iob_cache_alloc
+ *
+ * Description:
+ *   Take an I/O buffer from the cache of the current CPU, refilling the
+ *   cache from the global free list if it is empty.  Returns NULL if no
+ *   buffer could be obtained this way, or if a throttled allocation would
+ *   dip into the throttle reserve.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_cache_alloc(bool throttled);
+
+/****************************************************************************
+ * Name: iob_cache_free
+ *
+ * Description:
+ *   Put a free I/O buffer into the cache of the current CPU.  Returns false
+ *   if the buffer was not cached and must be released with iob_release().
+ *
+ ****************************************************************************/
+
+bool iob_cache_free(FAR struct iob_s *iob);
+
+/****************************************************************************
+ * Name: iob_cache_reclaim
+ *
+ * Description:
+ *   Return the content of all per-CPU caches to the global free list.
+ *
+ ****************************************************************************/
+
+void iob_cache_reclaim(void);
+
+/****************************************************************************
+ * Name: iob_cache_navail
+ *
+ * Description:
+ *   Return the number of I/O buffers held in the per-CPU caches.
+ *
+ ****************************************************************************/
+
+int iob_cache_navail(void);
+
+#endif /* CONFIG_IOB_PERCPU_CACHE > 0 */
+
 /****************************************************************************
  * Name: iob_notifier_signal
  *
@@ -34,6 +34,7 @@
 #include <nuttx/sched.h>
 #ifdef CONFIG_IOB_ALLOC
 #  include <nuttx/kmalloc.h>
+#  include <nuttx/mm/mm.h>
 #endif
 #include <nuttx/nuttx.h>
 #include <nuttx/mm/iob.h>
@@ -159,6 +160,16 @@ static FAR struct iob_s *iob_allocwait(bool throttled, unsigned int timeout)
   clock_t start;
   int ret = OK;
 
+#if CONFIG_IOB_PERCPU_CACHE > 0
+  /* Try the per-CPU caches first; they are drained before we wait */
+
+  iob = iob_tryalloc(throttled);
+  if (iob != NULL)
+    {
+      return iob;
+    }
+#endif
+
 #if CONFIG_IOB_THROTTLE > 0
   /* Select the semaphore to wait. */
 
@@ -300,6 +311,18 @@ FAR struct iob_s *iob_tryalloc(bool throttled)
   FAR struct iob_s *iob;
   irqstate_t flags;
 
+#if CONFIG_IOB_PERCPU_CACHE > 0
+  /* The cache of this CPU can usually serve the request without touching
+   * the global free list.
+   */
+
+  iob = iob_cache_alloc(throttled);
+  if (iob != NULL)
+    {
+      return iob;
+    }
+#endif
+
   /* We don't know what context we are called from so we use extreme measures
    * to protect the free list:  We disable interrupts very briefly.
    */
@@ -307,9 +330,83 @@ FAR struct iob_s *iob_tryalloc(bool throttled)
   flags = spin_lock_irqsave(&g_iob_lock);
   iob = iob_tryalloc_internal(throttled);
   spin_unlock_irqrestore(&g_iob_lock, flags);
+
+#if CONFIG_IOB_PERCPU_CACHE > 0
+  /* The free list is exhausted, take back buffers cached on other CPUs */
+
+  if (iob == NULL && iob_cache_navail() > 0)
+    {
+      iob_cache_reclaim();
+
+      flags = spin_lock_irqsave(&g_iob_lock);
+      iob = iob_tryalloc_internal(throttled);
+      spin_unlock_irqrestore(&g_iob_lock, flags);
+    }
+#endif
+
   return iob;
 }
 
+/****************************************************************************
+ * Name: iob_alloc_size
+ *
+ * Description:
+ *   Allocate an I/O buffer for 'size' bytes of data.  If 'size' is larger
+ *   than CONFIG_IOB_BUFSIZE and a large I/O buffer is free, the large buffer
+ *   is returned.  Otherwise, this is the same as iob_alloc() and the caller
+ *   must be prepared to receive a normal buffer.
+ *
+ * Input Parameters:
+ *   size      - The amount of data the caller intends to store.
+ *   throttled - An indication of the IOB allocation is "throttled"
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_alloc_size(unsigned int size, bool throttled)
+{
+#if CONFIG_IOB_LARGE_NBUFFERS > 0
+  FAR struct iob_s *iob;
+
+  if (size > CONFIG_IOB_BUFSIZE)
+    {
+      iob = iob_tryalloc_large();
+      if (iob != NULL)
+        {
+          return iob;
+        }
+    }
+#endif
+
+  return iob_alloc(throttled);
+}
+
+/****************************************************************************
+ * Name: iob_tryalloc_size
+ *
+ * Description:
+ *   The same as iob_alloc_size() but without waiting for a buffer to become
+ *   free.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_tryalloc_size(unsigned int size, bool throttled)
+{
+#if CONFIG_IOB_LARGE_NBUFFERS > 0
+  FAR struct iob_s *iob;
+
+  if (size > CONFIG_IOB_BUFSIZE)
+    {
+      iob = iob_tryalloc_large();
+      if (iob != NULL)
+        {
+          return iob;
+        }
+    }
+#endif
+
+  return iob_tryalloc(throttled);
+}
+
 #ifdef CONFIG_IOB_ALLOC
 
 /****************************************************************************
@@ -333,10 +430,21 @@ FAR struct iob_s *iob_alloc_dynamic(uint16_t size)
 {
   FAR struct iob_s *iob;
   size_t alignsize;
+#ifdef CONFIG_MM_REGION_FAST_IOB
+  unsigned int hint;
+#endif
 
   alignsize = ALIGN_UP(sizeof(struct iob_s), CONFIG_IOB_ALIGNMENT) + size;
 
+#ifdef CONFIG_MM_REGION_FAST_IOB
+  hint = mm_sethint(MM_REGION_FAST);
+#endif
+
   iob = kmm_memalign(CONFIG_IOB_ALIGNMENT, alignsize);
+
+#ifdef CONFIG_MM_REGION_FAST_IOB
+  mm_sethint(hint);
+#endif
   if (iob)
     {
       iob->io_flink   = NULL;             /* Not in a chain */
@@ -379,10 +487,21 @@ FAR struct iob_s *iob_alloc_with_data(FAR void *data, uint16_t size,
                                       iob_free_cb_t free_cb)
 {
   FAR struct iob_s *iob;
+#ifdef CONFIG_MM_REGION_FAST_IOB
+  unsigned int hint;
+#endif
 
   DEBUGASSERT(free_cb != NULL);
 
+#ifdef CONFIG_MM_REGION_FAST_IOB
+  hint = mm_sethint(MM_REGION_FAST);
+#endif
+
   iob = kmm_malloc(sizeof(struct iob_s));
+
+#ifdef CONFIG_MM_REGION_FAST_IOB
+  mm_sethint(hint);
+#endif
   if (iob)
     {
       iob->io_flink   = NULL;    /* Not in a chain */
@@ -0,0 +1,211 @@
+/****************************************************************************
+ * mm/iob/iob_alloc_batch.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <assert.h>
+
+#include <nuttx/irq.h>
+#include <nuttx/arch.h>
+#include <nuttx/sched.h>
+#include <nuttx/mm/iob.h>
+
+#include "iob.h"
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: iob_tryalloc_batch_internal
+ *
+ * Description:
+ *   Detach 'count' I/O buffers from the head of the free list.  The caller
+ *   must hold g_iob_lock.
+ *
+ ****************************************************************************/
+
+static FAR struct iob_s *iob_tryalloc_batch_internal(unsigned int count,
+                                                     bool throttled)
+{
+  FAR struct iob_s *head;
+  FAR struct iob_s *iob;
+  int16_t avail = g_iob_count;
+  unsigned int i;
+
+#if CONFIG_IOB_THROTTLE > 0
+  if (throttled)
+    {
+      avail -= CONFIG_IOB_THROTTLE;
+    }
+#endif
+
+  if (avail <= 0 || count > (unsigned int)avail)
+    {
+      return NULL;
+    }
+
+  /* Put each I/O buffer in a known state while walking to the end of the
+   * batch.
+   */
+
+  head = g_iob_freelist;
+  for (iob = head, i = 1; ; iob = iob->io_flink, i++)
+    {
+      DEBUGASSERT(iob != NULL);
+
+      iob->io_len    = 0;    /* Length of the data in the entry */
+      iob->io_offset = 0;    /* Offset to the beginning of data */
+      iob->io_pktlen = 0;    /* Total length of the packet */
+
+      if (i == count)
+        {
+          break;
+        }
+    }
+
+  g_iob_freelist = iob->io_flink;
+  iob->io_flink  = NULL;
+
+  g_iob_count -= count;
+  DEBUGASSERT(g_iob_count >= 0);
+
+  return head;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: iob_tryalloc_batch
+ *
+ * Description:
+ *   Try to allocate 'count' I/O buffers linked together through io_flink
+ *   without waiting.  Either all of the buffers are allocated or none.
+ *
+ * Input Parameters:
+ *   count     - The number of I/O buffers to allocate.
+ *   throttled - An indication of the IOB allocation is "throttled"
+ *
+ * Returned Value:
+ *   The head of the list of I/O buffers, or NULL if not enough buffers are
+ *   available.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_tryalloc_batch(unsigned int count, bool throttled)
+{
+  FAR struct iob_s *iob;
+  irqstate_t flags;
+
+  if (count == 0)
+    {
+      return NULL;
+    }
+
+  flags = spin_lock_irqsave(&g_iob_lock);
+  iob = iob_tryalloc_batch_internal(count, throttled);
+  spin_unlock_irqrestore(&g_iob_lock, flags);
+
+#if CONFIG_IOB_PERCPU_CACHE > 0
+  /* Take back buffers cached on the CPUs and try once more */
+
+  if (iob == NULL && iob_cache_navail() > 0)
+    {
+      iob_cache_reclaim();
+
+      flags = spin_lock_irqsave(&g_iob_lock);
+      iob = iob_tryalloc_batch_internal(count, throttled);
+      spin_unlock_irqrestore(&g_iob_lock, flags);
+    }
+#endif
+
+  return iob;
+}
+
+/****************************************************************************
+ * Name: iob_alloc_batch
+ *
+ * Description:
+ *   Allocate 'count' I/O buffers linked together through io_flink.  When
+ *   enough buffers are free, the whole list is taken from the free list in
+ *   one operation; otherwise the buffers are allocated one at a time,
+ *   waiting if necessary.  This function cannot be called from any
+ *   interrupt level logic.
+ *
+ * Input Parameters:
+ *   count     - The number of I/O buffers to allocate.
+ *   throttled - An indication of the IOB allocation is "throttled"
+ *
+ * Returned Value:
+ *   The head of the list of I/O buffers, or NULL on failure.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_alloc_batch(unsigned int count, bool throttled)
+{
+  FAR struct iob_s *head;
+  FAR struct iob_s *tail;
+  FAR struct iob_s *iob;
+
+  head = iob_tryalloc_batch(count, throttled);
+  if (head != NULL || count == 0 ||
+      up_interrupt_context() || sched_idletask())
+    {
+      return head;
+    }
+
+  /* Not enough free buffers, fall back to waiting for them one by one */
+
+  for (tail = NULL; count > 0; count--)
+    {
+      iob = iob_alloc(throttled);
+      if (iob == NULL)
+        {
+          if (head != NULL)
+            {
+              iob_free_chain(head);
+            }
+
+          return NULL;
+        }
+
+      if (tail == NULL)
+        {
+          head = iob;
+        }
+      else
+        {
+          tail->io_flink = iob;
+        }
+
+      tail = iob;
+    }
+
+  return head;
+}
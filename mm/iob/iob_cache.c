@@ -0,0 +1,315 @@
+/****************************************************************************
+ * mm/iob/iob_cache.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <assert.h>
+
+#include <nuttx/irq.h>
+#include <nuttx/sched.h>
+#include <nuttx/spinlock.h>
+#include <nuttx/mm/iob.h>
+
+#include "iob.h"
+
+#if CONFIG_IOB_PERCPU_CACHE > 0
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The cache is refilled and spilled in batches of half its size */
+
+#define IOB_CACHE_BATCH  ((CONFIG_IOB_PERCPU_CACHE + 1) / 2)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: iob_cache_lock
+ *
+ * Description:
+ *   Lock the cache of the current CPU.  Interrupts are disabled before the
+ *   CPU index is sampled so that the caller cannot migrate to another CPU
+ *   while the cache is in use.
+ *
+ ****************************************************************************/
+
+static FAR struct iob_cache_s *iob_cache_lock(FAR irqstate_t *flags)
+{
+  FAR struct iob_cache_s *cache;
+
+  *flags = up_irq_save();
+  cache  = &g_iob_cache[this_cpu()];
+#ifdef CONFIG_SMP
+  spin_lock(&cache->ic_lock);
+#endif
+
+  return cache;
+}
+
+/****************************************************************************
+ * Name: iob_cache_unlock
+ ****************************************************************************/
+
+static void iob_cache_unlock(FAR struct iob_cache_s *cache,
+                             irqstate_t flags)
+{
+#ifdef CONFIG_SMP
+  spin_unlock(&cache->ic_lock);
+#endif
+  up_irq_restore(flags);
+}
+
+/****************************************************************************
+ * Name: iob_cache_refill
+ *
+ * Description:
+ *   Move a batch of I/O buffers from the global free list into the cache.
+ *   Buffers are only taken while the free list holds more than the
+ *   throttle reserve so that caching never starves non-throttled users.
+ *
+ ****************************************************************************/
+
+static void iob_cache_refill(FAR struct iob_cache_s *cache)
+{
+  FAR struct iob_s *iob;
+  irqstate_t flags;
+  int i;
+
+  flags = spin_lock_irqsave(&g_iob_lock);
+
+  if (g_iob_count > CONFIG_IOB_THROTTLE + IOB_CACHE_BATCH)
+    {
+      for (i = 0; i < IOB_CACHE_BATCH; i++)
+        {
+          iob            = g_iob_freelist;
+          DEBUGASSERT(iob != NULL);
+          g_iob_freelist = iob->io_flink;
+          iob->io_flink  = cache->ic_head;
+          cache->ic_head = iob;
+        }
+
+      g_iob_count     -= IOB_CACHE_BATCH;
+      cache->ic_count += IOB_CACHE_BATCH;
+    }
+
+  spin_unlock_irqrestore(&g_iob_lock, flags);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: iob_cache_alloc
+ *
+ * Description:
+ *   Take an I/O buffer from the cache of the current CPU, refilling the
+ *   cache from the global free list if it is empty.  Returns NULL if no
+ *   buffer could be obtained this way, or if a throttled allocation would
+ *   dip into the throttle reserve.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_cache_alloc(bool throttled)
+{
+  FAR struct iob_cache_s *cache;
+  FAR struct iob_s *iob;
+  irqstate_t flags;
+
+#if CONFIG_IOB_THROTTLE > 0
+  /* Cached buffers count as available, so the same reserve applies to them
+   * as to the global free list.
+   */
+
+  if (throttled && iob_navail(true) <= 0)
+    {
+      return NULL;
+    }
+#endif
+
+  cache = iob_cache_lock(&flags);
+
+  if (cache->ic_head == NULL)
+    {
+      iob_cache_refill(cache);
+    }
+
+  iob = cache->ic_head;
+  if (iob != NULL)
+    {
+      cache->ic_head = iob->io_flink;
+      cache->ic_count--;
+
+      /* Put the I/O buffer in a known state */
+
+      iob->io_flink  = NULL; /* Not in a chain */
+      iob->io_len    = 0;    /* Length of the data in the entry */
+      iob->io_offset = 0;    /* Offset to the beginning of data */
+      iob->io_pktlen = 0;    /* Total length of the packet */
+    }
+
+  iob_cache_unlock(cache, flags);
+  return iob;
+}
+
+/****************************************************************************
+ * Name: iob_cache_free
+ *
+ * Description:
+ *   Put a free I/O buffer into the cache of the current CPU.  Returns false
+ *   if the buffer was not cached and must be released with iob_release().
+ *
+ ****************************************************************************/
+
+bool iob_cache_free(FAR struct iob_s *iob)
+{
+  FAR struct iob_cache_s *cache;
+  FAR struct iob_s *spill = NULL;
+  FAR struct iob_s *tail;
+  irqstate_t flags;
+  bool waiting;
+  int i;
+
+  /* If some allocation is waiting for an IOB, the buffer must go to the
+   * global list.  This is only a hint; iob_release() rechecks it with the
+   * lock held.
+   */
+
+  waiting = g_iob_count < 0;
+#if CONFIG_IOB_THROTTLE > 0
+  waiting = waiting || g_throttle_wait > 0;
+#endif
+
+  cache = iob_cache_lock(&flags);
+
+  if (waiting)
+    {
+      /* Give up everything held by this CPU as well */
+
+      spill           = cache->ic_head;
+      cache->ic_head  = NULL;
+      cache->ic_count = 0;
+    }
+  else
+    {
+      if (cache->ic_count >= CONFIG_IOB_PERCPU_CACHE)
+        {
+          /* The cache is full, spill a batch to the global list */
+
+          spill = cache->ic_head;
+          for (tail = spill, i = 1; i < IOB_CACHE_BATCH; i++)
+            {
+              tail = tail->io_flink;
+            }
+
+          cache->ic_head   = tail->io_flink;
+          cache->ic_count -= IOB_CACHE_BATCH;
+          tail->io_flink   = NULL;
+        }
+
+      iob->io_flink  = cache->ic_head;
+      cache->ic_head = iob;
+      cache->ic_count++;
+    }
+
+  iob_cache_unlock(cache, flags);
+
+  if (spill != NULL)
+    {
+      iob_release(spill);
+    }
+
+  return !waiting;
+}
+
+/****************************************************************************
+ * Name: iob_cache_reclaim
+ *
+ * Description:
+ *   Return the content of all per-CPU caches to the global free list.
+ *
+ ****************************************************************************/
+
+void iob_cache_reclaim(void)
+{
+  FAR struct iob_cache_s *cache;
+  FAR struct iob_s *iob;
+  irqstate_t flags;
+  int cpu;
+
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      cache = &g_iob_cache[cpu];
+
+#ifdef CONFIG_SMP
+      flags = spin_lock_irqsave(&cache->ic_lock);
+#else
+      flags = up_irq_save();
+#endif
+
+      iob             = cache->ic_head;
+      cache->ic_head  = NULL;
+      cache->ic_count = 0;
+
+#ifdef CONFIG_SMP
+      spin_unlock_irqrestore(&cache->ic_lock, flags);
+#else
+      up_irq_restore(flags);
+#endif
+
+      if (iob != NULL)
+        {
+          iob_release(iob);
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: iob_cache_navail
+ *
+ * Description:
+ *   Return the number of I/O buffers held in the per-CPU caches.
+ *
+ ****************************************************************************/
+
+int iob_cache_navail(void)
+{
+  int navail = 0;
+  int cpu;
+
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      navail += g_iob_cache[cpu].ic_count;
+    }
+
+  return navail;
+}
+
+#endif /* CONFIG_IOB_PERCPU_CACHE > 0 */
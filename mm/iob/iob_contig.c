@@ -54,9 +54,20 @@ int iob_contig(FAR struct iob_s *iob, unsigned int len)
   FAR struct iob_s *next;
   unsigned int ncopy;
 
+#if CONFIG_IOB_LARGE_NBUFFERS > 0
+  /* If the head buffer is too small, try moving it to a large buffer */
+
+  if (len > IOB_BUFSIZE(iob) && len <= iob->io_pktlen && !iob_upgrade(iob))
+    {
+      ioberr("ERROR: No large buffer for len=%u\n", len);
+      return -ENOMEM;
+    }
+#endif
+
   /* We can't make more contiguous space that the size of one I/O buffer.
    * If you get this assertion and really need that much contiguous data,
-   * then you will need to increase CONFIG_IOB_BUFSIZE.
+   * then you will need to increase CONFIG_IOB_BUFSIZE (or enable
+   * CONFIG_IOB_LARGE_NBUFFERS).
    */
 
   DEBUGASSERT(len <= IOB_BUFSIZE(iob));
@@ -121,7 +132,7 @@ int iob_contig(FAR struct iob_s *iob, unsigned int len)
 
       /* This should always succeed because we know that:
        *
-       *   pktlen >= CONFIG_IOB_BUFSIZE >= len
+       *   pktlen >= IOB_BUFSIZE(iob) >= len
        */
 
       return 0;
@@ -63,10 +63,150 @@
 
 #define IOB_MASK      (IOB_DIVIDER - 1)
 
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: iob_free_notify
+ *
+ * Description:
+ *   Signal any threads that requested a notification when IOBs become
+ *   available.  'count' is the number of IOBs that were just freed.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_IOB_NOTIFIER
+static void iob_free_notify(int count)
+{
+  int navail;
+  int prev;
+
+  /* Check if the IOB was claimed by a thread that is blocked waiting
+   * for an IOB.
+   */
+
+  navail = iob_navail(false);
+  prev   = navail - count;
+
+  /* Signal each time the count of available IOBs reaches a new multiple of
+   * IOB_DIVIDER.  A batch of IOBs may step over the multiple itself.
+   */
+
+  if (navail > 0 &&
+      (prev < 0 || (prev & ~IOB_MASK) != (navail & ~IOB_MASK)))
+    {
+      /* Signal any threads that have requested a signal notification
+       * when an IOB becomes available.
+       */
+
+      iob_notifier_signal();
+    }
+}
+#else
+#  define iob_free_notify(c)
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: iob_release
+ *
+ * Description:
+ *   Return a list of pre-allocated I/O buffers, linked through io_flink, to
+ *   the global free list.  Buffers are handed to waiting allocators first.
+ *   This function is intended only for internal use by the IOB module.
+ *
+ ****************************************************************************/
+
+void iob_release(FAR struct iob_s *iob)
+{
+  FAR struct iob_s *tail;
+  FAR struct iob_s *next;
+  irqstate_t flags;
+  int16_t count;
+
+  DEBUGASSERT(iob != NULL);
+
+  for (tail = iob, count = 1; tail->io_flink != NULL; count++)
+    {
+      tail = tail->io_flink;
+    }
+
+  /* We don't know what context we are called from so we use extreme
+   * measures to protect the free list:  We disable interrupts very briefly.
+   */
+
+  flags = spin_lock_irqsave(&g_iob_lock);
+
+  /* If nobody is waiting for an IOB, the whole list can be put at the head
+   * of the free list at once.
+   */
+
+  if (g_iob_count >= 0
+#if CONFIG_IOB_THROTTLE > 0
+      && g_throttle_wait == 0
+#endif
+     )
+    {
+      g_iob_count    += count;
+      tail->io_flink  = g_iob_freelist;
+      g_iob_freelist  = iob;
+      spin_unlock_irqrestore(&g_iob_lock, flags);
+    }
+  else
+    {
+      for (; iob != NULL; iob = next)
+        {
+          next = iob->io_flink;
+
+          /* Which list?  If there is a task waiting for an IOB, then put
+           * the IOB on either the free list or on the committed list where
+           * it is reserved for that allocation (and not available to
+           * iob_tryalloc()). This is true for both throttled and
+           * non-throttled cases.
+           */
+
+          if (g_iob_count < 0)
+            {
+              g_iob_count++;
+              iob->io_flink   = g_iob_committed;
+              g_iob_committed = iob;
+              spin_unlock_irqrestore(&g_iob_lock, flags);
+              nxsem_post(&g_iob_sem);
+            }
+#if CONFIG_IOB_THROTTLE > 0
+          else if (g_throttle_wait > 0 && g_iob_count >= CONFIG_IOB_THROTTLE)
+            {
+              iob->io_flink   = g_iob_committed;
+              g_iob_committed = iob;
+              g_throttle_wait--;
+              spin_unlock_irqrestore(&g_iob_lock, flags);
+              nxsem_post(&g_throttle_sem);
+            }
+#endif
+          else
+            {
+              g_iob_count++;
+              iob->io_flink   = g_iob_freelist;
+              g_iob_freelist  = iob;
+              spin_unlock_irqrestore(&g_iob_lock, flags);
+            }
+
+          if (next != NULL)
+            {
+              flags = spin_lock_irqsave(&g_iob_lock);
+            }
+        }
+    }
+
+  DEBUGASSERT(g_iob_count <= CONFIG_IOB_NBUFFERS);
+
+  iob_free_notify(count);
+}
+
 /****************************************************************************
  * Name: iob_free
  *
@@ -79,10 +219,6 @@
 FAR struct iob_s *iob_free(FAR struct iob_s *iob)
 {
   FAR struct iob_s *next = iob->io_flink;
-  irqstate_t flags;
-#ifdef CONFIG_IOB_NOTIFIER
-  int16_t navail;
-#endif
 
   iobinfo("iob=%p io_pktlen=%u io_len=%u next=%p\n",
           iob, iob->io_pktlen, iob->io_len, next);
@@ -126,64 +262,30 @@ FAR struct iob_s *iob_free(FAR struct iob_s *iob)
     }
 #endif
 
-  /* Free the I/O buffer by adding it to the head of the free or the
-   * committed list. We don't know what context we are called from so
-   * we use extreme measures to protect the free list:  We disable
-   * interrupts very briefly.
-   */
-
-  flags = spin_lock_irqsave(&g_iob_lock);
-
-  /* Which list?  If there is a task waiting for an IOB, then put
-   * the IOB on either the free list or on the committed list where
-   * it is reserved for that allocation (and not available to
-   * iob_tryalloc()). This is true for both throttled and non-throttled
-   * cases.
-   */
-
-  if (g_iob_count < 0)
+#if CONFIG_IOB_LARGE_NBUFFERS > 0
+  if (IOB_IS_LARGE(iob))
     {
-      g_iob_count++;
-      iob->io_flink   = g_iob_committed;
-      g_iob_committed = iob;
-      spin_unlock_irqrestore(&g_iob_lock, flags);
-      nxsem_post(&g_iob_sem);
-    }
-#if CONFIG_IOB_THROTTLE > 0
-  else if (g_throttle_wait > 0 && g_iob_count >= CONFIG_IOB_THROTTLE)
-    {
-      iob->io_flink   = g_iob_committed;
-      g_iob_committed = iob;
-      g_throttle_wait--;
-      spin_unlock_irqrestore(&g_iob_lock, flags);
-      nxsem_post(&g_throttle_sem);
+      iob_free_large(iob);
+      return next;
     }
 #endif
-  else
-    {
-      g_iob_count++;
-      iob->io_flink   = g_iob_freelist;
-      g_iob_freelist  = iob;
-      spin_unlock_irqrestore(&g_iob_lock, flags);
-    }
-
-  DEBUGASSERT(g_iob_count <= CONFIG_IOB_NBUFFERS);
 
-#ifdef CONFIG_IOB_NOTIFIER
-  /* Check if the IOB was claimed by a thread that is blocked waiting
-   * for an IOB.
+  /* Free the I/O buffer into the cache of this CPU if possible, otherwise
+   * return it to the global free list.
    */
 
-  navail = iob_navail(false);
-  if (navail > 0 && (navail & IOB_MASK) == 0)
-    {
-      /* Signal any threads that have requested a signal notification
-       * when an IOB becomes available.
-       */
+  iob->io_flink = NULL;
 
-      iob_notifier_signal();
+#if CONFIG_IOB_PERCPU_CACHE > 0
+  if (iob_cache_free(iob))
+    {
+      iob_free_notify(1);
     }
+  else
 #endif
+    {
+      iob_release(iob);
+    }
 
   /* And return the I/O buffer after the one that was freed */
 
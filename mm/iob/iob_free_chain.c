@@ -40,18 +40,52 @@
  *
  * Description:
  *   Free an entire buffer chain, starting at the beginning of the I/O
- *   buffer chain
+ *   buffer chain.  Pre-allocated buffers are returned to the free list in
+ *   a single operation when no allocation is waiting for them.
  *
  ****************************************************************************/
 
 void iob_free_chain(FAR struct iob_s *iob)
 {
+#ifdef CONFIG_IOB_ALLOC
+  FAR struct iob_s *prev = NULL;
+  FAR struct iob_s *curr;
   FAR struct iob_s *next;
 
-  /* Free each IOB in the chain -- one at a time to keep the count straight */
+  /* Buffers with a custom free callback and large buffers don't belong to
+   * the normal pool, so they are unlinked from the chain and freed one at a
+   * time.
+   */
 
-  for (; iob; iob = next)
+  for (curr = iob; curr != NULL; curr = next)
     {
-      next = iob_free(iob);
+      next = curr->io_flink;
+      if (curr->io_free != NULL || IOB_IS_LARGE(curr))
+        {
+          if (prev != NULL)
+            {
+              prev->io_flink = next;
+            }
+          else
+            {
+              iob = next;
+            }
+
+          curr->io_flink = NULL;
+          iob_free(curr);
+        }
+      else
+        {
+          prev = curr;
+        }
+    }
+#endif
+
+  /* Return the remaining pre-allocated buffers all at once */
+
+  if (iob != NULL)
+    {
+      iobinfo("iob=%p io_pktlen=%u\n", iob, iob->io_pktlen);
+      iob_release(iob);
     }
 }
@@ -64,6 +64,15 @@ static uint8_t g_iob_buffer[IOB_BUFFER_SIZE] locate_data(IOB_SECTION);
 static uint8_t g_iob_buffer[IOB_BUFFER_SIZE];
 #endif
 
+#if CONFIG_IOB_LARGE_NBUFFERS > 0
+/* This is the pool of pre-allocated large I/O buffers.  The payload is
+ * kept separate from the iob_s instances so that it can be exchanged with
+ * the payload of a normal I/O buffer (see iob_upgrade()).
+ */
+
+static struct iob_s g_iob_large_pool[CONFIG_IOB_LARGE_NBUFFERS];
+#endif
+
 #if CONFIG_IOB_NCHAINS > 0
 /* This is a pool of pre-allocated iob_qentry_s buffers */
 
@@ -82,6 +91,22 @@ FAR struct iob_s *g_iob_freelist;
 
 FAR struct iob_s *g_iob_committed;
 
+#if CONFIG_IOB_LARGE_NBUFFERS > 0
+/* The payload memory of the large I/O buffers */
+
+#ifdef IOB_SECTION
+uint8_t g_iob_large_buffer[IOB_LARGE_BUFFER_SIZE]
+  aligned_data(CONFIG_IOB_ALIGNMENT) locate_data(IOB_SECTION);
+#else
+uint8_t g_iob_large_buffer[IOB_LARGE_BUFFER_SIZE]
+  aligned_data(CONFIG_IOB_ALIGNMENT);
+#endif
+
+/* A list of all free, unallocated large I/O buffers */
+
+FAR struct iob_s *g_iob_large_freelist;
+#endif
+
 #if CONFIG_IOB_NCHAINS > 0
 /* A list of all free, unallocated I/O buffer queue containers */
 
@@ -117,6 +142,12 @@ int16_t g_qentry_wait = 0;
 
 volatile spinlock_t g_iob_lock = SP_UNLOCKED;
 
+#if CONFIG_IOB_PERCPU_CACHE > 0
+/* The per-CPU I/O buffer caches */
+
+struct iob_cache_s g_iob_cache[CONFIG_SMP_NCPUS];
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -159,6 +190,22 @@ void iob_initialize(void)
       g_iob_freelist  = iob;
     }
 
+#if CONFIG_IOB_LARGE_NBUFFERS > 0
+  /* Attach a payload to each large I/O buffer and add it to the large
+   * buffer free list
+   */
+
+  for (i = 0; i < CONFIG_IOB_LARGE_NBUFFERS; i++)
+    {
+      FAR struct iob_s *iob = &g_iob_large_pool[i];
+
+      iob->io_flink        = g_iob_large_freelist;
+      iob->io_bufsize      = CONFIG_IOB_LARGE_BUFSIZE;
+      iob->io_data         = &g_iob_large_buffer[i * IOB_LARGE_ALIGN_SIZE];
+      g_iob_large_freelist = iob;
+    }
+#endif
+
 #if CONFIG_IOB_NCHAINS > 0
   /* Add each I/O buffer chain queue container to the free list */
 
@@ -0,0 +1,148 @@
+/****************************************************************************
+ * mm/iob/iob_large.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#include <nuttx/irq.h>
+#include <nuttx/spinlock.h>
+#include <nuttx/mm/iob.h>
+
+#include "iob.h"
+
+#if CONFIG_IOB_LARGE_NBUFFERS > 0
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: iob_tryalloc_large
+ *
+ * Description:
+ *   Try to take a buffer from the pool of large I/O buffers.  Returns NULL
+ *   if the pool is exhausted.  The large pool has no throttle reserve and
+ *   is not covered by the IOB notifier.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_tryalloc_large(void)
+{
+  FAR struct iob_s *iob;
+  irqstate_t flags;
+
+  flags = spin_lock_irqsave(&g_iob_lock);
+
+  iob = g_iob_large_freelist;
+  if (iob != NULL)
+    {
+      g_iob_large_freelist = iob->io_flink;
+
+      /* Put the I/O buffer in a known state */
+
+      iob->io_flink  = NULL; /* Not in a chain */
+      iob->io_len    = 0;    /* Length of the data in the entry */
+      iob->io_offset = 0;    /* Offset to the beginning of data */
+      iob->io_pktlen = 0;    /* Total length of the packet */
+    }
+
+  spin_unlock_irqrestore(&g_iob_lock, flags);
+  return iob;
+}
+
+/****************************************************************************
+ * Name: iob_free_large
+ *
+ * Description:
+ *   Return a large I/O buffer to the pool of large I/O buffers.
+ *
+ ****************************************************************************/
+
+void iob_free_large(FAR struct iob_s *iob)
+{
+  irqstate_t flags;
+
+  DEBUGASSERT(IOB_IS_LARGE(iob));
+
+  flags = spin_lock_irqsave(&g_iob_lock);
+  iob->io_flink        = g_iob_large_freelist;
+  g_iob_large_freelist = iob;
+  spin_unlock_irqrestore(&g_iob_lock, flags);
+}
+
+/****************************************************************************
+ * Name: iob_upgrade
+ *
+ * Description:
+ *   Move the data of a normal I/O buffer into a large buffer in place, so
+ *   that 'iob' can hold CONFIG_IOB_LARGE_BUFSIZE bytes.  Returns true if
+ *   'iob' is a large buffer on return.
+ *
+ ****************************************************************************/
+
+bool iob_upgrade(FAR struct iob_s *iob)
+{
+  FAR struct iob_s *large;
+  FAR uint8_t *data;
+  uint16_t bufsize;
+
+  /* Buffers with a custom free callback don't own their payload */
+
+  if (IOB_IS_LARGE(iob) || iob->io_free != NULL)
+    {
+      return IOB_IS_LARGE(iob);
+    }
+
+  large = iob_tryalloc_large();
+  if (large == NULL)
+    {
+      return false;
+    }
+
+  /* Copy the data to the start of the large payload, then exchange the
+   * payloads so that the chain keeps referring to 'iob'.
+   */
+
+  memcpy(large->io_data, &iob->io_data[iob->io_offset], iob->io_len);
+
+  data              = iob->io_data;
+  bufsize           = iob->io_bufsize;
+  iob->io_data      = large->io_data;
+  iob->io_bufsize   = large->io_bufsize;
+  iob->io_offset    = 0;
+  large->io_data    = data;
+  large->io_bufsize = bufsize;
+
+  /* 'large' now carries the normal payload, return it to the normal pool */
+
+  iob_free(large);
+  return true;
+}
+
+#endif /* CONFIG_IOB_LARGE_NBUFFERS > 0 */
@@ -70,6 +70,18 @@ FAR struct iob_s *iob_pack(FAR struct iob_s *iob)
     {
       next = iob->io_flink;
 
+#if CONFIG_IOB_LARGE_NBUFFERS > 0
+      /* Prefer a large buffer if the data that follows would not fit in
+       * this one.  This also eliminates the data offset.
+       */
+
+      if (next != NULL &&
+          iob->io_len + next->io_len > IOB_BUFSIZE(iob))
+        {
+          iob_upgrade(iob);
+        }
+#endif
+
       /* Eliminate the data offset in this entry */
 
       if (iob->io_offset > 0)
@@ -44,8 +44,19 @@
 
 #define SIZEOF_GAT(n) \
   ((n + 31) >> 5)
-#define SIZEOF_GRAN_S(n) \
+
+#ifdef CONFIG_GRAN_SUMMARY
+/* The summary bitmaps have one bit per GAT cell and follow the GAT */
+
+#  define SIZEOF_GATS(n) \
+  ((SIZEOF_GAT(n) + 31) >> 5)
+#  define SIZEOF_GRAN_S(n) \
+  (sizeof(struct gran_s) + \
+   sizeof(uint32_t) * (SIZEOF_GAT(n) + 2 * SIZEOF_GATS(n) - 1))
+#else
+#  define SIZEOF_GRAN_S(n) \
   (sizeof(struct gran_s) + sizeof(uint32_t) * (SIZEOF_GAT(n) - 1))
+#endif
 
 /* Debug */
 
@@ -77,6 +88,10 @@ struct gran_s
   mutex_t    lock;       /* For exclusive access to the GAT */
 #endif
   uintptr_t  heapstart; /* The aligned start of the granule heap */
+#ifdef CONFIG_GRAN_SUMMARY
+  FAR uint32_t *fmap;   /* GAT cells with at least one free granule */
+  FAR uint32_t *emap;   /* GAT cells with all granules free */
+#endif
   uint32_t   gat[1];    /* Start of the granule allocation table */
 };
 
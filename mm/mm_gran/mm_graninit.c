@@ -33,6 +33,7 @@
 #include <nuttx/kmalloc.h>
 
 #include "mm_gran/mm_gran.h"
+#include "mm_gran/mm_grantable.h"
 
 #ifdef CONFIG_GRAN
 
@@ -138,6 +139,14 @@ GRAN_HANDLE gran_initialize(FAR void *heapstart, size_t heapsize,
       priv->ngranules = ngranules;
       priv->heapstart = alignedstart;
 
+#ifdef CONFIG_GRAN_SUMMARY
+      /* The summary bitmaps live right after the GAT */
+
+      priv->fmap      = &priv->gat[SIZEOF_GAT(ngranules)];
+      priv->emap      = priv->fmap + SIZEOF_GATS(ngranules);
+      gran_summary_init(priv);
+#endif
+
       /* Initialize mutual exclusion support */
 
 #ifndef CONFIG_GRAN_INTR
@@ -90,6 +90,200 @@ uint32_t lsb_mask(uint32_t n)
   return (-n & n) & GATCFULL;
 }
 
+#ifdef CONFIG_GRAN_SUMMARY
+
+/* return the number of trailing zeros of a non-zero cell value */
+
+static inline uint32_t cell_ctz(uint32_t v)
+{
+#ifdef CONFIG_HAVE_BUILTIN_CTZ
+  return __builtin_ctz(v);
+#else
+  return DEBRUJIN_LUT[(uint32_t)(lsb_mask(v) * DEBRUJIN_NUM) >> 27];
+#endif
+}
+
+/* return the number of leading zeros of a non-zero cell value */
+
+static inline uint32_t cell_clz(uint32_t v)
+{
+#ifdef CONFIG_HAVE_BUILTIN_CLZ
+  return __builtin_clz(v);
+#else
+  return 31 - DEBRUJIN_LUT[(uint32_t)(msb_mask(v) * DEBRUJIN_NUM) >> 27];
+#endif
+}
+
+/* return a GAT cell with the bits past the last granule marked as used */
+
+static uint32_t cell_value(const gran_t *gran, uint32_t cell)
+{
+  uint32_t tail = gran->ngranules - cell * GATC_BITS(gran);
+  uint32_t v    = gran->gat[cell];
+
+  if (tail < GATC_BITS(gran))
+    {
+      v |= ~(uint32_t)(BIT(tail) - 1);
+    }
+
+  return v;
+}
+
+/* number of free granules at the bottom and at the top of a cell value */
+
+static inline uint32_t cell_bfree(uint32_t v)
+{
+  return v ? cell_ctz(v) : 32;
+}
+
+static inline uint32_t cell_tfree(uint32_t v)
+{
+  return v ? cell_clz(v) : 32;
+}
+
+/* refresh the summary bits of a GAT cell */
+
+static void cell_summary(gran_t *gran, uint32_t cell)
+{
+  uint32_t v    = cell_value(gran, cell);
+  uint32_t mask = BIT(cell & 31);
+
+  if (v != GATCFULL)
+    {
+      gran->fmap[cell >> 5] |= mask;
+    }
+  else
+    {
+      gran->fmap[cell >> 5] &= ~mask;
+    }
+
+  if (v == 0)
+    {
+      gran->emap[cell >> 5] |= mask;
+    }
+  else
+    {
+      gran->emap[cell >> 5] &= ~mask;
+    }
+}
+
+/* return the first cell at or after posi whose summary bit equals val, or
+ * ncells if there is none.
+ */
+
+static uint32_t map_next(const uint32_t *map, uint32_t posi,
+                         uint32_t ncells, bool val)
+{
+  uint32_t idx = posi >> 5;
+  uint32_t v;
+
+  if (posi >= ncells)
+    {
+      return ncells;
+    }
+
+  v = (val ? map[idx] : ~map[idx]) & ~(uint32_t)(BIT(posi & 31) - 1);
+  while (v == 0)
+    {
+      if (++idx >= SIZEOF_GAT(ncells))
+        {
+          return ncells;
+        }
+
+      v = val ? map[idx] : ~map[idx];
+    }
+
+  posi = (idx << 5) + cell_ctz(v);
+  return posi < ncells ? posi : ncells;
+}
+
+/* search for a free range using the summary bitmaps */
+
+static int gran_search_summary(const gran_t *gran, size_t size)
+{
+  uint32_t ncells = SIZEOF_GAT(gran->ngranules);
+  uint32_t prev   = UINT32_MAX;
+  uint32_t c;
+  uint32_t e;
+  uint32_t v;
+  uint32_t m;
+  size_t   run;
+  size_t   len;
+
+  if (size >= 2 * 32 - 1)
+    {
+      /* A range this long covers at least one completely free cell: check
+       * each stretch of free cells together with the free granules at the
+       * top of the cell before it and at the bottom of the cell after it.
+       */
+
+      for (c = map_next(gran->emap, 0, ncells, true); c < ncells;
+           c = map_next(gran->emap, e, ncells, true))
+        {
+          e   = map_next(gran->emap, c, ncells, false);
+          len = c > 0 ? cell_tfree(cell_value(gran, c - 1)) : 0;
+          run = len + ((size_t)(e - c) << 5);
+          if (e < ncells)
+            {
+              run += cell_bfree(cell_value(gran, e));
+            }
+
+          if (run >= size)
+            {
+              return (c << 5) - len;
+            }
+        }
+
+      return -ENOMEM;
+    }
+
+  /* Shorter ranges: walk the cells having free granules, carrying the
+   * free run at the top of the previous cell over to the next one.
+   */
+
+  run = 0;
+  for (c = map_next(gran->fmap, 0, ncells, true); c < ncells;
+       c = map_next(gran->fmap, c + 1, ncells, true))
+    {
+      if (c != prev + 1)
+        {
+          run = 0;
+        }
+
+      prev = c;
+      v    = cell_value(gran, c);
+      if (run + cell_bfree(v) >= size)
+        {
+          return (c << 5) - run;
+        }
+
+      if (size <= 32)
+        {
+          /* Shrink the free mask so that each remaining bit starts a free
+           * run of at least size granules within the cell.
+           */
+
+          m = ~v;
+          for (len = 1; m && len < size; )
+            {
+              e    = len < size - len ? len : size - len;
+              m   &= m >> e;
+              len += e;
+            }
+
+          if (m)
+            {
+              return (c << 5) + cell_ctz(m);
+            }
+        }
+
+      run = v ? cell_tfree(v) : run + 32;
+    }
+
+  return -ENOMEM;
+}
+#endif /* CONFIG_GRAN_SUMMARY */
+
 /* set or clear a GAT cell with given bit mask */
 
 static void cell_set(gran_t *gran, uint32_t cell, uint32_t mask, bool val)
@@ -102,6 +296,10 @@ static void cell_set(gran_t *gran, uint32_t cell, uint32_t mask, bool val)
     {
       gran->gat[cell] &= ~mask;
     }
+
+#ifdef CONFIG_GRAN_SUMMARY
+  cell_summary(gran, cell);
+#endif
 }
 
 /* set or clear a range of GAT bits */
@@ -266,6 +464,9 @@ int gran_search(const gran_t *gran, size_t size)
       return ret;
     }
 
+#ifdef CONFIG_GRAN_SUMMARY
+  return gran_search_summary(gran, size);
+#else
   ret = -ENOMEM;
   for (size_t i = 0; i <= gran->ngranules - size; i++)
     {
@@ -277,6 +478,7 @@ int gran_search(const gran_t *gran, size_t size)
     }
 
   return ret;
+#endif
 }
 
 /* set a range of granules */
@@ -309,4 +511,19 @@ int gran_clear(gran_t *gran, size_t posi, size_t size)
   return ret;
 }
 
+#ifdef CONFIG_GRAN_SUMMARY
+
+/* build the summary bitmaps from the GAT */
+
+void gran_summary_init(gran_t *gran)
+{
+  uint32_t c;
+
+  for (c = 0; c < SIZEOF_GAT(gran->ngranules); c++)
+    {
+      cell_summary(gran, c);
+    }
+}
+#endif
+
 #endif /* CONFIG_GRAN */
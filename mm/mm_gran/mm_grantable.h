@@ -159,4 +159,18 @@ int gran_search(const gran_t *gran, size_t size);
 int gran_set(gran_t *gran, size_t posi, size_t size);
 int gran_clear(gran_t *gran, size_t posi, size_t size);
 
+/****************************************************************************
+ * Name: gran_summary_init
+ *
+ * Description:
+ *   Build the summary bitmaps from the current GAT content
+ *
+ * Input Parameters:
+ *   gran   - Pointer to the gran state
+ ****************************************************************************/
+
+#ifdef CONFIG_GRAN_SUMMARY
+void gran_summary_init(gran_t *gran);
+#endif
+
 #endif /* __MM_MM_GRAN_MM_GRANTABLE_H */
@@ -0,0 +1,710 @@
+/****************************************************************************
+ * mm/mm_gran/mm_pgbuddy.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+#include <debug.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <strings.h>
+
+#include <nuttx/irq.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/pgalloc.h>
+#include <nuttx/sched.h>
+#include <nuttx/spinlock.h>
+
+#ifdef CONFIG_MM_PGALLOC_BUDDY
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+/* CONFIG_MM_PGALLOC_BUDDY_MAXORDER - Blocks of up to 2^MAXORDER pages are
+ *   managed, larger allocations fail.
+ * CONFIG_MM_PGALLOC_BUDDY_PCPU - The number of single pages cached per CPU,
+ *   0 disables the per-CPU caches.
+ */
+
+#define PGBUDDY_NORDERS   (CONFIG_MM_PGALLOC_BUDDY_MAXORDER + 1)
+#define PGBUDDY_NONE      UINT32_MAX
+
+/* Flags kept with the order in the page descriptor of the first page of a
+ * free block.
+ */
+
+#define PGBUDDY_FREE      0x80
+#define PGBUDDY_ORDERMASK 0x1f
+
+/* Number of pages moved between a per-CPU cache and the buddy lists */
+
+#define PGBUDDY_BATCH     ((CONFIG_MM_PGALLOC_BUDDY_PCPU + 1) / 2)
+
+/* Debug */
+
+#ifdef CONFIG_DEBUG_PGALLOC
+#  define pgaerr                    _err
+#  define pgawarn                   _warn
+#  define pgainfo                   _info
+#else
+#  define pgaerr                    merr
+#  define pgawarn                   mwarn
+#  define pgainfo                   minfo
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One descriptor per page.  The links are only meaningful for the first
+ * page of a free block.
+ */
+
+struct pgbuddy_page_s
+{
+  uint32_t flink;                     /* Next free block of the same order */
+  uint32_t blink;                     /* Previous free block */
+  uint8_t  state;                     /* PGBUDDY_FREE | order */
+};
+
+#if CONFIG_MM_PGALLOC_BUDDY_PCPU > 0
+struct pgbuddy_pcpu_s
+{
+  spinlock_t lock;                    /* Protects the cache of one CPU */
+  uint32_t npages;                    /* Number of cached pages */
+  uint32_t pages[CONFIG_MM_PGALLOC_BUDDY_PCPU];
+};
+#endif
+
+struct pgbuddy_s
+{
+  uintptr_t base;                     /* Address of page 0 */
+  uint32_t npages;                    /* Number of pages managed */
+  uint32_t nfree;                     /* Number of pages on the free lists */
+  uint32_t freelist[PGBUDDY_NORDERS]; /* Free blocks of each order */
+  FAR struct pgbuddy_page_s *pages;   /* Page descriptors */
+  spinlock_t lock;                    /* Protects everything above */
+#if CONFIG_MM_PGALLOC_BUDDY_PCPU > 0
+  struct pgbuddy_pcpu_s pcpu[CONFIG_SMP_NCPUS];
+#endif
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The state of the page allocator */
+
+static struct pgbuddy_s g_pgbuddy;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: pgbuddy_insert / pgbuddy_remove
+ *
+ * Description:
+ *   Add or remove a block to/from the free list of its order.
+ *
+ ****************************************************************************/
+
+static void pgbuddy_insert(uint32_t idx, unsigned int order)
+{
+  FAR struct pgbuddy_page_s *page = &g_pgbuddy.pages[idx];
+  uint32_t head = g_pgbuddy.freelist[order];
+
+  page->state = PGBUDDY_FREE | order;
+  page->blink = PGBUDDY_NONE;
+  page->flink = head;
+  if (head != PGBUDDY_NONE)
+    {
+      g_pgbuddy.pages[head].blink = idx;
+    }
+
+  g_pgbuddy.freelist[order] = idx;
+  g_pgbuddy.nfree += 1 << order;
+}
+
+static void pgbuddy_remove(uint32_t idx, unsigned int order)
+{
+  FAR struct pgbuddy_page_s *page = &g_pgbuddy.pages[idx];
+
+  if (page->blink != PGBUDDY_NONE)
+    {
+      g_pgbuddy.pages[page->blink].flink = page->flink;
+    }
+  else
+    {
+      g_pgbuddy.freelist[order] = page->flink;
+    }
+
+  if (page->flink != PGBUDDY_NONE)
+    {
+      g_pgbuddy.pages[page->flink].blink = page->blink;
+    }
+
+  page->state = 0;
+  g_pgbuddy.nfree -= 1 << order;
+}
+
+/****************************************************************************
+ * Name: pgbuddy_free_block
+ *
+ * Description:
+ *   Free a block of 2^order pages, merging it with its buddy as long as
+ *   the buddy is free and of the same order.
+ *
+ ****************************************************************************/
+
+static void pgbuddy_free_block(uint32_t idx, unsigned int order)
+{
+  while (order < CONFIG_MM_PGALLOC_BUDDY_MAXORDER)
+    {
+      uint32_t buddy = idx ^ (1u << order);
+
+      if (buddy + (1u << order) > g_pgbuddy.npages ||
+          g_pgbuddy.pages[buddy].state != (PGBUDDY_FREE | order))
+        {
+          break;
+        }
+
+      pgbuddy_remove(buddy, order);
+      idx &= ~(1u << order);
+      order++;
+    }
+
+  pgbuddy_insert(idx, order);
+}
+
+/****************************************************************************
+ * Name: pgbuddy_free_range
+ *
+ * Description:
+ *   Free an arbitrary run of pages by splitting it into the largest
+ *   naturally aligned blocks.
+ *
+ ****************************************************************************/
+
+static void pgbuddy_free_range(uint32_t idx, uint32_t npages)
+{
+  while (npages > 0)
+    {
+      unsigned int order = CONFIG_MM_PGALLOC_BUDDY_MAXORDER;
+
+      if (idx != 0 && (unsigned int)ffs(idx) - 1 < order)
+        {
+          order = ffs(idx) - 1;
+        }
+
+      while ((1u << order) > npages)
+        {
+          order--;
+        }
+
+      pgbuddy_free_block(idx, order);
+      idx    += 1u << order;
+      npages -= 1u << order;
+    }
+}
+
+/****************************************************************************
+ * Name: pgbuddy_alloc_block
+ *
+ * Description:
+ *   Take a block of 2^order pages, splitting a larger block if needed.
+ *   Returns the index of the first page or PGBUDDY_NONE.
+ *
+ ****************************************************************************/
+
+static uint32_t pgbuddy_alloc_block(unsigned int order)
+{
+  unsigned int i;
+  uint32_t idx;
+
+  for (i = order; i < PGBUDDY_NORDERS; i++)
+    {
+      if (g_pgbuddy.freelist[i] != PGBUDDY_NONE)
+        {
+          break;
+        }
+    }
+
+  if (i >= PGBUDDY_NORDERS)
+    {
+      return PGBUDDY_NONE;
+    }
+
+  idx = g_pgbuddy.freelist[i];
+  pgbuddy_remove(idx, i);
+
+  /* Give the upper halves back until the block has the requested order */
+
+  while (i > order)
+    {
+      i--;
+      pgbuddy_insert(idx + (1u << i), i);
+    }
+
+  return idx;
+}
+
+/****************************************************************************
+ * Name: pgbuddy_alloc
+ *
+ * Description:
+ *   Allocate exactly npages contiguous pages.  The unused tail of the
+ *   power-of-two block is freed again.
+ *
+ ****************************************************************************/
+
+static uint32_t pgbuddy_alloc(uint32_t npages)
+{
+  unsigned int order = 0;
+  uint32_t idx;
+
+  while ((1u << order) < npages)
+    {
+      order++;
+    }
+
+  if (order > CONFIG_MM_PGALLOC_BUDDY_MAXORDER)
+    {
+      return PGBUDDY_NONE;
+    }
+
+  idx = pgbuddy_alloc_block(order);
+  if (idx != PGBUDDY_NONE && npages < (1u << order))
+    {
+      pgbuddy_free_range(idx + npages, (1u << order) - npages);
+    }
+
+  return idx;
+}
+
+/****************************************************************************
+ * Name: pgbuddy_pcpu_alloc / pgbuddy_pcpu_free
+ *
+ * Description:
+ *   Single page allocations are served from a small per-CPU cache that is
+ *   refilled and drained in batches, so that most of them don't touch the
+ *   shared lock.  The cache lock is only contended when another CPU drains
+ *   the caches; it is always taken before the shared lock.
+ *
+ ****************************************************************************/
+
+#if CONFIG_MM_PGALLOC_BUDDY_PCPU > 0
+static uint32_t pgbuddy_pcpu_alloc(void)
+{
+  FAR struct pgbuddy_pcpu_s *pcpu;
+  irqstate_t flags;
+  uint32_t idx;
+
+  flags = up_irq_save();
+  pcpu  = &g_pgbuddy.pcpu[this_cpu()];
+  spin_lock(&pcpu->lock);
+
+  if (pcpu->npages == 0)
+    {
+      spin_lock(&g_pgbuddy.lock);
+      while (pcpu->npages < PGBUDDY_BATCH)
+        {
+          idx = pgbuddy_alloc_block(0);
+          if (idx == PGBUDDY_NONE)
+            {
+              break;
+            }
+
+          pcpu->pages[pcpu->npages++] = idx;
+        }
+
+      spin_unlock(&g_pgbuddy.lock);
+    }
+
+  idx = pcpu->npages > 0 ? pcpu->pages[--pcpu->npages] : PGBUDDY_NONE;
+  spin_unlock(&pcpu->lock);
+  up_irq_restore(flags);
+  return idx;
+}
+
+static void pgbuddy_pcpu_free(uint32_t idx)
+{
+  FAR struct pgbuddy_pcpu_s *pcpu;
+  irqstate_t flags;
+
+  flags = up_irq_save();
+  pcpu  = &g_pgbuddy.pcpu[this_cpu()];
+  spin_lock(&pcpu->lock);
+
+  if (pcpu->npages >= CONFIG_MM_PGALLOC_BUDDY_PCPU)
+    {
+      spin_lock(&g_pgbuddy.lock);
+      while (pcpu->npages > CONFIG_MM_PGALLOC_BUDDY_PCPU - PGBUDDY_BATCH)
+        {
+          pgbuddy_free_block(pcpu->pages[--pcpu->npages], 0);
+        }
+
+      spin_unlock(&g_pgbuddy.lock);
+    }
+
+  pcpu->pages[pcpu->npages++] = idx;
+  spin_unlock(&pcpu->lock);
+  up_irq_restore(flags);
+}
+
+/****************************************************************************
+ * Name: pgbuddy_pcpu_drain
+ *
+ * Description:
+ *   Return the pages cached by all CPUs to the buddy lists.  Called
+ *   without the shared lock when an allocation fails.
+ *
+ ****************************************************************************/
+
+static bool pgbuddy_pcpu_drain(void)
+{
+  bool drained = false;
+  irqstate_t flags;
+  int cpu;
+
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      FAR struct pgbuddy_pcpu_s *pcpu = &g_pgbuddy.pcpu[cpu];
+
+      flags = spin_lock_irqsave(&pcpu->lock);
+      if (pcpu->npages > 0)
+        {
+          spin_lock(&g_pgbuddy.lock);
+          while (pcpu->npages > 0)
+            {
+              pgbuddy_free_block(pcpu->pages[--pcpu->npages], 0);
+            }
+
+          spin_unlock(&g_pgbuddy.lock);
+          drained = true;
+        }
+
+      spin_unlock_irqrestore(&pcpu->lock, flags);
+    }
+
+  return drained;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_pginitialize
+ *
+ * Description:
+ *   Initialize the page allocator.
+ *
+ * Input Parameters:
+ *   heap_start - The physical address of the start of memory region that
+ *                will be used for the page allocator heap
+ *   heap_size  - The size (in bytes) of the memory region that will be used
+ *                for the page allocator heap.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void mm_pginitialize(FAR void *heap_start, size_t heap_size)
+{
+  uintptr_t base = MM_PGALIGNUP(heap_start);
+  uintptr_t end  = MM_PGALIGNDOWN((uintptr_t)heap_start + heap_size);
+  unsigned int i;
+
+  DEBUGASSERT(end > base);
+
+  g_pgbuddy.base   = base;
+  g_pgbuddy.npages = (end - base) >> MM_PGSHIFT;
+  g_pgbuddy.pages  = kmm_zalloc(g_pgbuddy.npages *
+                                sizeof(struct pgbuddy_page_s));
+  DEBUGASSERT(g_pgbuddy.pages != NULL);
+
+  for (i = 0; i < PGBUDDY_NORDERS; i++)
+    {
+      g_pgbuddy.freelist[i] = PGBUDDY_NONE;
+    }
+
+  spin_lock_init(&g_pgbuddy.lock);
+#if CONFIG_MM_PGALLOC_BUDDY_PCPU > 0
+  for (i = 0; i < CONFIG_SMP_NCPUS; i++)
+    {
+      spin_lock_init(&g_pgbuddy.pcpu[i].lock);
+    }
+#endif
+
+  pgbuddy_free_range(0, g_pgbuddy.npages);
+
+  pgainfo("%" PRIu32 " pages at %" PRIxPTR "\n", g_pgbuddy.npages, base);
+}
+
+/****************************************************************************
+ * Name: mm_pgreserve
+ *
+ * Description:
+ *   Reserve memory in the page memory pool.  This will reserve the pages
+ *   that contain the start and end addresses plus all of the pages
+ *   in between.  This should be done early in the initialization sequence
+ *   before any other allocations are made.
+ *
+ *   Reserved memory can never be allocated (it can be freed however which
+ *   essentially unreserves the memory).
+ *
+ * Input Parameters:
+ *   start  - The address of the beginning of the region to be reserved.
+ *   size   - The size of the region to be reserved
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void mm_pgreserve(uintptr_t start, size_t size)
+{
+  uintptr_t base = MM_PGALIGNDOWN(start);
+  uintptr_t end  = MM_PGALIGNUP(start + size);
+  uint32_t first;
+  uint32_t last;
+  uint32_t idx;
+  irqstate_t flags;
+
+  DEBUGASSERT(base >= g_pgbuddy.base);
+
+  first = (base - g_pgbuddy.base) >> MM_PGSHIFT;
+  last  = (end - g_pgbuddy.base) >> MM_PGSHIFT;
+  DEBUGASSERT(last <= g_pgbuddy.npages);
+
+  flags = spin_lock_irqsave(&g_pgbuddy.lock);
+
+  /* For each page in the range, take the free block that contains it out
+   * of the free lists and give back the parts outside of the range.
+   */
+
+  for (idx = first; idx < last; )
+    {
+      unsigned int order;
+      uint32_t head = PGBUDDY_NONE;
+      uint32_t tail;
+
+      for (order = 0; order < PGBUDDY_NORDERS; order++)
+        {
+          uint32_t tmp = idx & ~((1u << order) - 1);
+
+          if (g_pgbuddy.pages[tmp].state == (PGBUDDY_FREE | order))
+            {
+              head = tmp;
+              break;
+            }
+        }
+
+      if (head == PGBUDDY_NONE)
+        {
+          /* Already reserved */
+
+          idx++;
+          continue;
+        }
+
+      pgbuddy_remove(head, order);
+      tail = head + (1u << order);
+
+      if (head < first)
+        {
+          pgbuddy_free_range(head, first - head);
+        }
+
+      if (tail > last)
+        {
+          pgbuddy_free_range(last, tail - last);
+        }
+
+      idx = tail;
+    }
+
+  spin_unlock_irqrestore(&g_pgbuddy.lock, flags);
+}
+
+/****************************************************************************
+ * Name: mm_pgalloc
+ *
+ * Description:
+ *   Allocate page memory from the page memory pool.
+ *
+ * Input Parameters:
+ *   npages - The number of pages to allocate, each of size CONFIG_MM_PGSIZE.
+ *
+ * Returned Value:
+ *   On success, a non-zero, physical address of the allocated page memory
+ *   is returned.  Zero is returned on failure.  NOTE:  This is an unmapped
+ *   physical address and cannot be used until it is appropriately mapped.
+ *
+ ****************************************************************************/
+
+uintptr_t mm_pgalloc(unsigned int npages)
+{
+  irqstate_t flags;
+  uint32_t idx;
+
+  if (npages == 0)
+    {
+      return 0;
+    }
+
+#if CONFIG_MM_PGALLOC_BUDDY_PCPU > 0
+  if (npages == 1)
+    {
+      idx = pgbuddy_pcpu_alloc();
+      if (idx != PGBUDDY_NONE)
+        {
+          return g_pgbuddy.base + ((uintptr_t)idx << MM_PGSHIFT);
+        }
+    }
+#endif
+
+  flags = spin_lock_irqsave(&g_pgbuddy.lock);
+  idx   = pgbuddy_alloc(npages);
+  spin_unlock_irqrestore(&g_pgbuddy.lock, flags);
+
+#if CONFIG_MM_PGALLOC_BUDDY_PCPU > 0
+  /* The pages held by the per-CPU caches may be what is missing */
+
+  if (idx == PGBUDDY_NONE && pgbuddy_pcpu_drain())
+    {
+      flags = spin_lock_irqsave(&g_pgbuddy.lock);
+      idx   = pgbuddy_alloc(npages);
+      spin_unlock_irqrestore(&g_pgbuddy.lock, flags);
+    }
+#endif
+
+  if (idx == PGBUDDY_NONE)
+    {
+      pgawarn("WARNING: Failed to allocate %u pages\n", npages);
+      return 0;
+    }
+
+  return g_pgbuddy.base + ((uintptr_t)idx << MM_PGSHIFT);
+}
+
+/****************************************************************************
+ * Name: mm_pgfree
+ *
+ * Description:
+ *   Return page memory to the page memory pool.
+ *
+ * Input Parameters:
+ *   paddr  - A physical address to a page in the page memory pool previously
+ *            allocated by mm_pgalloc.
+ *   npages - The number of contiguous pages to be return to the page memory
+ *            pool, beginning with the page at paddr;
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void mm_pgfree(uintptr_t paddr, unsigned int npages)
+{
+  irqstate_t flags;
+  uint32_t idx;
+
+  DEBUGASSERT(MM_ISALIGNED(paddr) && paddr >= g_pgbuddy.base);
+
+  idx = (paddr - g_pgbuddy.base) >> MM_PGSHIFT;
+  DEBUGASSERT(idx + npages <= g_pgbuddy.npages);
+
+#if CONFIG_MM_PGALLOC_BUDDY_PCPU > 0
+  if (npages == 1)
+    {
+      pgbuddy_pcpu_free(idx);
+      return;
+    }
+#endif
+
+  flags = spin_lock_irqsave(&g_pgbuddy.lock);
+  pgbuddy_free_range(idx, npages);
+  spin_unlock_irqrestore(&g_pgbuddy.lock, flags);
+}
+
+/****************************************************************************
+ * Name: mm_pginfo
+ *
+ * Description:
+ *   Return information about the page allocator.  Pages held by the
+ *   per-CPU caches are counted as free; mxfree is the size of the largest
+ *   free buddy block.
+ *
+ * Input Parameters:
+ *   info   - Memory location to return the page allocator info.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void mm_pginfo(FAR struct pginfo_s *info)
+{
+  irqstate_t flags;
+  uint32_t nfree;
+  int order;
+
+  DEBUGASSERT(info != NULL);
+
+  flags = spin_lock_irqsave(&g_pgbuddy.lock);
+
+  nfree = g_pgbuddy.nfree;
+#if CONFIG_MM_PGALLOC_BUDDY_PCPU > 0
+  for (order = 0; order < CONFIG_SMP_NCPUS; order++)
+    {
+      nfree += g_pgbuddy.pcpu[order].npages;
+    }
+#endif
+
+  for (order = CONFIG_MM_PGALLOC_BUDDY_MAXORDER; order >= 0; order--)
+    {
+      if (g_pgbuddy.freelist[order] != PGBUDDY_NONE)
+        {
+          break;
+        }
+    }
+
+  info->ntotal = g_pgbuddy.npages;
+  info->nfree  = nfree;
+  info->mxfree = order >= 0 ? 1u << order : 0;
+
+  spin_unlock_irqrestore(&g_pgbuddy.lock, flags);
+}
+
+#endif /* CONFIG_MM_PGALLOC_BUDDY */
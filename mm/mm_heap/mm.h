@@ -175,6 +175,10 @@ struct mm_allocnode_s
 {
   mmsize_t preceding;                       /* Physical preceding chunk size */
   mmsize_t size;                            /* Size of this chunk */
+#ifdef CONFIG_MM_ACCOUNTING
+  pid_t owner;                              /* The owner task group */
+  uint32_t ownergen;                        /* tg_heapgen of the owner */
+#endif
 #if CONFIG_MM_BACKTRACE >= 0
   pid_t pid;                                /* The pid for caller */
   unsigned long seqno;                      /* The sequence of memory malloc */
@@ -190,6 +194,10 @@ struct mm_freenode_s
 {
   mmsize_t preceding;                       /* Physical preceding chunk size */
   mmsize_t size;                            /* Size of this chunk */
+#ifdef CONFIG_MM_ACCOUNTING
+  pid_t owner;                              /* The owner task group */
+  uint32_t ownergen;                        /* tg_heapgen of the owner */
+#endif
 #if CONFIG_MM_BACKTRACE >= 0
   pid_t pid;                                /* The pid for caller */
   unsigned long seqno;                      /* The sequence of memory malloc */
@@ -242,6 +250,12 @@ struct mm_heap_s
   int mm_nregions;
 #endif
 
+#ifdef CONFIG_MM_REGION_ATTR
+  /* The MM_REGION_* attributes of each region */
+
+  unsigned int mm_regionattr[CONFIG_MM_REGIONS];
+#endif
+
   /* All free nodes are maintained in a doubly linked list.  This
    * array provides some hooks into the list at various points to
    * speed up searching of free nodes.
@@ -298,6 +312,43 @@ void mm_foreach(FAR struct mm_heap_s *heap, mm_node_handler_t handler,
 /* Functions contained in mm_free.c *****************************************/
 
 void mm_delayfree(FAR struct mm_heap_s *heap, FAR void *mem, bool delay);
+void mm_freelocked(FAR struct mm_heap_s *heap, FAR void *mem);
+
+/* Functions contained in mm_account.c **************************************/
+
+#if defined(CONFIG_MM_ACCOUNTING) && \
+    (defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__))
+bool mm_account_check(size_t size);
+void mm_account_alloc(FAR struct mm_allocnode_s *node);
+void mm_account_free(FAR struct mm_allocnode_s *node);
+#else
+#  define mm_account_check(size) true
+#  define mm_account_alloc(node)
+#  define mm_account_free(node)
+#endif
+
+/* Functions contained in mm_region.c ***************************************/
+
+#define MM_REGION_ALL UINT32_MAX
+
+#ifdef CONFIG_MM_REGION_ATTR
+uint32_t mm_region_mask(FAR struct mm_heap_s *heap, unsigned int hint);
+bool mm_region_member(FAR struct mm_heap_s *heap, FAR void *node,
+                      uint32_t regions);
+unsigned int mm_region_hint(void);
+#else
+#  define mm_region_member(heap, node, regions) true
+#endif
+
+/* Functions contained in mm_guard.c ****************************************/
+
+#ifdef CONFIG_MM_GUARD
+FAR void *mm_guard_malloc(FAR struct mm_heap_s *heap, size_t size,
+                          size_t alignment);
+bool mm_guard_free(FAR void *mem);
+bool mm_guard_member(FAR struct mm_heap_s *heap, FAR void *mem);
+size_t mm_guard_size(FAR void *mem);
+#endif
 
 /****************************************************************************
  * Inline Functions
@@ -0,0 +1,159 @@
+/****************************************************************************
+ * mm/mm_heap/mm_account.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/resource.h>
+#include <assert.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/atomic.h>
+#include <nuttx/sched.h>
+#include <nuttx/mm/mm.h>
+
+#include "mm_heap/mm.h"
+#include "sched/sched.h"
+
+#if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_account_group
+ *
+ * Description:
+ *   Return the task group to charge for an allocation made now, or NULL if
+ *   the allocation is not accounted.
+ *
+ ****************************************************************************/
+
+static FAR struct task_group_s *mm_account_group(void)
+{
+  FAR struct tcb_s *tcb;
+
+  if (up_interrupt_context())
+    {
+      return NULL;
+    }
+
+  tcb = this_task();
+  return tcb != NULL ? tcb->group : NULL;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_account_check
+ *
+ * Description:
+ *   Return false if allocating 'size' more bytes would take the calling
+ *   task group over its RLIMIT_DATA limit.
+ *
+ ****************************************************************************/
+
+bool mm_account_check(size_t size)
+{
+  FAR struct task_group_s *group = mm_account_group();
+
+  return group == NULL ||
+         group->tg_datalimit.rlim_cur == RLIM_INFINITY ||
+         (rlim_t)(uint32_t)atomic_read(&group->tg_heapused) + size <=
+         group->tg_datalimit.rlim_cur;
+}
+
+/****************************************************************************
+ * Name: mm_account_alloc
+ *
+ * Description:
+ *   Charge a newly allocated node to the calling task group.
+ *
+ ****************************************************************************/
+
+void mm_account_alloc(FAR struct mm_allocnode_s *node)
+{
+  FAR struct task_group_s *group = mm_account_group();
+  size_t nodesize = MM_SIZEOF_NODE(node);
+  size_t used;
+
+  if (group == NULL)
+    {
+      node->owner = INVALID_PROCESS_ID;
+      return;
+    }
+
+  node->owner    = group->tg_pid;
+  node->ownergen = group->tg_heapgen;
+  used = (uint32_t)atomic_fetch_add(&group->tg_heapused, nodesize) +
+         nodesize;
+
+  /* The peak is only informative, a lost update is harmless */
+
+  if (used > group->tg_heappeak)
+    {
+      group->tg_heappeak = used;
+    }
+}
+
+/****************************************************************************
+ * Name: mm_account_free
+ *
+ * Description:
+ *   Give the size of a node back to the task group that owns it, if that
+ *   group still exists.  A group that reused the pid of the owner has a
+ *   different generation and is not charged.
+ *
+ ****************************************************************************/
+
+void mm_account_free(FAR struct mm_allocnode_s *node)
+{
+  FAR struct task_group_s *group;
+  FAR struct tcb_s *tcb;
+
+  if (node->owner == INVALID_PROCESS_ID)
+    {
+      return;
+    }
+
+  tcb = nxsched_get_tcb(node->owner);
+  if (tcb == NULL || tcb->group == NULL)
+    {
+      return;
+    }
+
+  group = tcb->group;
+  if (group->tg_pid == node->owner && group->tg_heapgen == node->ownergen)
+    {
+      atomic_fetch_sub(&group->tg_heapused, MM_SIZEOF_NODE(node));
+    }
+
+  node->owner = INVALID_PROCESS_ID;
+}
+
+#endif /* CONFIG_BUILD_FLAT || __KERNEL__ */
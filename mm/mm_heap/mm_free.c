@@ -83,12 +83,6 @@ static void add_delaylist(FAR struct mm_heap_s *heap, FAR void *mem)
 
 void mm_delayfree(FAR struct mm_heap_s *heap, FAR void *mem, bool delay)
 {
-  FAR struct mm_freenode_s *node;
-  FAR struct mm_freenode_s *prev;
-  FAR struct mm_freenode_s *next;
-  size_t nodesize;
-  size_t prevsize;
-
   if (mm_lock(heap) < 0)
     {
       /* Meet -ESRCH return, which means we are in situations
@@ -100,31 +94,50 @@ void mm_delayfree(FAR struct mm_heap_s *heap, FAR void *mem, bool delay)
       return;
     }
 
-  nodesize = mm_malloc_size(heap, mem);
+  if (delay)
+    {
 #ifdef CONFIG_MM_FILL_ALLOCATIONS
-#if CONFIG_MM_FREE_DELAYCOUNT_MAX > 0
+      memset(mem, MM_FREE_MAGIC, mm_malloc_size(heap, mem));
+#endif
+      kasan_poison(mem, mm_malloc_size(heap, mem));
+      mm_unlock(heap);
+      add_delaylist(heap, mem);
+      return;
+    }
+
+  mm_freelocked(heap, mem);
+  mm_unlock(heap);
+}
+
+/****************************************************************************
+ * Name: mm_freelocked
+ *
+ * Description:
+ *   Return a chunk to the free node list, the caller holds the heap lock.
+ *
+ ****************************************************************************/
+
+void mm_freelocked(FAR struct mm_heap_s *heap, FAR void *mem)
+{
+  FAR struct mm_freenode_s *node;
+  FAR struct mm_freenode_s *prev;
+  FAR struct mm_freenode_s *next;
+  size_t nodesize;
+  size_t prevsize;
+
+  nodesize = mm_malloc_size(heap, mem);
+#if defined(CONFIG_MM_FILL_ALLOCATIONS) && CONFIG_MM_FREE_DELAYCOUNT_MAX == 0
   /* If delay free is enabled, a memory node will be freed twice.
    * The first time is to add the node to the delay list, and the second
    * time is to actually free the node. Therefore, we only colorize the
    * memory node the first time, when `delay` is set to true.
    */
 
-  if (delay)
-#endif
-    {
-      memset(mem, MM_FREE_MAGIC, nodesize);
-    }
+  memset(mem, MM_FREE_MAGIC, nodesize);
 #endif
 
   kasan_poison(mem, nodesize);
 
-  if (delay)
-    {
-      mm_unlock(heap);
-      add_delaylist(heap, mem);
-      return;
-    }
-
   /* Map the memory chunk into a free node */
 
   node = (FAR struct mm_freenode_s *)
@@ -135,6 +148,7 @@ void mm_delayfree(FAR struct mm_heap_s *heap, FAR void *mem, bool delay)
 
   DEBUGASSERT(MM_NODE_IS_ALLOC(node));
 
+  mm_account_free((FAR struct mm_allocnode_s *)node);
   node->size &= ~MM_ALLOC_BIT;
 
   /* Update heap statistics */
@@ -217,7 +231,6 @@ void mm_delayfree(FAR struct mm_heap_s *heap, FAR void *mem, bool delay)
   /* Add the merged node to the nodelist */
 
   mm_addfreechunk(heap, node);
-  mm_unlock(heap);
 }
 
 /****************************************************************************
@@ -242,6 +255,13 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
 
   DEBUGASSERT(mm_heapmember(heap, mem));
 
+#ifdef CONFIG_MM_GUARD
+  if (mm_guard_free(mem))
+    {
+      return;
+    }
+#endif
+
 #ifdef CONFIG_MM_HEAP_MEMPOOL
   if (heap->mm_mpool)
     {
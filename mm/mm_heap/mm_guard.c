@@ -0,0 +1,568 @@
+/****************************************************************************
+ * mm/mm_heap/mm_guard.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+#include <debug.h>
+#include <string.h>
+#include <sched.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/atomic.h>
+#include <nuttx/irq.h>
+#include <nuttx/spinlock.h>
+#include <nuttx/mm/mm.h>
+
+#include "mm_heap/mm.h"
+
+#ifdef CONFIG_MM_GUARD
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define MM_GUARD_PAGESIZE  CONFIG_MM_GUARD_PAGESIZE
+#define MM_GUARD_NSLOTS    CONFIG_MM_GUARD_NSLOTS
+
+/* The pool starts with a guard region and each slot is followed by one:
+ *
+ *   | guard | slot 0 | guard | slot 1 | guard | ... | slot n-1 | guard |
+ */
+
+#define MM_GUARD_POOLSIZE  ((2 * MM_GUARD_NSLOTS + 1) * MM_GUARD_PAGESIZE)
+#define MM_GUARD_SLOT(i)   (&g_mm_guard_pool[(2 * (i) + 1) * \
+                                             MM_GUARD_PAGESIZE])
+
+/* Fill pattern of the unused parts of a slot */
+
+#define MM_GUARD_MAGIC     0xfd
+
+#if (MM_GUARD_PAGESIZE & (MM_GUARD_PAGESIZE - 1)) != 0
+#  error CONFIG_MM_GUARD_PAGESIZE must be a power of two
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+enum mm_guard_state_e
+{
+  MM_GUARD_UNUSED = 0,  /* Never used */
+  MM_GUARD_ALLOC,       /* Holds a live allocation */
+  MM_GUARD_FREED        /* Freed, in quarantine */
+};
+
+struct mm_guard_slot_s
+{
+  FAR struct mm_heap_s *heap;   /* The heap that made the allocation */
+  FAR uint8_t *mem;             /* The user memory */
+  size_t size;                  /* The requested size */
+  uint8_t state;                /* See enum mm_guard_state_e */
+  pid_t allocpid;               /* The allocating thread */
+  pid_t freepid;                /* The freeing thread */
+#if CONFIG_MM_GUARD_BACKTRACE > 0
+  FAR void *allocbt[CONFIG_MM_GUARD_BACKTRACE];
+  FAR void *freebt[CONFIG_MM_GUARD_BACKTRACE];
+#endif
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static uint8_t g_mm_guard_pool[MM_GUARD_POOLSIZE]
+  aligned_data(MM_GUARD_PAGESIZE);
+
+static struct mm_guard_slot_s g_mm_guard_slots[MM_GUARD_NSLOTS];
+
+static spinlock_t g_mm_guard_lock = SP_UNLOCKED;
+
+/* Allocations remaining until the next sample, the random state used to
+ * compute the next interval and the next slot to try.  The countdown is
+ * updated without the lock; the rest is protected by g_mm_guard_lock.
+ */
+
+static atomic_t g_mm_guard_countdown = CONFIG_MM_GUARD_SAMPLE_RATE;
+static uint32_t g_mm_guard_random = 0x9e3779b9;
+static unsigned int g_mm_guard_next;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_guard_protect
+ *
+ * Description:
+ *   Forbid or allow access to a page of the pool where supported.
+ *
+ ****************************************************************************/
+
+static void mm_guard_protect(FAR uint8_t *page, bool access)
+{
+#ifdef CONFIG_ARCH_HAVE_MPROTECT
+  up_mprotect(page, MM_GUARD_PAGESIZE, access);
+#endif
+}
+
+/****************************************************************************
+ * Name: mm_guard_backtrace
+ ****************************************************************************/
+
+#if CONFIG_MM_GUARD_BACKTRACE > 0
+static void mm_guard_backtrace(FAR void **buffer)
+{
+  int n;
+
+  n = sched_backtrace(_SCHED_GETTID(), buffer,
+                      CONFIG_MM_GUARD_BACKTRACE, 2);
+  if (n < CONFIG_MM_GUARD_BACKTRACE)
+    {
+      buffer[n < 0 ? 0 : n] = NULL;
+    }
+}
+
+static void mm_guard_dumpbt(FAR const char *what, FAR void * const *bt)
+{
+  int i;
+
+  _alert("  %s backtrace:\n", what);
+  for (i = 0; i < CONFIG_MM_GUARD_BACKTRACE && bt[i] != NULL; i++)
+    {
+      _alert("    #%d %p\n", i, bt[i]);
+    }
+}
+#else
+#  define mm_guard_backtrace(b)
+#  define mm_guard_dumpbt(w, b)
+#endif
+
+/****************************************************************************
+ * Name: mm_guard_report
+ *
+ * Description:
+ *   Report an error found on a slot and halt the system.
+ *
+ ****************************************************************************/
+
+static void mm_guard_report(FAR const char *error,
+                            FAR struct mm_guard_slot_s *slot,
+                            FAR const void *addr)
+{
+  irqstate_t flags = enter_critical_section();
+
+  _alert("mm_guard: %s at %p\n", error, addr);
+  _alert("  slot %p: mem=%p size=%zu state=%s\n",
+         MM_GUARD_SLOT(slot - g_mm_guard_slots), slot->mem, slot->size,
+         slot->state == MM_GUARD_ALLOC ? "allocated" : "freed");
+  _alert("  allocated by pid %d\n", slot->allocpid);
+  mm_guard_dumpbt("allocation", slot->allocbt);
+
+  if (slot->state == MM_GUARD_FREED)
+    {
+      _alert("  freed by pid %d\n", slot->freepid);
+      mm_guard_dumpbt("free", slot->freebt);
+    }
+
+  PANIC();
+  leave_critical_section(flags);
+}
+
+/****************************************************************************
+ * Name: mm_guard_verify
+ *
+ * Description:
+ *   Check that the fill pattern of 'len' bytes at 'start' is intact.
+ *   Returns the address of the first modified byte, or NULL.
+ *
+ ****************************************************************************/
+
+static FAR const uint8_t *mm_guard_verify(FAR const uint8_t *start,
+                                          size_t len)
+{
+  for (; len > 0; start++, len--)
+    {
+      if (*start != MM_GUARD_MAGIC)
+        {
+          return start;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: mm_guard_sample
+ *
+ * Description:
+ *   Decide whether this allocation should be guarded.  Only the caller that
+ *   takes the countdown from one to zero samples; allocations that race
+ *   with it before the countdown is rearmed are simply not sampled.
+ *
+ ****************************************************************************/
+
+static bool mm_guard_sample(void)
+{
+  return atomic_fetch_sub(&g_mm_guard_countdown, 1) == 1;
+}
+
+/****************************************************************************
+ * Name: mm_guard_rearm
+ *
+ * Description:
+ *   Start the countdown to the next sample.  The interval is drawn
+ *   uniformly from [1, 2 * CONFIG_MM_GUARD_SAMPLE_RATE] so that regular
+ *   allocation patterns don't alias with it.  Called with g_mm_guard_lock
+ *   held.
+ *
+ ****************************************************************************/
+
+static void mm_guard_rearm(void)
+{
+  uint32_t x;
+
+  /* xorshift32 */
+
+  x  = g_mm_guard_random;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  g_mm_guard_random = x;
+  atomic_set(&g_mm_guard_countdown,
+             1 + x % (2 * CONFIG_MM_GUARD_SAMPLE_RATE));
+}
+
+/****************************************************************************
+ * Name: mm_guard_findslot
+ *
+ * Description:
+ *   Return the slot owning 'mem', or NULL if 'mem' is not in the pool.
+ *
+ ****************************************************************************/
+
+static FAR struct mm_guard_slot_s *mm_guard_findslot(FAR const void *mem)
+{
+  uintptr_t offset = (uintptr_t)mem - (uintptr_t)g_mm_guard_pool;
+
+  if (offset >= MM_GUARD_POOLSIZE)
+    {
+      return NULL;
+    }
+
+  /* An address in a guard region is attributed to the preceding slot,
+   * except for the very first region.
+   */
+
+  offset /= MM_GUARD_PAGESIZE;
+  return &g_mm_guard_slots[offset == 0 ? 0 : (offset - 1) / 2];
+}
+
+/****************************************************************************
+ * Name: mm_guard_debugpoint
+ *
+ * Description:
+ *   Debug point callback: something touched a guarded region.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_ARCH_HAVE_DEBUG
+static void mm_guard_debugpoint(int type, FAR void *addr, size_t size,
+                                FAR void *arg)
+{
+  mm_guard_fault(addr);
+}
+
+static void mm_guard_watch(FAR void *addr, bool watch)
+{
+  if (watch)
+    {
+      up_debugpoint_add(DEBUGPOINT_WATCHPOINT_RW, addr, MM_GUARD_PAGESIZE,
+                        mm_guard_debugpoint, NULL);
+    }
+  else
+    {
+      up_debugpoint_remove(DEBUGPOINT_WATCHPOINT_RW, addr,
+                           MM_GUARD_PAGESIZE);
+    }
+}
+#else
+#  define mm_guard_watch(a, w)
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_guard_malloc
+ *
+ * Description:
+ *   Serve a sampled allocation from the guarded pool.  Returns NULL if the
+ *   allocation was not sampled or cannot be guarded, in which case the
+ *   caller proceeds with the normal heap.
+ *
+ ****************************************************************************/
+
+FAR void *mm_guard_malloc(FAR struct mm_heap_s *heap, size_t size,
+                          size_t alignment)
+{
+  FAR struct mm_guard_slot_s *slot = NULL;
+  FAR const uint8_t *bad;
+  FAR uint8_t *page;
+  FAR uint8_t *mem;
+  irqstate_t flags;
+  unsigned int i;
+
+  if (size == 0 || size > MM_GUARD_PAGESIZE ||
+      alignment > MM_GUARD_PAGESIZE)
+    {
+      return NULL;
+    }
+
+  /* Unsampled allocations return here without taking the lock */
+
+  if (!mm_guard_sample())
+    {
+      return NULL;
+    }
+
+  flags = spin_lock_irqsave(&g_mm_guard_lock);
+  mm_guard_rearm();
+
+  /* Take the next slot that is not in use, so that freed slots stay in
+   * quarantine for as long as possible.
+   */
+
+  for (i = 0; i < MM_GUARD_NSLOTS; i++)
+    {
+      FAR struct mm_guard_slot_s *tmp =
+        &g_mm_guard_slots[(g_mm_guard_next + i) % MM_GUARD_NSLOTS];
+
+      if (tmp->state != MM_GUARD_ALLOC)
+        {
+          g_mm_guard_next = (g_mm_guard_next + i + 1) % MM_GUARD_NSLOTS;
+          slot = tmp;
+          break;
+        }
+    }
+
+  if (slot == NULL)
+    {
+      spin_unlock_irqrestore(&g_mm_guard_lock, flags);
+      return NULL;
+    }
+
+  page = MM_GUARD_SLOT(slot - g_mm_guard_slots);
+  mm_guard_protect(page, true);
+  mm_guard_protect(page + MM_GUARD_PAGESIZE, false);
+  if (page - MM_GUARD_PAGESIZE == g_mm_guard_pool)
+    {
+      mm_guard_protect(g_mm_guard_pool, false);
+    }
+
+  /* A write to a slot in quarantine is a use-after-free */
+
+  if (slot->state == MM_GUARD_FREED)
+    {
+      mm_guard_watch(page, false);
+      bad = mm_guard_verify(page, MM_GUARD_PAGESIZE);
+      if (bad != NULL)
+        {
+          mm_guard_report("write after free", slot, bad);
+        }
+    }
+  else
+    {
+      memset(page, MM_GUARD_MAGIC, MM_GUARD_PAGESIZE);
+    }
+
+  /* Put the allocation at the end of the slot, so that an overflow runs
+   * into the following guard region.
+   */
+
+  if (alignment < MM_ALIGN)
+    {
+      alignment = MM_ALIGN;
+    }
+
+  mem = (FAR uint8_t *)((uintptr_t)(page + MM_GUARD_PAGESIZE - size) &
+                        ~(alignment - 1));
+
+  slot->heap     = heap;
+  slot->mem      = mem;
+  slot->size     = size;
+  slot->state    = MM_GUARD_ALLOC;
+  slot->allocpid = _SCHED_GETTID();
+  slot->freepid  = -1;
+
+  spin_unlock_irqrestore(&g_mm_guard_lock, flags);
+
+  mm_guard_backtrace(slot->allocbt);
+  mm_guard_watch(page + MM_GUARD_PAGESIZE, true);
+
+#ifdef CONFIG_MM_FILL_ALLOCATIONS
+  memset(mem, MM_ALLOC_MAGIC, size);
+#endif
+
+  return mem;
+}
+
+/****************************************************************************
+ * Name: mm_guard_free
+ *
+ * Description:
+ *   Free a guarded allocation.  Returns false if 'mem' does not belong to
+ *   the guarded pool.
+ *
+ ****************************************************************************/
+
+bool mm_guard_free(FAR void *mem)
+{
+  FAR struct mm_guard_slot_s *slot;
+  FAR const uint8_t *bad;
+  FAR uint8_t *page;
+  irqstate_t flags;
+
+  slot = mm_guard_findslot(mem);
+  if (slot == NULL)
+    {
+      return false;
+    }
+
+  flags = spin_lock_irqsave(&g_mm_guard_lock);
+
+  if (slot->state != MM_GUARD_ALLOC)
+    {
+      mm_guard_report("double free", slot, mem);
+    }
+  else if (mem != slot->mem)
+    {
+      mm_guard_report("invalid free", slot, mem);
+    }
+
+  /* The slack around the allocation must be untouched */
+
+  page = MM_GUARD_SLOT(slot - g_mm_guard_slots);
+  bad  = mm_guard_verify(page, slot->mem - page);
+  if (bad == NULL)
+    {
+      bad = mm_guard_verify(slot->mem + slot->size,
+                            page + MM_GUARD_PAGESIZE -
+                            (slot->mem + slot->size));
+    }
+
+  if (bad != NULL)
+    {
+      mm_guard_report(bad < slot->mem ? "buffer underflow" :
+                      "buffer overflow", slot, bad);
+    }
+
+  memset(slot->mem, MM_GUARD_MAGIC, slot->size);
+
+  slot->state   = MM_GUARD_FREED;
+  slot->freepid = _SCHED_GETTID();
+
+  spin_unlock_irqrestore(&g_mm_guard_lock, flags);
+
+  mm_guard_backtrace(slot->freebt);
+
+  /* Keep the whole slot inaccessible while it is in quarantine */
+
+  mm_guard_watch(page + MM_GUARD_PAGESIZE, false);
+  mm_guard_watch(page, true);
+  mm_guard_protect(page, false);
+  return true;
+}
+
+/****************************************************************************
+ * Name: mm_guard_member
+ *
+ * Description:
+ *   Return true if 'mem' is a guarded allocation made from 'heap'.
+ *
+ ****************************************************************************/
+
+bool mm_guard_member(FAR struct mm_heap_s *heap, FAR void *mem)
+{
+  FAR struct mm_guard_slot_s *slot = mm_guard_findslot(mem);
+
+  return slot != NULL && slot->heap == heap;
+}
+
+/****************************************************************************
+ * Name: mm_guard_size
+ *
+ * Description:
+ *   Return the usable size of a guarded allocation.
+ *
+ ****************************************************************************/
+
+size_t mm_guard_size(FAR void *mem)
+{
+  FAR struct mm_guard_slot_s *slot = mm_guard_findslot(mem);
+
+  DEBUGASSERT(slot != NULL && slot->mem == mem);
+  return slot->size;
+}
+
+/****************************************************************************
+ * Name: mm_guard_fault
+ *
+ * Description:
+ *   Called by the architecture fault handler (or a debug point) when an
+ *   access faults.  If 'addr' lies in the guarded pool, the offending slot
+ *   is reported and the system halted; otherwise false is returned.
+ *
+ ****************************************************************************/
+
+bool mm_guard_fault(FAR void *addr)
+{
+  FAR struct mm_guard_slot_s *slot = mm_guard_findslot(addr);
+  FAR uint8_t *page;
+
+  if (slot == NULL)
+    {
+      return false;
+    }
+
+  page = MM_GUARD_SLOT(slot - g_mm_guard_slots);
+  if (slot->state == MM_GUARD_FREED &&
+      (FAR uint8_t *)addr >= page &&
+      (FAR uint8_t *)addr < page + MM_GUARD_PAGESIZE)
+    {
+      mm_guard_report("use after free", slot, addr);
+    }
+  else
+    {
+      mm_guard_report((FAR uint8_t *)addr < page ? "buffer underflow" :
+                      "buffer overflow", slot, addr);
+    }
+
+  return true;
+}
+
+#endif /* CONFIG_MM_GUARD */
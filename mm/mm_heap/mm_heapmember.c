@@ -58,6 +58,13 @@
 bool mm_heapmember(FAR struct mm_heap_s *heap, FAR void *mem)
 {
   mem = kasan_reset_tag(mem);
+#ifdef CONFIG_MM_GUARD
+  if (mm_guard_member(heap, mem))
+    {
+      return true;
+    }
+#endif
+
 #if CONFIG_MM_REGIONS > 1
   int i;
 
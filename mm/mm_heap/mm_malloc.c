@@ -38,6 +38,18 @@
 
 #include "mm_heap/mm.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The maximum number of delayed nodes freed by one allocation */
+
+#if CONFIG_MM_FREE_DELAY_BATCH > 0
+#  define MM_FREE_DELAY_BATCH CONFIG_MM_FREE_DELAY_BATCH
+#else
+#  define MM_FREE_DELAY_BATCH SIZE_MAX
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -50,61 +62,102 @@
  *  added because of CONFIG_MM_FREE_DELAYCOUNT_MAX.
  *  Set force to true to free all the memory in delay list immediately, set
  *  to false will only free delaylist when time is up if
- *  CONFIG_MM_FREE_DELAYCOUNT_MAX is enabled.
+ *  CONFIG_MM_FREE_DELAYCOUNT_MAX is enabled, and at most
+ *  CONFIG_MM_FREE_DELAY_BATCH nodes at a time.  The nodes are freed under
+ *  a single acquisition of the heap lock.  With idle set, the lock is only
+ *  tried since the idle thread must not wait.
  *
  *  Return true if there is memory freed.
  *
  ****************************************************************************/
 
-static bool free_delaylist(FAR struct mm_heap_s *heap, bool force)
+static bool free_delaylist(FAR struct mm_heap_s *heap, bool force,
+                           bool idle)
 {
   bool ret = false;
 #if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
-  FAR struct mm_delaynode_s *tmp;
+  FAR struct mm_delaynode_s *head;
+  FAR struct mm_delaynode_s *tail;
   irqstate_t flags;
+  size_t count = 0;
+  int cpu;
 
-  /* Move the delay list to local */
+  /* Detach a batch of nodes from the delay list of this CPU */
 
   flags = mm_lock_irq(heap);
 
-  tmp = heap->mm_delaylist[this_cpu()];
+  cpu  = this_cpu();
+  head = heap->mm_delaylist[cpu];
 
 #if CONFIG_MM_FREE_DELAYCOUNT_MAX > 0
-  if (tmp == NULL ||
+  if (head == NULL ||
       (!force &&
-        heap->mm_delaycount[this_cpu()] < CONFIG_MM_FREE_DELAYCOUNT_MAX))
+        heap->mm_delaycount[cpu] < CONFIG_MM_FREE_DELAYCOUNT_MAX))
     {
       mm_unlock_irq(heap, flags);
       return false;
     }
-
-  heap->mm_delaycount[this_cpu()] = 0;
 #endif
 
-  heap->mm_delaylist[this_cpu()] = NULL;
+  tail = head;
+  if (tail != NULL)
+    {
+      size_t limit = force ? SIZE_MAX : MM_FREE_DELAY_BATCH;
+
+      for (count = 1; tail->flink != NULL && count < limit; count++)
+        {
+          tail = tail->flink;
+        }
+
+      heap->mm_delaylist[cpu] = tail->flink;
+      tail->flink = NULL;
+    }
+
+#if CONFIG_MM_FREE_DELAYCOUNT_MAX > 0
+  heap->mm_delaycount[cpu] -= count;
+#endif
 
   mm_unlock_irq(heap, flags);
 
   /* Test if the delayed is empty */
 
-  ret = tmp != NULL;
+  if (head == NULL)
+    {
+      return false;
+    }
+
+  if ((idle ? nxmutex_trylock(&heap->mm_lock) : mm_lock(heap)) < 0)
+    {
+      /* Put the batch back, it will be retried later */
+
+      flags = mm_lock_irq(heap);
+      tail->flink = heap->mm_delaylist[cpu];
+      heap->mm_delaylist[cpu] = head;
+#if CONFIG_MM_FREE_DELAYCOUNT_MAX > 0
+      heap->mm_delaycount[cpu] += count;
+#endif
+      mm_unlock_irq(heap, flags);
+      return false;
+    }
 
-  while (tmp)
+  while (head)
     {
       FAR void *address;
 
       /* Get the first delayed deallocation */
 
-      address = tmp;
-      tmp = tmp->flink;
+      address = head;
+      head = head->flink;
 
       /* The address should always be non-NULL since that was checked in the
        * 'while' condition above.
        */
 
-      mm_delayfree(heap, address, false);
+      mm_freelocked(heap, address);
     }
 
+  mm_unlock(heap);
+  ret = true;
 #endif
   return ret;
 }
@@ -137,37 +190,18 @@ void mm_mempool_dump_handle(FAR struct mempool_s *pool, FAR void *arg)
 #endif
 
 /****************************************************************************
- * Public Functions
- ****************************************************************************/
-
-/****************************************************************************
- * Name: mm_free_delaylist
+ * Name: malloc_internal
  *
  * Description:
- *   force freeing the delaylist of this heap.
+ *  Find the smallest chunk in the given set of regions that satisfies the
+ *  request. Take the memory from that chunk, save the remaining, smaller
+ *  chunk (if any).  If that fails and 'shrink' is true, ask the registered
+ *  shrinkers to release memory and try once more.
  *
  ****************************************************************************/
 
-void mm_free_delaylist(FAR struct mm_heap_s *heap)
-{
-  if (heap)
-    {
-       free_delaylist(heap, true);
-    }
-}
-
-/****************************************************************************
- * Name: mm_malloc
- *
- * Description:
- *  Find the smallest chunk that satisfies the request. Take the memory from
- *  that chunk, save the remaining, smaller chunk (if any).
- *
- *  8-byte alignment of the allocated data is assured.
- *
- ****************************************************************************/
-
-FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
+static FAR void *malloc_internal(FAR struct mm_heap_s *heap, size_t size,
+                                 uint32_t regions, bool shrink)
 {
   FAR struct mm_freenode_s *node;
   size_t alignsize;
@@ -177,10 +211,21 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 
   /* Free the delay list first */
 
-  free_delaylist(heap, false);
+  free_delaylist(heap, false, false);
+
+#ifdef CONFIG_MM_GUARD
+  if (regions == MM_REGION_ALL)
+    {
+      ret = mm_guard_malloc(heap, size, MM_ALIGN);
+      if (ret != NULL)
+        {
+          return ret;
+        }
+    }
+#endif
 
 #ifdef CONFIG_MM_HEAP_MEMPOOL
-  if (heap->mm_mpool)
+  if (heap->mm_mpool && regions == MM_REGION_ALL)
     {
       ret = mempool_multiple_alloc(heap->mm_mpool, size);
       if (ret != NULL)
@@ -210,6 +255,13 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 
   DEBUGASSERT(alignsize >= MM_ALIGN);
 
+  /* Enforce the heap limit of the calling task group */
+
+  if (!mm_account_check(alignsize))
+    {
+      return NULL;
+    }
+
   /* We need to hold the MM mutex while we muck with the nodelist. */
 
   DEBUGVERIFY(mm_lock(heap));
@@ -227,7 +279,8 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
     {
       DEBUGASSERT(node->blink->flink == node);
       nodesize = MM_SIZEOF_NODE(node);
-      if (nodesize >= alignsize)
+      if (nodesize >= alignsize &&
+          mm_region_member(heap, node, regions))
         {
           break;
         }
@@ -317,6 +370,7 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
       /* Handle the case of an exact size match */
 
       node->size |= MM_ALLOC_BIT;
+      mm_account_alloc((FAR struct mm_allocnode_s *)node);
       ret = (FAR void *)((FAR char *)node + MM_SIZEOF_ALLOCNODE);
     }
 
@@ -342,17 +396,30 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 #endif
     }
 
-#if CONFIG_MM_FREE_DELAYCOUNT_MAX > 0
+  /* The forced drain, the shrinkers and the failure dump are only for the
+   * whole heap.  Unless the hint is strict, a miss in the hinted regions
+   * falls back to the whole heap, which does all of them.
+   */
+
+#if CONFIG_MM_FREE_DELAYCOUNT_MAX > 0 || CONFIG_MM_FREE_DELAY_BATCH > 0
   /* Try again after free delay list */
 
-  else if (free_delaylist(heap, true))
+  else if (regions == MM_REGION_ALL && free_delaylist(heap, true, false))
     {
-      return mm_malloc(heap, size);
+      return malloc_internal(heap, size, regions, shrink);
     }
 #endif
 
+  /* Ask the caches to release memory and try again, but only once */
+
+  else if (shrink && regions == MM_REGION_ALL &&
+           mm_shrink(heap, alignsize) > 0)
+    {
+      return malloc_internal(heap, size, regions, false);
+    }
+
 #ifdef CONFIG_DEBUG_MM
-  else if (MM_INTERNAL_HEAP(heap))
+  else if (regions == MM_REGION_ALL && MM_INTERNAL_HEAP(heap))
     {
 #ifdef CONFIG_MM_DUMP_ON_FAILURE
       struct mallinfo minfo;
@@ -411,3 +478,108 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
   DEBUGASSERT(ret == NULL || ((uintptr_t)ret) % MM_ALIGN == 0);
   return ret;
 }
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_free_delaylist
+ *
+ * Description:
+ *   force freeing the delaylist of this heap.
+ *
+ ****************************************************************************/
+
+void mm_free_delaylist(FAR struct mm_heap_s *heap)
+{
+  if (heap)
+    {
+       free_delaylist(heap, true, false);
+    }
+}
+
+/****************************************************************************
+ * Name: mm_free_delaylist_idle
+ *
+ * Description:
+ *   Called from the idle loop to free a batch of the nodes delayed on this
+ *   CPU, so that they don't have to be freed by the next allocation.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_MM_FREE_DELAY_IDLE) && \
+    (defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__))
+void mm_free_delaylist_idle(void)
+{
+#ifndef CONFIG_BUILD_KERNEL
+  if (USR_HEAP && USR_HEAP->mm_delaylist[this_cpu()])
+    {
+      free_delaylist(USR_HEAP, false, true);
+    }
+#endif
+
+#ifdef CONFIG_MM_KERNEL_HEAP
+  if (g_kmmheap && g_kmmheap->mm_delaylist[this_cpu()])
+    {
+      free_delaylist(g_kmmheap, false, true);
+    }
+#endif
+}
+#endif
+
+/****************************************************************************
+ * Name: mm_malloc
+ *
+ * Description:
+ *  Find the smallest chunk that satisfies the request. Take the memory from
+ *  that chunk, save the remaining, smaller chunk (if any).
+ *
+ *  8-byte alignment of the allocated data is assured.
+ *
+ ****************************************************************************/
+
+FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
+{
+#ifdef CONFIG_MM_REGION_ATTR
+  unsigned int hint = mm_region_hint();
+
+  if (hint != 0)
+    {
+      return mm_malloc_hint(heap, size, hint);
+    }
+#endif
+
+  return malloc_internal(heap, size, MM_REGION_ALL, true);
+}
+
+/****************************************************************************
+ * Name: mm_malloc_hint
+ *
+ * Description:
+ *  Like mm_malloc(), but take the memory from the regions matching the
+ *  MM_REGION_* hint.  Unless MM_HINT_STRICT is set, fall back to the other
+ *  regions if that fails.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MM_REGION_ATTR
+FAR void *mm_malloc_hint(FAR struct mm_heap_s *heap, size_t size,
+                         unsigned int hint)
+{
+  uint32_t regions = mm_region_mask(heap, hint);
+  FAR void *ret = NULL;
+
+  if (regions != 0)
+    {
+      ret = malloc_internal(heap, size, regions, true);
+    }
+
+  if (ret == NULL && (hint & MM_HINT_STRICT) == 0)
+    {
+      ret = malloc_internal(heap, size, MM_REGION_ALL, true);
+    }
+
+  return ret;
+}
+#endif
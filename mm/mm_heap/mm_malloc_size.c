@@ -40,6 +40,13 @@
 size_t mm_malloc_size(FAR struct mm_heap_s *heap, FAR void *mem)
 {
   FAR struct mm_freenode_s *node;
+#ifdef CONFIG_MM_GUARD
+  if (mm_guard_member(heap, mem))
+    {
+      return mm_guard_size(mem);
+    }
+#endif
+
 #ifdef CONFIG_MM_HEAP_MEMPOOL
   if (heap->mm_mpool)
     {
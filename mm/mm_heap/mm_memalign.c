@@ -76,6 +76,14 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
       return NULL;
     }
 
+#ifdef CONFIG_MM_GUARD
+  node = mm_guard_malloc(heap, size, alignment);
+  if (node != NULL)
+    {
+      return node;
+    }
+#endif
+
 #ifdef CONFIG_MM_HEAP_MEMPOOL
   if (heap->mm_mpool)
     {
@@ -156,6 +164,7 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
 
   node = (FAR struct mm_allocnode_s *)(rawchunk - MM_SIZEOF_ALLOCNODE);
   heap->mm_curused -= MM_SIZEOF_NODE(node);
+  mm_account_free(node);
 
   /* Find the aligned subregion */
 
@@ -273,6 +282,7 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
 
   size = MM_SIZEOF_NODE(node);
   heap->mm_curused += size;
+  mm_account_alloc(node);
   if (heap->mm_curused > heap->mm_maxused)
     {
       heap->mm_maxused = heap->mm_curused;
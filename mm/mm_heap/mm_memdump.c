@@ -27,6 +27,8 @@
 #include <nuttx/config.h>
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include <debug.h>
 #include <execinfo.h>
@@ -43,6 +45,21 @@
  * Private Types
  ****************************************************************************/
 
+#if CONFIG_MM_HEAP_LEAK_SITES > 0
+/* The aged allocations of one call site */
+
+struct mm_memdump_site_s
+{
+  pid_t pid;                                /* Owner if no backtrace */
+#  if CONFIG_MM_BACKTRACE > 0
+  FAR void *backtrace[CONFIG_MM_BACKTRACE]; /* The allocating call site */
+#  endif
+  unsigned long seqno;                      /* The oldest allocation */
+  size_t count;                             /* Number of allocations */
+  size_t size;                              /* Total size */
+};
+#endif
+
 struct mm_memdump_priv_s
 {
   FAR const struct mm_memdump_s *dump;
@@ -51,6 +68,10 @@ struct mm_memdump_priv_s
   FAR struct mm_allocnode_s *node[CONFIG_MM_HEAP_BIGGEST_COUNT];
   size_t filled;
 #endif
+#if CONFIG_MM_HEAP_LEAK_SITES > 0
+  struct mm_memdump_site_s site[CONFIG_MM_HEAP_LEAK_SITES + 1];
+  size_t nsites;
+#endif
 };
 
 /****************************************************************************
@@ -132,6 +153,158 @@ static void memdump_dump_biggestnodes(FAR struct mm_memdump_priv_s *priv)
 
 #endif
 
+#if CONFIG_MM_HEAP_LEAK_SITES > 0
+#  if CONFIG_MM_BACKTRACE > 0
+/* Only the entries up to the first NULL are part of a backtrace, the rest
+ * of the array may hold stale addresses.
+ */
+
+static size_t memdump_backtrace_depth(FAR void * const *backtrace)
+{
+  size_t depth;
+
+  for (depth = 0; depth < CONFIG_MM_BACKTRACE &&
+       backtrace[depth] != NULL; depth++);
+
+  return depth;
+}
+#  endif
+
+static void memdump_record_site(FAR struct mm_memdump_priv_s *priv,
+                                FAR struct mm_allocnode_s *node)
+{
+  FAR struct mm_memdump_site_s *site;
+#  if CONFIG_MM_BACKTRACE > 0
+  size_t depth = memdump_backtrace_depth(node->backtrace);
+#  endif
+  size_t i;
+
+  /* Find the call site, the last slot collects everything that doesn't
+   * fit in the table.
+   */
+
+  for (i = 0; i < priv->nsites; i++)
+    {
+      site = &priv->site[i];
+#  if CONFIG_MM_BACKTRACE > 0
+      if (node->backtrace[0] != NULL)
+        {
+          if (memcmp(site->backtrace, node->backtrace,
+                     depth * sizeof(FAR void *)) == 0 &&
+              (depth == CONFIG_MM_BACKTRACE ||
+               site->backtrace[depth] == NULL))
+            {
+              break;
+            }
+        }
+      else
+#  endif
+      if (site->pid == node->pid)
+        {
+          break;
+        }
+    }
+
+  if (i == priv->nsites)
+    {
+      if (priv->nsites == CONFIG_MM_HEAP_LEAK_SITES)
+        {
+          i = CONFIG_MM_HEAP_LEAK_SITES;
+        }
+      else
+        {
+          priv->nsites++;
+        }
+
+      site = &priv->site[i];
+      if (site->count == 0)
+        {
+          site->seqno = node->seqno;
+#  if CONFIG_MM_BACKTRACE > 0
+          if (node->backtrace[0] != NULL)
+            {
+              site->pid = PID_MM_ALLOC;
+              memcpy(site->backtrace, node->backtrace,
+                     depth * sizeof(FAR void *));
+              memset(&site->backtrace[depth], 0,
+                     (CONFIG_MM_BACKTRACE - depth) * sizeof(FAR void *));
+            }
+          else
+#  endif
+            {
+              site->pid = i < CONFIG_MM_HEAP_LEAK_SITES ?
+                          node->pid : PID_MM_ALLOC;
+            }
+        }
+    }
+
+  if (node->seqno < site->seqno)
+    {
+      site->seqno = node->seqno;
+    }
+
+  site->count++;
+  site->size += MM_SIZEOF_NODE(node);
+}
+
+static int memdump_site_compare(FAR const void *a, FAR const void *b)
+{
+  FAR const struct mm_memdump_site_s *site_a = a;
+  FAR const struct mm_memdump_site_s *site_b = b;
+
+  if (site_a->size == site_b->size)
+    {
+      return 0;
+    }
+
+  return site_a->size < site_b->size ? 1 : -1;
+}
+
+static void memdump_dump_sites(FAR struct mm_memdump_priv_s *priv)
+{
+  FAR struct mm_memdump_site_s *site;
+  size_t i;
+
+  qsort(priv->site, priv->nsites, sizeof(struct mm_memdump_site_s),
+        memdump_site_compare);
+
+  for (i = 0; i <= priv->nsites && i <= CONFIG_MM_HEAP_LEAK_SITES; i++)
+    {
+      site = &priv->site[i];
+      if (site->count == 0)
+        {
+          continue;
+        }
+
+      priv->info.aordblks += site->count;
+      priv->info.uordblks += site->size;
+
+#  if CONFIG_MM_BACKTRACE > 0
+      if (site->pid == PID_MM_ALLOC && i < priv->nsites)
+        {
+          char buf[BACKTRACE_BUFFER_SIZE(CONFIG_MM_BACKTRACE)];
+
+          backtrace_format(buf, sizeof(buf), site->backtrace,
+                           CONFIG_MM_BACKTRACE);
+          syslog(LOG_INFO, "%6s%12zu%9zu%12lu %s\n", "-",
+                 site->size, site->count, site->seqno, buf);
+        }
+      else
+#  endif
+      if (i < priv->nsites)
+        {
+          syslog(LOG_INFO, "%6d%12zu%9zu%12lu\n", site->pid,
+                 site->size, site->count, site->seqno);
+        }
+      else
+        {
+          syslog(LOG_INFO, "%6s%12zu%9zu%12lu (other sites)\n", "-",
+                 site->size, site->count, site->seqno);
+        }
+    }
+}
+#endif
+
 #ifdef CONFIG_MM_HEAP_MEMPOOL
 static inline_function
 void memdump_info_pool(FAR struct mm_memdump_priv_s *priv,
@@ -186,6 +359,16 @@ static void memdump_handler(FAR struct mm_allocnode_s *node, FAR void *arg)
         {
           memdump_record_biggest(priv, node);
         }
+#endif
+#if CONFIG_MM_HEAP_LEAK_SITES > 0
+      else if (dump->pid == PID_MM_AGED && MM_DUMP_SEQNO(dump, node) &&
+               nodesize > MM_SIZEOF_ALLOCNODE &&
+               node->pid != PID_MM_MEMPOOL)
+        {
+          /* Skip the region guard nodes and the mempool backing chunks */
+
+          memdump_record_site(priv, node);
+        }
 #endif
     }
   else if (dump->pid == PID_MM_FREE)
@@ -222,6 +405,8 @@ static void memdump_handler(FAR struct mm_allocnode_s *node, FAR void *arg)
  *   backtrace for every allocated node for this heap, if pid equals -2, this
  *   function will dump all free node for this heap, and if pid is greater
  *   than or equal to 0, will dump pid allocated node and output backtrace.
+ *   With PID_MM_AGED, the allocations up to dump->seqmax are summed up by
+ *   the call site that made them, the largest sites first.
  ****************************************************************************/
 
 void mm_memdump(FAR struct mm_heap_s *heap,
@@ -287,6 +472,21 @@ void mm_memdump(FAR struct mm_heap_s *heap,
     {
       syslog(LOG_INFO, "Dump allocated orphan nodes\n");
     }
+#if CONFIG_MM_HEAP_LEAK_SITES > 0
+  else if (pid == PID_MM_AGED)
+    {
+      syslog(LOG_INFO, "Memdump allocations up to sequence %lu by site\n",
+                       dump->seqmax);
+      syslog(LOG_INFO, "%6s%12s%9s%12s %s\n", "PID", "Size", "Count",
+                       "Oldest", "Backtrace");
+      mm_foreach(heap, memdump_handler, &priv);
+      memdump_dump_sites(&priv);
+      syslog(LOG_INFO, "%12s%12s\n", "Total Blks", "Total Size");
+      syslog(LOG_INFO, "%12d%12d\n", priv.info.aordblks,
+                       priv.info.uordblks);
+      return;
+    }
+#endif
 
 #if CONFIG_MM_BACKTRACE < 0
   syslog(LOG_INFO, "%12s%9s%*s\n", "Size", "Overhead",
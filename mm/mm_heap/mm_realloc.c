@@ -86,6 +86,20 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
 
   DEBUGASSERT(mm_heapmember(heap, oldmem));
 
+#ifdef CONFIG_MM_GUARD
+  if (mm_guard_member(heap, oldmem))
+    {
+      newmem = mm_malloc(heap, size);
+      if (newmem != NULL)
+        {
+          memcpy(newmem, oldmem, MIN(size, mm_guard_size(oldmem)));
+          mm_free(heap, oldmem);
+        }
+
+      return newmem;
+    }
+#endif
+
 #ifdef CONFIG_MM_HEAP_MEMPOOL
   if (heap->mm_mpool)
     {
@@ -151,7 +165,9 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
       if (newsize < oldsize)
         {
           heap->mm_curused += newsize - oldsize;
+          mm_account_free(oldnode);
           mm_shrinkchunk(heap, oldnode, newsize);
+          mm_account_alloc(oldnode);
           kasan_poison((FAR char *)oldnode + MM_SIZEOF_NODE(oldnode) +
                        sizeof(mmsize_t), oldsize - MM_SIZEOF_NODE(oldnode));
         }
@@ -193,6 +209,16 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
       size_t takeprev;
       size_t takenext;
 
+      /* Enforce the heap limit of the calling task group */
+
+      if (!mm_account_check(needed))
+        {
+          mm_unlock(heap);
+          return NULL;
+        }
+
+      mm_account_free(oldnode);
+
       /* Check if we can extend into the previous chunk and if the
        * previous chunk is smaller than the next chunk.
        */
@@ -377,6 +403,7 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
 
       /* Update heap statistics */
 
+      mm_account_alloc(oldnode);
       heap->mm_curused += newsize - oldsize;
       if (heap->mm_curused > heap->mm_maxused)
         {
@@ -0,0 +1,223 @@
+/****************************************************************************
+ * mm/mm_heap/mm_region.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+#include <errno.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/irq.h>
+#include <nuttx/mm/mm.h>
+#include <nuttx/sched.h>
+
+#include "mm_heap/mm.h"
+
+#if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
+#  include "sched/sched.h"
+#endif
+
+#ifdef CONFIG_MM_REGION_ATTR
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#if CONFIG_MM_REGIONS > 32
+#  error CONFIG_MM_REGION_ATTR supports at most 32 regions
+#endif
+
+#define MM_REGION_ATTRMASK (MM_REGION_FAST | MM_REGION_DMA | MM_REGION_LOCAL)
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_region_setattr
+ *
+ * Description:
+ *   Set the MM_REGION_* attributes of the heap region containing 'start'.
+ *   This is normally called by the board logic right after the region was
+ *   added with mm_addregion().
+ *
+ * Input Parameters:
+ *   heap  - The heap owning the region
+ *   start - Any address inside the region
+ *   attr  - Region attributes, MM_REGION_CPU(n) for CPU local memory
+ *
+ * Returned Value:
+ *   Zero on success; -ENOENT if no region of the heap contains 'start'.
+ *
+ ****************************************************************************/
+
+int mm_region_setattr(FAR struct mm_heap_s *heap, FAR void *start,
+                      unsigned int attr)
+{
+  int region;
+
+  for (region = 0; region < heap->mm_nregions; region++)
+    {
+      if ((uintptr_t)start >= (uintptr_t)heap->mm_heapstart[region] &&
+          (uintptr_t)start < (uintptr_t)heap->mm_heapend[region])
+        {
+          heap->mm_regionattr[region] = attr;
+          return OK;
+        }
+    }
+
+  return -ENOENT;
+}
+
+/****************************************************************************
+ * Name: mm_region_mask
+ *
+ * Description:
+ *   Return the bit set of regions matching an allocation hint.
+ *
+ ****************************************************************************/
+
+uint32_t mm_region_mask(FAR struct mm_heap_s *heap, unsigned int hint)
+{
+  unsigned int want = hint & MM_REGION_ATTRMASK;
+  uint32_t regions = 0;
+  int region;
+
+  for (region = 0; region < heap->mm_nregions; region++)
+    {
+      unsigned int attr = heap->mm_regionattr[region];
+
+      if ((attr & want) != want)
+        {
+          continue;
+        }
+
+      if ((want & MM_REGION_LOCAL) != 0 &&
+          MM_REGION_GETCPU(attr) != this_cpu())
+        {
+          continue;
+        }
+
+      regions |= 1u << region;
+    }
+
+  return regions;
+}
+
+/****************************************************************************
+ * Name: mm_region_member
+ *
+ * Description:
+ *   Check if a free node lies in one of the given regions.
+ *
+ ****************************************************************************/
+
+bool mm_region_member(FAR struct mm_heap_s *heap, FAR void *node,
+                      uint32_t regions)
+{
+  int region;
+
+  for (region = 0; regions != 0; region++, regions >>= 1)
+    {
+      if ((regions & 1) != 0 &&
+          (uintptr_t)node >= (uintptr_t)heap->mm_heapstart[region] &&
+          (uintptr_t)node < (uintptr_t)heap->mm_heapend[region])
+        {
+          return true;
+        }
+    }
+
+  return false;
+}
+
+/****************************************************************************
+ * Name: mm_region_hint
+ *
+ * Description:
+ *   Return the default allocation hint of the calling task, zero when
+ *   called from an interrupt handler or from user space.
+ *
+ ****************************************************************************/
+
+unsigned int mm_region_hint(void)
+{
+#if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
+  FAR struct tcb_s *tcb;
+
+  if (up_interrupt_context())
+    {
+      return 0;
+    }
+
+  tcb = this_task();
+  return tcb != NULL ? tcb->mm_hint : 0;
+#else
+  return 0;
+#endif
+}
+
+/****************************************************************************
+ * Name: mm_sethint
+ *
+ * Description:
+ *   Set the default allocation hint of the calling task.  mm_malloc() and
+ *   the functions built on it apply this hint; tasks and threads created
+ *   afterwards inherit it.  The hint is ignored in interrupt context.
+ *   Kernel code typically brackets a group of allocations:
+ *
+ *     old = mm_sethint(MM_REGION_FAST);
+ *     ...
+ *     mm_sethint(old);
+ *
+ * Input Parameters:
+ *   hint - The new hint, zero for no preference
+ *
+ * Returned Value:
+ *   The previous hint.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
+unsigned int mm_sethint(unsigned int hint)
+{
+  FAR struct tcb_s *tcb;
+  unsigned int old;
+
+  if (up_interrupt_context())
+    {
+      return 0;
+    }
+
+  tcb = this_task();
+  DEBUGASSERT(tcb != NULL);
+
+  old = tcb->mm_hint;
+  tcb->mm_hint = hint;
+  return old;
+}
+#endif
+
+#endif /* CONFIG_MM_REGION_ATTR */
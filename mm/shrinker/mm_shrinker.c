@@ -0,0 +1,227 @@
+/****************************************************************************
+ * mm/shrinker/mm_shrinker.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+#include <debug.h>
+#include <errno.h>
+#include <stdint.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/mutex.h>
+#include <nuttx/wqueue.h>
+#include <nuttx/mm/mm.h>
+
+#if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_MM_SHRINKER_THRESHOLD
+#  define CONFIG_MM_SHRINKER_THRESHOLD 0
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The registered shrinkers.  The lock is also held while the shrinkers
+ * run, which keeps an allocation made by a shrinker from recursing into
+ * them.
+ */
+
+static FAR struct mm_shrinker_s *g_shrinkers;
+static mutex_t g_shrinker_lock = NXMUTEX_INITIALIZER;
+
+#if CONFIG_MM_SHRINKER_THRESHOLD > 0
+static struct work_s g_shrinker_work;
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_shrink_worker
+ *
+ * Description:
+ *   Run the shrinkers from the work queue after the free memory dropped
+ *   below CONFIG_MM_SHRINKER_THRESHOLD.
+ *
+ ****************************************************************************/
+
+#if CONFIG_MM_SHRINKER_THRESHOLD > 0
+static void mm_shrink_worker(FAR void *arg)
+{
+  FAR struct mm_shrinker_s *shrinker;
+  size_t size = (uintptr_t)arg;
+  size_t freed = 0;
+
+  nxmutex_lock(&g_shrinker_lock);
+
+  for (shrinker = g_shrinkers; shrinker != NULL && freed < size;
+       shrinker = shrinker->flink)
+    {
+      freed += shrinker->shrink(shrinker, NULL, size - freed);
+    }
+
+  nxmutex_unlock(&g_shrinker_lock);
+
+  minfo("Released %zu of %zu bytes\n", freed, size);
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_register_shrinker
+ *
+ * Description:
+ *   Register a shrinker.  The shrinker must stay valid until it is
+ *   unregistered.
+ *
+ * Input Parameters:
+ *   shrinker - The shrinker, with the 'shrink' callback set.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int mm_register_shrinker(FAR struct mm_shrinker_s *shrinker)
+{
+  int ret;
+
+  DEBUGASSERT(shrinker != NULL && shrinker->shrink != NULL);
+
+  ret = nxmutex_lock(&g_shrinker_lock);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  shrinker->flink = g_shrinkers;
+  g_shrinkers     = shrinker;
+
+  nxmutex_unlock(&g_shrinker_lock);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: mm_unregister_shrinker
+ *
+ * Description:
+ *   Unregister a shrinker.  On return the shrinker is no longer running
+ *   and will not be called again.
+ *
+ ****************************************************************************/
+
+void mm_unregister_shrinker(FAR struct mm_shrinker_s *shrinker)
+{
+  FAR struct mm_shrinker_s **prev;
+
+  nxmutex_lock(&g_shrinker_lock);
+
+  for (prev = &g_shrinkers; *prev != NULL; prev = &(*prev)->flink)
+    {
+      if (*prev == shrinker)
+        {
+          *prev = shrinker->flink;
+          break;
+        }
+    }
+
+  nxmutex_unlock(&g_shrinker_lock);
+}
+
+/****************************************************************************
+ * Name: mm_shrink
+ *
+ * Description:
+ *   Ask the registered shrinkers to release at least 'size' bytes.  This
+ *   is called by the heap before an allocation fails.  Nothing is done in
+ *   interrupt context or when the shrinkers are already running (e.g. if a
+ *   shrinker itself runs out of memory).
+ *
+ * Input Parameters:
+ *   heap - The heap that is short of memory.
+ *   size - The number of bytes wanted.
+ *
+ * Returned Value:
+ *   The number of bytes released.
+ *
+ ****************************************************************************/
+
+size_t mm_shrink(FAR struct mm_heap_s *heap, size_t size)
+{
+  FAR struct mm_shrinker_s *shrinker;
+  size_t freed = 0;
+
+  if (up_interrupt_context() || g_shrinkers == NULL ||
+      nxmutex_trylock(&g_shrinker_lock) < 0)
+    {
+      return 0;
+    }
+
+  for (shrinker = g_shrinkers; shrinker != NULL && freed < size;
+       shrinker = shrinker->flink)
+    {
+      freed += shrinker->shrink(shrinker, heap, size - freed);
+    }
+
+  nxmutex_unlock(&g_shrinker_lock);
+  return freed;
+}
+
+/****************************************************************************
+ * Name: mm_shrink_pressure
+ *
+ * Description:
+ *   Called with the free memory of the user heap after each allocation.
+ *   Schedule the shrinkers when it is below CONFIG_MM_SHRINKER_THRESHOLD.
+ *
+ ****************************************************************************/
+
+void mm_shrink_pressure(size_t remaining)
+{
+#if CONFIG_MM_SHRINKER_THRESHOLD > 0
+  if (remaining < CONFIG_MM_SHRINKER_THRESHOLD &&
+      g_shrinkers != NULL && work_available(&g_shrinker_work))
+    {
+      work_queue(LPWORK, &g_shrinker_work, mm_shrink_worker,
+                 (FAR void *)(uintptr_t)
+                 (CONFIG_MM_SHRINKER_THRESHOLD - remaining), 0);
+    }
+#else
+  UNUSED(remaining);
+#endif
+}
+
+#endif /* CONFIG_BUILD_FLAT || __KERNEL__ */
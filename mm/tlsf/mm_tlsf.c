@@ -139,6 +139,21 @@ struct mm_tlsf_node_s
 };
 #endif
 
+#if CONFIG_MM_HEAP_LEAK_SITES > 0
+/* The aged allocations of one call site */
+
+struct mm_memdump_site_s
+{
+  pid_t pid;                                /* Owner if no backtrace */
+#  if CONFIG_MM_BACKTRACE > 0
+  FAR void *backtrace[CONFIG_MM_BACKTRACE]; /* The allocating call site */
+#  endif
+  unsigned long seqno;                      /* The oldest allocation */
+  size_t count;                             /* Number of allocations */
+  size_t size;                              /* Total size */
+};
+#endif
+
 struct mm_memdump_priv_s
 {
   FAR const struct mm_memdump_s *dump;
@@ -147,6 +162,10 @@ struct mm_memdump_priv_s
   struct mm_tlsf_node_s node[CONFIG_MM_HEAP_BIGGEST_COUNT];
   size_t filled;
 #endif
+#if CONFIG_MM_HEAP_LEAK_SITES > 0
+  struct mm_memdump_site_s site[CONFIG_MM_HEAP_LEAK_SITES + 1];
+  size_t nsites;
+#endif
 };
 
 #ifdef CONFIG_MM_HEAP_MEMPOOL
@@ -285,6 +304,159 @@ static void memdump_dump_biggestnodes(FAR struct mm_memdump_priv_s *priv)
 
 #endif
 
+#if CONFIG_MM_HEAP_LEAK_SITES > 0
+#  if CONFIG_MM_BACKTRACE > 0
+/* Only the entries up to the first NULL are part of a backtrace, the rest
+ * of the array may hold stale addresses.
+ */
+
+static size_t memdump_backtrace_depth(FAR void * const *backtrace)
+{
+  size_t depth;
+
+  for (depth = 0; depth < CONFIG_MM_BACKTRACE &&
+       backtrace[depth] != NULL; depth++);
+
+  return depth;
+}
+#  endif
+
+static void memdump_record_site(FAR struct mm_memdump_priv_s *priv,
+                                FAR struct memdump_backtrace_s *buf,
+                                size_t size)
+{
+  FAR struct mm_memdump_site_s *site;
+#  if CONFIG_MM_BACKTRACE > 0
+  size_t depth = memdump_backtrace_depth(buf->backtrace);
+#  endif
+  size_t i;
+
+  /* Find the call site, the last slot collects everything that doesn't
+   * fit in the table.
+   */
+
+  for (i = 0; i < priv->nsites; i++)
+    {
+      site = &priv->site[i];
+#  if CONFIG_MM_BACKTRACE > 0
+      if (buf->backtrace[0] != NULL)
+        {
+          if (memcmp(site->backtrace, buf->backtrace,
+                     depth * sizeof(FAR void *)) == 0 &&
+              (depth == CONFIG_MM_BACKTRACE ||
+               site->backtrace[depth] == NULL))
+            {
+              break;
+            }
+        }
+      else
+#  endif
+      if (site->pid == buf->pid)
+        {
+          break;
+        }
+    }
+
+  if (i == priv->nsites)
+    {
+      if (priv->nsites == CONFIG_MM_HEAP_LEAK_SITES)
+        {
+          i = CONFIG_MM_HEAP_LEAK_SITES;
+        }
+      else
+        {
+          priv->nsites++;
+        }
+
+      site = &priv->site[i];
+      if (site->count == 0)
+        {
+          site->seqno = buf->seqno;
+#  if CONFIG_MM_BACKTRACE > 0
+          if (buf->backtrace[0] != NULL)
+            {
+              site->pid = PID_MM_ALLOC;
+              memcpy(site->backtrace, buf->backtrace,
+                     depth * sizeof(FAR void *));
+              memset(&site->backtrace[depth], 0,
+                     (CONFIG_MM_BACKTRACE - depth) * sizeof(FAR void *));
+            }
+          else
+#  endif
+            {
+              site->pid = i < CONFIG_MM_HEAP_LEAK_SITES ?
+                          buf->pid : PID_MM_ALLOC;
+            }
+        }
+    }
+
+  if (buf->seqno < site->seqno)
+    {
+      site->seqno = buf->seqno;
+    }
+
+  site->count++;
+  site->size += size;
+}
+
+static int memdump_site_compare(FAR const void *a, FAR const void *b)
+{
+  FAR const struct mm_memdump_site_s *site_a = a;
+  FAR const struct mm_memdump_site_s *site_b = b;
+
+  if (site_a->size == site_b->size)
+    {
+      return 0;
+    }
+
+  return site_a->size < site_b->size ? 1 : -1;
+}
+
+static void memdump_dump_sites(FAR struct mm_memdump_priv_s *priv)
+{
+  FAR struct mm_memdump_site_s *site;
+  size_t i;
+
+  qsort(priv->site, priv->nsites, sizeof(struct mm_memdump_site_s),
+        memdump_site_compare);
+
+  for (i = 0; i <= priv->nsites && i <= CONFIG_MM_HEAP_LEAK_SITES; i++)
+    {
+      site = &priv->site[i];
+      if (site->count == 0)
+        {
+          continue;
+        }
+
+      priv->info.aordblks += site->count;
+      priv->info.uordblks += site->size;
+
+#  if CONFIG_MM_BACKTRACE > 0
+      if (site->pid == PID_MM_ALLOC && i < priv->nsites)
+        {
+          char tmp[BACKTRACE_BUFFER_SIZE(CONFIG_MM_BACKTRACE)];
+
+          backtrace_format(tmp, sizeof(tmp), site->backtrace,
+                           CONFIG_MM_BACKTRACE);
+          syslog(LOG_INFO, "%6s%12zu%9zu%12lu %s\n", "-",
+                 site->size, site->count, site->seqno, tmp);
+        }
+      else
+#  endif
+      if (i < priv->nsites)
+        {
+          syslog(LOG_INFO, "%6d%12zu%9zu%12lu\n", site->pid,
+                 site->size, site->count, site->seqno);
+        }
+      else
+        {
+          syslog(LOG_INFO, "%6s%12zu%9zu%12lu (other sites)\n", "-",
+                 site->size, site->count, site->seqno);
+        }
+    }
+}
+#endif
+
 #if CONFIG_MM_BACKTRACE >= 0
 
 /****************************************************************************
@@ -313,6 +485,10 @@ static void memdump_backtrace(FAR struct mm_heap_s *heap,
           buf->backtrace[ret] = NULL;
         }
     }
+  else
+    {
+      buf->backtrace[0] = NULL;
+    }
 #  endif
 }
 #endif
@@ -597,6 +773,15 @@ static void memdump_handler(FAR void *ptr, size_t size, int used,
           memdump_record_biggest(priv, ptr, size);
         }
 #endif
+#if CONFIG_MM_HEAP_LEAK_SITES > 0
+      else if (dump->pid == PID_MM_AGED && MM_DUMP_SEQNO(dump, buf) &&
+               buf->pid != PID_MM_MEMPOOL)
+        {
+          /* Skip the mempool backing chunks */
+
+          memdump_record_site(priv, buf, size);
+        }
+#endif
 #undef buf
     }
   else if (dump->pid == PID_MM_FREE)
@@ -1194,6 +1379,8 @@ struct mallinfo_task mm_mallinfo_task(FAR struct mm_heap_s *heap,
  *   backtrace for every allocated node for this heap, if pid equals -2, this
  *   function will dump all free node for this heap, and if pid is greater
  *   than or equal to 0, will dump pid allocated node and output backtrace.
+ *   With PID_MM_AGED, the allocations up to dump->seqmax are summed up by
+ *   the call site that made them, the largest sites first.
  ****************************************************************************/
 
 void mm_memdump(FAR struct mm_heap_s *heap,
@@ -1260,6 +1447,31 @@ void mm_memdump(FAR struct mm_heap_s *heap,
                        CONFIG_MM_HEAP_BIGGEST_COUNT);
     }
 #endif
+#if CONFIG_MM_HEAP_LEAK_SITES > 0
+  else if (pid == PID_MM_AGED)
+    {
+      syslog(LOG_INFO, "Memdump allocations up to sequence %lu by site\n",
+                       dump->seqmax);
+      syslog(LOG_INFO, "%6s%12s%9s%12s %s\n", "PID", "Size", "Count",
+                       "Oldest", "Backtrace");
+
+#  if CONFIG_MM_REGIONS > 1
+      for (region = 0; region < heap->mm_nregions; region++)
+#  endif
+        {
+          DEBUGVERIFY(mm_lock(heap));
+          tlsf_walk_pool(heap->mm_heapstart[region],
+                         memdump_handler, &priv);
+          mm_unlock(heap);
+        }
+
+      memdump_dump_sites(&priv);
+      syslog(LOG_INFO, "%12s%12s\n", "Total Blks", "Total Size");
+      syslog(LOG_INFO, "%12d%12d\n", priv.info.aordblks,
+                       priv.info.uordblks);
+      return;
+    }
+#endif
 
 #if CONFIG_MM_BACKTRACE < 0
   syslog(LOG_INFO, "%12s%*s\n", "Size", BACKTRACE_PTR_FMT_WIDTH, "Address");
@@ -1317,17 +1529,16 @@ size_t mm_malloc_size(FAR struct mm_heap_s *heap, FAR void *mem)
 }
 
 /****************************************************************************
- * Name: mm_malloc
+ * Name: malloc_internal
  *
  * Description:
- *  Find the smallest chunk that satisfies the request. Take the memory from
- *  that chunk, save the remaining, smaller chunk (if any).
- *
- *  8-byte alignment of the allocated data is assured.
+ *  Allocate from the tlsf pool.  If that fails and 'shrink' is true, ask
+ *  the registered shrinkers to release memory and try once more.
  *
  ****************************************************************************/
 
-FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
+static FAR void *malloc_internal(FAR struct mm_heap_s *heap, size_t size,
+                                 bool shrink)
 {
   size_t nodesize;
   FAR void *ret;
@@ -1399,13 +1610,36 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 
   else if (free_delaylist(heap, true))
     {
-      return mm_malloc(heap, size);
+      return malloc_internal(heap, size, shrink);
     }
 #endif
 
+  /* Ask the caches to release memory and try again, but only once */
+
+  else if (shrink && mm_shrink(heap, size) > 0)
+    {
+      return malloc_internal(heap, size, false);
+    }
+
   return ret;
 }
 
+/****************************************************************************
+ * Name: mm_malloc
+ *
+ * Description:
+ *  Find the smallest chunk that satisfies the request. Take the memory from
+ *  that chunk, save the remaining, smaller chunk (if any).
+ *
+ *  8-byte alignment of the allocated data is assured.
+ *
+ ****************************************************************************/
+
+FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
+{
+  return malloc_internal(heap, size, true);
+}
+
 /****************************************************************************
  * Name: mm_memalign
  *
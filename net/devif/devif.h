@@ -500,6 +500,28 @@ int devif_file_send(FAR struct net_driver_s *dev, FAR struct file *file,
                     unsigned int target_offset);
 #endif
 
+/****************************************************************************
+ * Name: devif_xip_send
+ *
+ * Description:
+ *   Called from socket logic in response to a xmit or poll request from the
+ *   the network interface driver.
+ *
+ *   This is identical to calling devif_file_send() except that the data is
+ *   in memory that remains valid while the packet is in flight, as file
+ *   data exposed through FIOC_XIPBASE.  The packet references that memory
+ *   instead of copying it.
+ *
+ * Assumptions:
+ *   Called with the network locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_SENDFILE_XIP
+int devif_xip_send(FAR struct net_driver_s *dev, FAR const void *buf,
+                   unsigned int len, unsigned int target_offset);
+#endif
+
 /****************************************************************************
  * Name: devif_out
  *
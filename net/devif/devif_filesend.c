@@ -26,6 +26,7 @@
 
 #include <nuttx/config.h>
 
+#include <stdint.h>
 #include <string.h>
 #include <assert.h>
 #include <debug.h>
@@ -163,4 +164,105 @@ errout:
   return ret;
 }
 
+#ifdef CONFIG_NET_SENDFILE_XIP
+/****************************************************************************
+ * Name: devif_xip_free
+ *
+ * Description:
+ *   The payload referenced by devif_xip_send() belongs to the file system,
+ *   there is nothing to release.
+ *
+ ****************************************************************************/
+
+static void devif_xip_free(FAR void *data)
+{
+}
+
+/****************************************************************************
+ * Name: devif_xip_send
+ *
+ * Description:
+ *   Called from socket logic in response to a xmit or poll request from the
+ *   the network interface driver.
+ *
+ *   This is identical to calling devif_file_send() except that the data is
+ *   in memory that remains valid while the packet is in flight, as file
+ *   data exposed through FIOC_XIPBASE.  The packet references that memory
+ *   instead of copying it.
+ *
+ * Assumptions:
+ *   Called with the network locked.
+ *
+ ****************************************************************************/
+
+int devif_xip_send(FAR struct net_driver_s *dev, FAR const void *buf,
+                   unsigned int len, unsigned int target_offset)
+{
+  FAR struct iob_s *tail;
+  FAR struct iob_s *iob;
+  int ret;
+
+  if (dev == NULL)
+    {
+      ret = -ENODEV;
+      goto errout;
+    }
+
+  if (len == 0 || len > UINT16_MAX)
+    {
+      ret = -EINVAL;
+      goto errout;
+    }
+
+#ifndef CONFIG_NET_IPFRAG
+  if (len > NETDEV_PKTSIZE(dev) - NET_LL_HDRLEN(dev) - target_offset)
+    {
+      ret = -EMSGSIZE;
+      goto errout;
+    }
+#endif
+
+  /* Only the headers go to the device buffer */
+
+  if (netdev_iob_prepare(dev, false, 0) != OK)
+    {
+      ret = -ENOMEM;
+      goto errout;
+    }
+
+  ret = iob_update_pktlen(dev->d_iob, target_offset, false);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  /* Then the payload, in place */
+
+  iob = iob_alloc_with_data((FAR void *)buf, len, devif_xip_free);
+  if (iob == NULL)
+    {
+      ret = -ENOMEM;
+      goto errout;
+    }
+
+  iob->io_len = len;
+  for (tail = dev->d_iob; tail->io_flink != NULL; tail = tail->io_flink);
+
+  tail->io_flink = iob;
+  dev->d_iob->io_pktlen = target_offset + len;
+
+  dev->d_sndlen = len;
+  return len;
+
+errout:
+  if (dev != NULL)
+    {
+      netdev_iob_release(dev);
+    }
+
+  nerr("ERROR: devif_xip_send error: %d\n", ret);
+  return ret;
+}
+#endif /* CONFIG_NET_SENDFILE_XIP */
+
 #endif /* CONFIG_MM_IOB */
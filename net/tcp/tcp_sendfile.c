@@ -27,6 +27,7 @@
 #include <nuttx/config.h>
 
 #include <sys/stat.h>
+#include <sys/statfs.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 
@@ -73,6 +74,9 @@ struct sendfile_s
   FAR struct tcp_conn_s *snd_conn;         /* Connection associated with the socket */
   FAR struct devif_callback_s *snd_cb;     /* Reference to callback instance */
   FAR struct file   *snd_file;             /* File structure of the input file */
+#ifdef CONFIG_NET_SENDFILE_XIP
+  FAR const uint8_t *snd_xipbase;          /* File data in memory, if any */
+#endif
   sem_t              snd_sem;              /* Used to wake up the waiting thread */
   off_t              snd_foffset;          /* Input file offset */
   size_t             snd_flen;             /* File length */
@@ -96,6 +100,90 @@ struct sendfile_s
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: sendfile_xipbase
+ *
+ * Description:
+ *   Get the address of the file data, if the file system keeps it in
+ *   memory, and limit the transfer to the end of the file.
+ *
+ *   Only ROMFS is accepted:  the packets keep referencing the file data
+ *   after sendfile() returns, so the memory must never be freed or
+ *   rewritten.  TMPFS also supports FIOC_XIPBASE, but its file data may
+ *   be reallocated by a write or truncate at any time.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_SENDFILE_XIP
+static FAR const uint8_t *sendfile_xipbase(FAR struct file *infile,
+                                           off_t offset,
+                                           FAR size_t *count)
+{
+  FAR struct inode *inode = infile->f_inode;
+  struct statfs fsbuf;
+  struct stat buf;
+  uintptr_t base;
+
+  if (inode == NULL || !INODE_IS_MOUNTPT(inode) ||
+      inode->u.i_mops == NULL || inode->u.i_mops->statfs == NULL)
+    {
+      return NULL;
+    }
+
+  memset(&fsbuf, 0, sizeof(fsbuf));
+  if (inode->u.i_mops->statfs(inode, &fsbuf) < 0 ||
+      fsbuf.f_type != ROMFS_MAGIC)
+    {
+      return NULL;
+    }
+
+  if (file_ioctl(infile, FIOC_XIPBASE, (unsigned long)&base) < 0 ||
+      base == 0 || file_fstat(infile, &buf) < 0)
+    {
+      return NULL;
+    }
+
+  if (offset >= buf.st_size)
+    {
+      *count = 0;
+    }
+  else if (*count > buf.st_size - offset)
+    {
+      *count = buf.st_size - offset;
+    }
+
+  return (FAR const uint8_t *)base;
+}
+#endif
+
+/****************************************************************************
+ * Name: sendfile_send
+ *
+ * Description:
+ *   Set up one segment of file data for sending, from the file data in
+ *   place if possible.
+ *
+ ****************************************************************************/
+
+static int sendfile_send(FAR struct net_driver_s *dev,
+                         FAR struct sendfile_s *pstate,
+                         FAR struct tcp_conn_s *conn,
+                         uint32_t sndlen, uint32_t offset)
+{
+#ifdef CONFIG_NET_SENDFILE_XIP
+  if (pstate->snd_xipbase != NULL)
+    {
+      return devif_xip_send(dev, pstate->snd_xipbase +
+                            pstate->snd_foffset + offset, sndlen,
+                            tcpip_hdrsize(conn));
+    }
+#endif
+
+  return devif_file_send(dev, pstate->snd_file, sndlen,
+                         pstate->snd_foffset + offset,
+                         tcpip_hdrsize(conn));
+}
+
 /****************************************************************************
  * Name: sendfile_eventhandler
  *
@@ -269,9 +357,7 @@ static uint16_t sendfile_eventhandler(FAR struct net_driver_s *dev,
        * happen until the polling cycle completes).
        */
 
-      ret = devif_file_send(dev, pstate->snd_file, sndlen,
-                            pstate->snd_foffset + pstate->snd_acked,
-                            tcpip_hdrsize(conn));
+      ret = sendfile_send(dev, pstate, conn, sndlen, pstate->snd_acked);
       if (ret < 0)
         {
           nerr("ERROR: Failed to read from input file: %d\n", (int)ret);
@@ -340,9 +426,8 @@ static uint16_t sendfile_eventhandler(FAR struct net_driver_s *dev,
            * happen until the polling cycle completes).
            */
 
-          ret = devif_file_send(dev, pstate->snd_file, sndlen,
-                                pstate->snd_foffset + pstate->snd_sent,
-                                tcpip_hdrsize(conn));
+          ret = sendfile_send(dev, pstate, conn, sndlen,
+                              pstate->snd_sent);
           if (ret < 0)
             {
               nerr("ERROR: Failed to read from input file: %d\n", (int)ret);
@@ -487,6 +572,17 @@ ssize_t tcp_sendfile(FAR struct socket *psock, FAR struct file *infile,
   state.snd_flen    = count;                       /* Number of bytes to send */
   state.snd_file    = infile;                      /* File to read from */
 
+#ifdef CONFIG_NET_SENDFILE_XIP
+  /* Send the file data in place if the file system keeps it in memory */
+
+  state.snd_xipbase = sendfile_xipbase(infile, state.snd_foffset,
+                                       &state.snd_flen);
+  if (state.snd_flen == 0)
+    {
+      goto errout_locked;
+    }
+#endif
+
   /* Allocate resources to receive a callback */
 
   state.snd_cb = tcp_callback_alloc(conn);
@@ -545,6 +641,22 @@ errout_locked:
 #endif
   net_unlock();
 
+#ifdef CONFIG_NET_SENDFILE_XIP
+  /* The file data was not read, move the file position past the data
+   * sent.
+   */
+
+  if (state.snd_xipbase != NULL && state.snd_sent > 0)
+    {
+      off_t curpos = file_seek(infile, state.snd_foffset + state.snd_sent,
+                               SEEK_SET);
+      if (curpos < 0)
+        {
+          return curpos;
+        }
+    }
+#endif
+
   /* Return the current file position */
 
   if (offset)
@@ -47,6 +47,10 @@
 
 static struct task_group_s  g_kthread_group;   /* Shared among kthreads     */
 
+#ifdef CONFIG_MM_ACCOUNTING
+static atomic_t g_group_heapgen;                /* Last heap generation used */
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -87,6 +91,47 @@ static inline void group_inherit_identity(FAR struct task_group_s *group)
 #  define group_inherit_identity(group)
 #endif
 
+/****************************************************************************
+ * Name: group_inherit_limits
+ *
+ * Description:
+ *   Inherit the heap limit from the parent task group.  Kernel threads and
+ *   the first groups created at boot are not limited.  Each group also gets
+ *   a new heap generation, so that blocks charged to an exited group are
+ *   not credited to a later group that reuses its pid.
+ *
+ * Input Parameters:
+ *   group - The new task group.
+ *   ttype - Type of the thread that is the parent of the group
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MM_ACCOUNTING
+static inline void group_inherit_limits(FAR struct task_group_s *group,
+                                        uint8_t ttype)
+{
+  FAR struct tcb_s *rtcb          = this_task();
+  FAR struct task_group_s *rgroup = rtcb ? rtcb->group : NULL;
+
+  group->tg_heapgen = (uint32_t)atomic_fetch_add(&g_group_heapgen, 1) + 1;
+
+  if (ttype != TCB_FLAG_TTYPE_KERNEL && rgroup != NULL && rgroup != group)
+    {
+      group->tg_datalimit = rgroup->tg_datalimit;
+    }
+  else
+    {
+      group->tg_datalimit.rlim_cur = RLIM_INFINITY;
+      group->tg_datalimit.rlim_max = RLIM_INFINITY;
+    }
+}
+#else
+#  define group_inherit_limits(group, ttype)
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -166,6 +211,10 @@ int group_initialize(FAR struct task_tcb_s *tcb, uint8_t ttype)
 
   group_inherit_identity(group);
 
+  /* Inherit the resource limits from the parent task group */
+
+  group_inherit_limits(group, ttype);
+
   /* Initialize file descriptors for the TCB */
 
   files_initlist(&group->tg_filelist);
@@ -0,0 +1,102 @@
+/****************************************************************************
+ * sched/group/group_setrlimit.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/resource.h>
+#include <assert.h>
+#include <errno.h>
+
+#include <nuttx/irq.h>
+
+#include "sched/sched.h"
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: setrlimit
+ *
+ * Description:
+ *   The getrlimit() and setrlimit() system calls get and set resource
+ *   limits respectively.  Only RLIMIT_DATA is enforced: it limits the heap
+ *   memory allocated by the calling task group.  Other resources are
+ *   accepted and ignored.
+ *
+ * Input Parameters:
+ *   resource - The resource to be limited.
+ *   rlp      - The new soft and hard limits.
+ *
+ * Returned Value:
+ *   Zero if successful and -1 in case of failure, in which case errno is set
+ *   to one of the following values:
+ *
+ *   EINVAL - rlp is NULL or its soft limit is above its hard limit.
+ *   EPERM  - An attempt to raise the hard limit.
+ *
+ ****************************************************************************/
+
+int setrlimit(int resource, FAR const struct rlimit *rlp)
+{
+  FAR struct task_group_s *rgroup;
+  irqstate_t flags;
+  int errcode = 0;
+
+  if (rlp == NULL || rlp->rlim_cur > rlp->rlim_max)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  if (resource != RLIMIT_DATA)
+    {
+      return OK;
+    }
+
+  rgroup = this_task()->group;
+  DEBUGASSERT(rgroup != NULL);
+
+  flags = spin_lock_irqsave(&rgroup->tg_lock);
+  if (rlp->rlim_max > rgroup->tg_datalimit.rlim_max)
+    {
+      errcode = EPERM;
+    }
+  else
+    {
+      rgroup->tg_datalimit = *rlp;
+    }
+
+  spin_unlock_irqrestore(&rgroup->tg_lock, flags);
+
+  if (errcode != 0)
+    {
+      set_errno(errcode);
+      return ERROR;
+    }
+
+  return OK;
+}
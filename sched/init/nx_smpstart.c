@@ -87,6 +87,10 @@ void nx_idle_trampoline(void)
 
   for (; ; )
     {
+      /* Release the memory freed while the heap was busy */
+
+      mm_free_delaylist_idle();
+
       /* Perform any processor-specific idle state operations */
 
       up_idle();
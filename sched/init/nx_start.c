@@ -777,6 +777,10 @@ void nx_start(void)
 #ifndef CONFIG_DISABLE_IDLE_LOOP
   for (; ; )
     {
+      /* Release the memory freed while the heap was busy */
+
+      mm_free_delaylist_idle();
+
       /* Perform any processor-specific idle state operations */
 
       up_idle();
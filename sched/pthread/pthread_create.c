@@ -40,6 +40,7 @@
 #include <nuttx/arch.h>
 #include <nuttx/semaphore.h>
 #include <nuttx/kmalloc.h>
+#include <nuttx/mm/mm.h>
 #include <nuttx/pthread.h>
 
 #include "task/task.h"
@@ -259,8 +260,16 @@ int nx_pthread_create(pthread_trampoline_t trampoline, FAR pthread_t *thread,
     {
       /* Allocate the stack for the TCB */
 
+#ifdef CONFIG_MM_REGION_FAST_STACK
+      unsigned int hint = mm_sethint(MM_REGION_FAST);
+#endif
+
       ret = up_create_stack((FAR struct tcb_s *)ptcb, attr->stacksize,
                             TCB_FLAG_TTYPE_PTHREAD);
+
+#ifdef CONFIG_MM_REGION_FAST_STACK
+      mm_sethint(hint);
+#endif
     }
 
   if (ret != OK)
@@ -34,6 +34,7 @@
 #include <errno.h>
 #include <debug.h>
 
+#include <nuttx/mm/mm.h>
 #include <nuttx/queue.h>
 
 #include "sched/sched.h"
@@ -103,6 +104,9 @@ FAR struct task_tcb_s *nxtask_setup_fork(start_t retaddr)
   uint8_t ttype;
   int priority;
   int ret;
+#ifdef CONFIG_MM_REGION_FAST_STACK
+  unsigned int hint;
+#endif
 
   DEBUGASSERT(retaddr != NULL);
 
@@ -202,7 +206,16 @@ FAR struct task_tcb_s *nxtask_setup_fork(start_t retaddr)
   stack_size = (uintptr_t)ptcb->stack_base_ptr -
                (uintptr_t)ptcb->stack_alloc_ptr + ptcb->adj_stack_size;
 
+#ifdef CONFIG_MM_REGION_FAST_STACK
+  hint = mm_sethint(MM_REGION_FAST);
+#endif
+
   ret = up_create_stack(&child->cmn, stack_size, ttype);
+
+#ifdef CONFIG_MM_REGION_FAST_STACK
+  mm_sethint(hint);
+#endif
+
   if (ret < OK)
     {
       goto errout_with_tcb;
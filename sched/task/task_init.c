@@ -33,6 +33,7 @@
 #include <errno.h>
 
 #include <nuttx/arch.h>
+#include <nuttx/mm/mm.h>
 #include <nuttx/queue.h>
 #include <nuttx/sched.h>
 #include <nuttx/trace.h>
@@ -160,7 +161,15 @@ int nxtask_init(FAR struct task_tcb_s *tcb, const char *name, int priority,
     {
       /* Allocate the stack for the TCB */
 
+#ifdef CONFIG_MM_REGION_FAST_STACK
+      unsigned int hint = mm_sethint(MM_REGION_FAST);
+#endif
+
       ret = up_create_stack(&tcb->cmn, stack_size, ttype);
+
+#ifdef CONFIG_MM_REGION_FAST_STACK
+      mm_sethint(hint);
+#endif
     }
 
   if (ret < OK)
@@ -463,6 +463,12 @@ static int nxthread_setup_scheduler(FAR struct tcb_s *tcb, int priority,
 
       tcb->sigprocmask = rtcb->sigprocmask;
 
+#ifdef CONFIG_MM_REGION_ATTR
+      /* The default heap region hint is inherited as well */
+
+      tcb->mm_hint = rtcb->mm_hint;
+#endif
+
       /* Initialize the task state.  It does not get a valid state
        * until it is activated.
        */